@@ -32,6 +32,7 @@ option(USE_GLFW             "Use GLFW for OpenGL renderer." ON)
 
 option(WITH_TESTS           "Include unittests" ON)
 option(WITH_SAMPLE          "Include sample" ON)
+option(WITH_BENCHMARKS      "Include benchmarks" OFF)
 
 option(WITH_REFLECTION      "Use reflection (requires external dependencies)" OFF)
 
@@ -88,6 +89,11 @@ if(WITH_SAMPLE)
     endif()
 endif(WITH_SAMPLE)
 
+if(WITH_BENCHMARKS)
+    message(STATUS "Including Gwk benchmarks")
+    enable_testing()
+endif(WITH_BENCHMARKS)
+
 if(WITH_REFLECTION)
     message("Using reflection")
 endif(WITH_REFLECTION)
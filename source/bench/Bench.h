@@ -0,0 +1,155 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_BENCH_BENCH_H
+#define GWK_BENCH_BENCH_H
+
+#include <Gwork/Skins/TexturedBase.h>
+#include <Gwork/Renderers/Software.h>
+#include <Gwork/Platform.h>
+#include <Gwork/Test/Test.h>
+#include <Gwork/Controls/Canvas.h>
+#include <Gwork/Controls/StatusBar.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <cstdio>
+
+namespace GwkBench
+{
+    typedef std::chrono::steady_clock Clock;
+
+    //! Milliseconds from \p start until now.
+    inline double MillisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    //! Average milliseconds \p run takes, over \p runs calls after one to warm up.
+    template <typename F>
+    double TimeEach(int runs, F run)
+    {
+        run();
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < runs; ++i)
+            run();
+        return MillisecondsSince(start) / runs;
+    }
+
+    //! Say how many cores there are, as it limits what threads can show.
+    inline void PrintCores()
+    {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        if (cores == 0)
+            std::printf("cores: unknown\n");
+        else
+            std::printf("cores: %u\n", cores);
+        if (cores == 1)
+            std::printf("Only one core: threads cannot run in parallel here.\n");
+    }
+
+    // Resources of the samples, copied next to the benchmarks.
+    const char* const c_skinName = "DefaultSkin.png";
+    const char* const c_fontName = "OpenSans.ttf";
+    const float c_fontSize = 11.f;
+
+    //
+    //! The TestAPI window, as in the samples, drawn into memory by the
+    //! Software renderer. Resources are read from the executable's folder.
+    //
+    class TestScene
+    {
+    public:
+
+        explicit TestScene(const Gwk::Point& size)
+        {
+            m_pixels.Init(size);
+            m_renderer.reset(new Gwk::Renderer::Software(m_paths, m_pixels));
+        }
+
+        //! The renderer, to set up before Load().
+        Gwk::Renderer::Software& GetRenderer() { return *m_renderer; }
+
+        Gwk::Renderer::PixelBuffer& GetPixels() { return m_pixels; }
+        const Gwk::Renderer::PixelBuffer& GetPixels() const { return m_pixels; }
+
+        //! Load the skin's texture and font in parallel, before Load().
+        void Preload()
+        {
+            Gwk::Font font;
+            font.SetFacename(c_fontName);
+            font.SetSize(c_fontSize);
+
+            Gwk::Texture texture;
+            texture.SetName(c_skinName);
+            texture.readable = true;    // The skin reads its colors.
+
+            m_renderer->Preload({ font }, { texture });
+        }
+
+        //! Load the skin and font, and create the controls.
+        void Load()
+        {
+            m_skin.reset(new Gwk::Skin::TexturedBase(m_renderer.get()));
+            m_skin->SetRender(m_renderer.get());
+            m_skin->Init(c_skinName);
+            m_skin->SetDefaultFont(c_fontName, c_fontSize);
+
+            m_canvas.reset(new Gwk::Controls::Canvas(m_skin.get()));
+            m_canvas->SetSize(m_pixels.GetSize());
+            m_canvas->SetDrawBackground(true);
+            m_canvas->SetBackgroundColor(Gwk::Color(150, 170, 170, 255));
+
+            m_tests.reset(Gwk::Test::CreateTests(m_canvas.get()));
+            m_tests->SetPos(10, 10);
+
+            // The status bar shows the frame rate, so scenes would differ.
+            for (Gwk::Controls::Base* child : m_tests->Children)
+            {
+                if (Gwk::gwk_cast<Gwk::Controls::StatusBar>(child))
+                    child->Hide();
+            }
+        }
+
+        //! Draw a frame, redrawing every control.
+        void Draw()
+        {
+            m_canvas->Redraw();
+            m_renderer->BeginContext(nullptr);
+            m_canvas->RenderCanvas();
+            m_renderer->EndContext(nullptr);
+        }
+
+        //! True if the pixels drawn match those of \p other.
+        bool SamePixels(const TestScene& other) const
+        {
+            const Gwk::Point size = m_pixels.GetSize();
+            if (other.m_pixels.GetSize().x != size.x || other.m_pixels.GetSize().y != size.y)
+                return false;
+
+            for (int y = 0; y < size.y; ++y)
+            {
+                if (std::memcmp(m_pixels.Row(y), other.m_pixels.Row(y),
+                                size.x * sizeof(Gwk::Color)) != 0)
+                    return false;
+            }
+            return true;
+        }
+
+    private:
+
+        Gwk::Platform::RelativeToExecutablePaths m_paths;
+        Gwk::Renderer::PixelBuffer m_pixels;
+        std::unique_ptr<Gwk::Renderer::Software> m_renderer;
+        std::unique_ptr<Gwk::Skin::TexturedBase> m_skin;
+        std::unique_ptr<Gwk::Controls::Canvas> m_canvas;
+        std::unique_ptr<Gwk::Controls::Base> m_tests;
+    };
+}
+
+#endif // ifndef GWK_BENCH_BENCH_H
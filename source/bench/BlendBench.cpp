@@ -0,0 +1,252 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+//
+// Fill rate of the Software renderer's span kernels at 1080p and 4K, with
+// the scalar, SSE2 and AVX2 code. First, random fills, outlines, textures,
+// gradients, text and a cached control are drawn over random pixels in each
+// mode, and the pixels are checked to match the scalar ones bit for bit.
+//
+// Usage: BlendBench [--check]
+//   --check : Only check the modes match. Used as a test.
+//
+
+#include "Bench.h"
+#include <Gwork/PlatformCommon.h>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace Gwk;
+
+namespace
+{
+    const char* const c_modeNames[] = { "scalar", "sse2", "avx2" };
+    const char* const c_textureNames[] = { GwkBench::c_skinName, "logo.png", "test16.png" };
+
+    // Use the SIMD instruction sets up to and including mode, if the CPU has them.
+    void SetMode(const Platform::CpuFeatures& cpu, int mode)
+    {
+        Platform::CpuFeatures features;
+        features.sse2 = cpu.sse2 && mode >= 1;
+        features.avx2 = cpu.avx2 && mode >= 2;
+        Platform::SetCpuFeatures(features);
+    }
+
+    bool HasMode(const Platform::CpuFeatures& cpu, int mode)
+    {
+        return mode == 0 || (mode == 1 && cpu.sse2) || (mode == 2 && cpu.avx2);
+    }
+
+    // Opaque, transparent and translucent colors, as each has its own path.
+    Color RandomColor(std::mt19937& rng)
+    {
+        const unsigned char alphas[] = { 0, 255, static_cast<unsigned char>(rng()) };
+        return Color(rng() & 255, rng() & 255, rng() & 255, alphas[rng() % 3]);
+    }
+
+    Rect RandomRect(std::mt19937& rng, const Point& size)
+    {
+        return Rect(int(rng() % (size.x + 100)) - 50, int(rng() % (size.y + 100)) - 50,
+                    int(rng() % 200), int(rng() % 200));
+    }
+
+    void DrawRandom(Renderer::Software& renderer, const Point& size, std::mt19937& rng)
+    {
+        Font font;
+        font.SetFacename(GwkBench::c_fontName);
+
+        for (int i = 0; i < 300; ++i)
+        {
+            renderer.SetDrawColor(RandomColor(rng));
+            const Rect rect = RandomRect(rng, size);
+
+            Texture texture;
+            texture.SetName(c_textureNames[rng() % 3]);
+
+            switch (rng() % 6)
+            {
+            case 0:
+                renderer.DrawFilledRect(rect);
+                break;
+            case 1:
+                renderer.DrawLinedRect(rect);
+                break;
+            case 2:
+            {
+                // Unscaled, as 1:1 rows are blended straight from the texture.
+                renderer.EnsureTexture(texture);
+                const TextureData data = renderer.GetTextureData(texture);
+                renderer.DrawTexturedRect(texture, Rect(rect.x, rect.y, int(data.width),
+                                                        int(data.height)));
+                break;
+            }
+            case 3:
+            {
+                // Scaled either way, within the texture.
+                const float u = (rng() % 50) / 100.f, v = (rng() % 50) / 100.f;
+                renderer.DrawTexturedRect(texture, rect, u, v, u + (rng() % 50) / 100.f,
+                                          v + (rng() % 50) / 100.f);
+                break;
+            }
+            case 4:
+                renderer.DrawBilinearGradientRect(rect, RandomColor(rng), RandomColor(rng),
+                                                  RandomColor(rng), RandomColor(rng));
+                break;
+            case 5:
+                font.SetSize(float(8 + rng() % 24));
+                renderer.RenderText(font, Point(rect.x, rect.y),
+                                    "The quick brown fox jumps over the lazy dog 0123456789");
+                break;
+            }
+        }
+    }
+
+    // Draw the same random scene over the same random pixels.
+    void DrawScene(GwkBench::TestScene& scene, bool premultiplied)
+    {
+        Renderer::Software& renderer = scene.GetRenderer();
+        renderer.SetPremultipliedAlpha(premultiplied);
+
+        Renderer::PixelBuffer& pixels = scene.GetPixels();
+        const Point size = pixels.GetSize();
+        std::mt19937 rng(1);
+        for (int y = 0; y < size.y; ++y)
+        {
+            Color* row = pixels.Row(y);
+            for (int x = 0; x < size.x; ++x)
+                row[x].rgba = rng();
+        }
+
+        DrawRandom(renderer, size, rng);
+
+        // Cached controls are drawn with the alpha composited over.
+        int control = 0;
+        Renderer::ICacheToTexture* cache = renderer.GetCTT();
+        cache->CreateControlCacheTexture(&control, Point(300, 200));
+        cache->SetupCacheTexture(&control);
+        DrawRandom(renderer, Point(300, 200), rng);
+        cache->FinishCacheTexture(&control);
+        renderer.SetRenderOffset(Point(100, 100));
+        cache->DrawCachedControlTexture(&control);
+        renderer.SetRenderOffset(Point(0, 0));
+        cache->ShutDown();
+
+        renderer.End();
+    }
+
+    // Without them, the check would draw no textures or text.
+    bool HasResources()
+    {
+        GwkBench::TestScene scene(Point(1, 1));
+        for (const char* name : c_textureNames)
+        {
+            Texture texture;
+            texture.SetName(name);
+            if (!scene.GetRenderer().EnsureTexture(texture))
+                return false;
+        }
+
+        Font font;
+        font.SetFacename(GwkBench::c_fontName);
+        return scene.GetRenderer().EnsureFont(font);
+    }
+
+    bool CheckModesMatch(const Platform::CpuFeatures& cpu)
+    {
+        for (bool premultiplied : { false, true })
+        {
+            SetMode(cpu, 0);
+            GwkBench::TestScene reference(Point(640, 480));
+            DrawScene(reference, premultiplied);
+
+            for (int mode = 1; mode < 3; ++mode)
+            {
+                if (!HasMode(cpu, mode))
+                    continue;
+
+                SetMode(cpu, mode);
+                GwkBench::TestScene scene(Point(640, 480));
+                DrawScene(scene, premultiplied);
+                if (!scene.SamePixels(reference))
+                {
+                    std::printf("%s %s blending differs from scalar\n", c_modeNames[mode],
+                                premultiplied ? "premultiplied" : "straight");
+                    return false;
+                }
+            }
+        }
+        std::printf("SIMD blending matches scalar\n");
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool checkOnly = argc > 1 && std::strcmp(argv[1], "--check") == 0;
+    const Platform::CpuFeatures cpu = Platform::GetCpuFeatures();
+    std::printf("CPU has sse2: %s, avx2: %s\n", cpu.sse2 ? "yes" : "no", cpu.avx2 ? "yes" : "no");
+
+    if (!HasResources())
+    {
+        std::printf("The textures and font must be in the working directory\n");
+        return EXIT_FAILURE;
+    }
+
+    const bool match = CheckModesMatch(cpu);
+    if (!match || checkOnly)
+    {
+        Platform::SetCpuFeatures(cpu);
+        return match ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    struct Screen
+    {
+        const char* name;
+        Point size;
+    };
+    const Screen screens[] = { { "1080p", Point(1920, 1080) }, { "4K", Point(3840, 2160) } };
+
+    std::printf("%-15s %12s %12s %12s   (Mpx/s)\n", "", "scalar", "sse2", "avx2");
+    for (const Screen& screen : screens)
+    {
+        for (int test = 0; test < 3; ++test)
+        {
+            static const char* const testNames[] = { "opaque", "alpha", "textured" };
+            double rates[3] = { 0.0, 0.0, 0.0 };
+
+            for (int mode = 0; mode < 3; ++mode)
+            {
+                if (!HasMode(cpu, mode))
+                    continue;
+
+                SetMode(cpu, mode);
+                GwkBench::TestScene scene(screen.size);
+                Renderer::Software& renderer = scene.GetRenderer();
+                const Rect all(0, 0, screen.size.x, screen.size.y);
+
+                Texture texture;
+                texture.SetName(GwkBench::c_skinName);
+                renderer.SetDrawColor(Color(40, 80, 120, test == 0 ? 255 : 128));
+
+                const double ms = GwkBench::TimeEach(10, [&] {
+                    if (test == 2)
+                        renderer.DrawTexturedRect(texture, all, 0.f, 0.f, 0.5f, 0.5f);
+                    else
+                        renderer.DrawFilledRect(all);
+                });
+                rates[mode] = screen.size.x * screen.size.y / (ms * 1000.0);
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%s %s", screen.name, testNames[test]);
+            std::printf("%-15s %12.0f %12.0f %12.0f\n", name, rates[0], rates[1], rates[2]);
+        }
+    }
+
+    Platform::SetCpuFeatures(cpu);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+//
+// Blend time of the Software renderer with straight and premultiplied
+// alpha, with the scalar, SSE2 and AVX2 code. A translucent fill, the skin
+// texture tiled 1:1 and a quarter of the skin stretched are drawn over a
+// 512x512 target, which stays in the cache, and a 1080p one. The skin has
+// opaque, translucent and transparent texels, as UI textures do.
+//
+// Usage: PremultipliedBench
+//
+
+#include "Bench.h"
+#include <Gwork/PlatformCommon.h>
+#include <cstdlib>
+
+using namespace Gwk;
+
+namespace
+{
+    // Use the SIMD instruction sets up to and including mode, if the CPU has them.
+    void SetMode(const Platform::CpuFeatures& cpu, int mode)
+    {
+        Platform::CpuFeatures features;
+        features.sse2 = cpu.sse2 && mode >= 1;
+        features.avx2 = cpu.avx2 && mode >= 2;
+        Platform::SetCpuFeatures(features);
+    }
+
+    void Draw(Renderer::Software& renderer, const Point& size, const Texture& skin, int test)
+    {
+        switch (test)
+        {
+        case 0:
+            renderer.SetDrawColor(Color(200, 60, 20, 128));
+            renderer.DrawFilledRect(Rect(0, 0, size.x, size.y));
+            break;
+        case 1:
+        {
+            const TextureData data = renderer.GetTextureData(skin);
+            const int w = int(data.width), h = int(data.height);
+            for (int y = 0; y < size.y; y += h)
+            {
+                for (int x = 0; x < size.x; x += w)
+                    renderer.DrawTexturedRect(skin, Rect(x, y, w, h));
+            }
+            break;
+        }
+        case 2:
+            renderer.DrawTexturedRect(skin, Rect(0, 0, size.x, size.y), 0.f, 0.f, 0.5f, 0.5f);
+            break;
+        }
+    }
+
+    // Microseconds to draw the test, the best of 5 batches.
+    double Time(const Platform::CpuFeatures& cpu, int mode, bool premultiplied,
+                const Point& size, int test)
+    {
+        SetMode(cpu, mode);
+        GwkBench::TestScene scene(size);
+        Renderer::Software& renderer = scene.GetRenderer();
+        renderer.SetPremultipliedAlpha(premultiplied);
+        renderer.SetClipRegion(Rect(0, 0, size.x, size.y));
+        renderer.StartClip();
+
+        Texture skin;
+        skin.SetName(GwkBench::c_skinName);
+        if (!renderer.EnsureTexture(skin))
+            return 0.0;
+
+        const int runs = 40000000 / (size.x * size.y) + 1;
+        double best = 0.0;
+        for (int batch = 0; batch < 5; ++batch)
+        {
+            const double ms = GwkBench::TimeEach(runs, [&] { Draw(renderer, size, skin, test); });
+            if (batch == 0 || ms < best)
+                best = ms;
+        }
+        return best * 1000.0;
+    }
+}
+
+int main()
+{
+    const Platform::CpuFeatures cpu = Platform::GetCpuFeatures();
+    std::printf("CPU has sse2: %s, avx2: %s\n", cpu.sse2 ? "yes" : "no", cpu.avx2 ? "yes" : "no");
+
+    const char* const testNames[] = { "alpha fill", "texture 1:1", "texture scaled" };
+    const Point sizes[] = { Point(512, 512), Point(1920, 1080) };
+
+    for (const Point& size : sizes)
+    {
+        std::printf("\n%dx%d, straight / premultiplied, us\n", size.x, size.y);
+        std::printf("%-15s %17s %17s %17s\n", "", "scalar", "sse2", "avx2");
+        for (int test = 0; test < 3; ++test)
+        {
+            std::printf("%-15s", testNames[test]);
+            for (int mode = 0; mode < 3; ++mode)
+            {
+                if ((mode == 1 && !cpu.sse2) || (mode == 2 && !cpu.avx2))
+                {
+                    std::printf(" %17s", "-");
+                    continue;
+                }
+
+                const double straight = Time(cpu, mode, false, size, test);
+                const double premultiplied = Time(cpu, mode, true, size, test);
+                std::printf(" %7.1f / %7.1f", straight, premultiplied);
+            }
+            std::printf("\n");
+        }
+    }
+
+    Platform::SetCpuFeatures(cpu);
+    return EXIT_SUCCESS;
+}
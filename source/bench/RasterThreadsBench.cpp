@@ -0,0 +1,47 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+//
+// Time the TestAPI window drawn at 3840x2160 by the Software renderer, with
+// draws made immediately and then binned into tiles drawn by 1 to 16 threads.
+// Each binned frame is checked against the immediate one.
+//
+// Usage: RasterThreadsBench [frames]
+//
+
+#include "Bench.h"
+#include <algorithm>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const Gwk::Point size(3840, 2160);
+
+    GwkBench::PrintCores();
+
+    GwkBench::TestScene immediate(size);
+    immediate.Load();
+    const double immediateMs = GwkBench::TimeEach(frames, [&] { immediate.Draw(); });
+    std::printf("immediate   %7.2f ms/frame\n", immediateMs);
+
+    bool allSame = true;
+    for (int threads : { 1, 2, 4, 8, 16 })
+    {
+        GwkBench::TestScene binned(size);
+        binned.GetRenderer().SetRasterThreads(threads);
+        binned.Load();
+        const double binnedMs = GwkBench::TimeEach(frames, [&] { binned.Draw(); });
+
+        const bool same = binned.SamePixels(immediate);
+        allSame = allSame && same;
+        std::printf("%2d threads  %7.2f ms/frame  x%.2f  %s\n",
+                    threads, binnedMs, immediateMs / binnedMs,
+                    same ? "same pixels" : "PIXELS DIFFER");
+    }
+
+    return allSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,157 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+//
+// Time from creating the Software renderer to the first frame of the TestAPI
+// window at 1024x768, with and without preloading the skin's texture and font
+// in parallel, and with the disk cache of decoded textures and glyphs cold
+// (emptied before each run) and warm (filled by the run before). Files are
+// read from the OS cache after the first run.
+//
+// Usage: StartupBench [runs] [cache directory]
+//   cache directory : Where the disk cache is kept. It must exist, and its
+//                     cache entries are deleted. Default: StartupCache, which
+//                     the build makes next to the benchmark.
+//
+
+#include "Bench.h"
+#include <Gwork/DiskCache.h>
+#include <Gwork/JobSystem.h>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    struct Times
+    {
+        double preload = 0.0;   // Preload(), if called.
+        double load = 0.0;      // Skin, font and controls.
+        double firstFrame = 0.0;
+        double total = 0.0;
+    };
+
+    Times Start(bool preload)
+    {
+        Times times;
+        const GwkBench::Clock::time_point start = GwkBench::Clock::now();
+
+        GwkBench::TestScene scene(Gwk::Point(1024, 768));
+        if (preload)
+        {
+            const GwkBench::Clock::time_point preloadStart = GwkBench::Clock::now();
+            scene.Preload();
+            times.preload = GwkBench::MillisecondsSince(preloadStart);
+        }
+
+        const GwkBench::Clock::time_point loadStart = GwkBench::Clock::now();
+        scene.Load();
+        times.load = GwkBench::MillisecondsSince(loadStart);
+
+        const GwkBench::Clock::time_point drawStart = GwkBench::Clock::now();
+        scene.Draw();
+        times.firstFrame = GwkBench::MillisecondsSince(drawStart);
+
+        times.total = GwkBench::MillisecondsSince(start);
+        return times;
+    }
+
+    // Delete the disk cache's entries, leaving any other files.
+    bool ClearCache(const Gwk::String& directory)
+    {
+        std::vector<Gwk::String> entries;
+        const bool listed = Gwk::Platform::ListDirectory(directory,
+            [&](std::vector<Gwk::Platform::DirectoryEntry>&& batch)
+            {
+                for (const Gwk::Platform::DirectoryEntry& entry : batch)
+                {
+                    const Gwk::String& name = entry.name;
+                    if (!entry.isDirectory && name.size() > 5
+                        && name.compare(name.size() - 5, 5, ".gwkc") == 0)
+                        entries.push_back(name);
+                }
+                return true;
+            });
+
+        for (const Gwk::String& name : entries)
+            std::remove((directory + "/" + name).c_str());
+        return listed;
+    }
+
+    enum class Cache
+    {
+        Off,
+        Cold,   // Emptied before each run.
+        Warm    // Filled by the run before.
+    };
+
+    // The run with the median total, so that one slow run does not count.
+    Times Median(bool preload, Cache cache, const Gwk::String& cacheDir, int runs)
+    {
+        Gwk::Renderer::DiskCache::SetDirectory(cache == Cache::Off ? Gwk::String() : cacheDir);
+        if (cache == Cache::Warm)
+            Start(preload);
+
+        std::vector<Times> all;
+        for (int i = 0; i < runs; ++i)
+        {
+            if (cache == Cache::Cold)
+                ClearCache(cacheDir);
+            all.push_back(Start(preload));
+        }
+        Gwk::Renderer::DiskCache::SetDirectory(Gwk::String());
+
+        std::sort(all.begin(), all.end(),
+                  [](const Times& a, const Times& b) { return a.total < b.total; });
+        return all[all.size() / 2];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 9;
+    const Gwk::String cacheDir = argc > 2 ? argv[2] : "StartupCache";
+
+    GwkBench::PrintCores();
+    std::printf("JobSystem workers: %u\n", Gwk::Platform::JobSystem::Get().GetWorkerCount());
+
+    // Read the files once, so that both modes find them in the OS cache.
+    Start(false);
+
+    const bool hasCacheDir = ClearCache(cacheDir);
+
+    struct Mode
+    {
+        const char* name;
+        bool preload;
+        Cache cache;
+    };
+    const Mode modes[] = {
+        { "no preload", false, Cache::Off },
+        { "preload", true, Cache::Off },
+        { "cold cache", false, Cache::Cold },
+        { "warm cache", false, Cache::Warm },
+        { "warm+pre", true, Cache::Warm }
+    };
+
+    std::printf("%-11s %10s %10s %12s %10s\n", "", "preload", "load", "first frame", "total");
+    for (const Mode& mode : modes)
+    {
+        if (mode.cache != Cache::Off && !hasCacheDir)
+            continue;
+
+        const Times times = Median(mode.preload, mode.cache, cacheDir, runs);
+        std::printf("%-11s %7.2f ms %7.2f ms %9.2f ms %7.2f ms\n", mode.name,
+                    times.preload, times.load, times.firstFrame, times.total);
+    }
+
+    if (hasCacheDir)
+        ClearCache(cacheDir);
+    else
+        std::printf("No directory %s, so the disk cache was not timed.\n", cacheDir.c_str());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+//
+// Time Utility::Strings::DecodeUtf8 on short labels and long text, with the
+// scalar, SSE2 and AVX2 loops, against decoding one character at a time with
+// utf8_to_wchart. The loops are checked to give the same code points first.
+//
+// Usage: Utf8Bench
+//
+
+#include "Bench.h"
+#include <Gwork/Utility.h>
+#include <Gwork/PlatformCommon.h>
+#include <cstdlib>
+#include <random>
+
+using namespace Gwk;
+
+namespace
+{
+    const char* const c_modeNames[] = { "scalar", "sse2", "avx2" };
+
+    // Use the SIMD instruction sets up to and including mode, if the CPU has them.
+    void SetMode(const Platform::CpuFeatures& cpu, int mode)
+    {
+        Platform::CpuFeatures features;
+        features.sse2 = cpu.sse2 && mode >= 1;
+        features.avx2 = cpu.avx2 && mode >= 2;
+        Platform::SetCpuFeatures(features);
+    }
+
+    std::u32string DecodeByCharacter(const String& str)
+    {
+        std::u32string out;
+        char* s = const_cast<char*>(str.c_str());
+        while (const auto c = Utility::Strings::utf8_to_wchart(s))
+            out.push_back(c);
+        return out;
+    }
+
+    // Random strings of ASCII and 2 to 4 byte sequences, decoded in each mode.
+    bool CheckModesMatch(const Platform::CpuFeatures& cpu)
+    {
+        const char* const pieces[] = {
+            "a", "Z", " ", "hello world ", "\xc3\xa9", "\xe2\x82\xac", "\xe4\xb8\xad",
+            "\xf0\x9f\x98\x80"
+        };
+        std::mt19937 rng(1);
+
+        for (int test = 0; test < 10000; ++test)
+        {
+            String str;
+            for (int i = rng() % 80; i > 0; --i)
+                str += pieces[rng() % 8];
+
+            const std::u32string expected = DecodeByCharacter(str);
+            for (int mode = 0; mode < 3; ++mode)
+            {
+                SetMode(cpu, mode);
+                std::u32string decoded;
+                Utility::Strings::DecodeUtf8(str, decoded);
+                if (decoded != expected)
+                {
+                    std::printf("%s decoded \"%s\" wrongly\n", c_modeNames[mode], str.c_str());
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    const Platform::CpuFeatures cpu = Platform::GetCpuFeatures();
+    std::printf("CPU has sse2: %s, avx2: %s\n", cpu.sse2 ? "yes" : "no", cpu.avx2 ? "yes" : "no");
+
+    if (!CheckModesMatch(cpu))
+        return EXIT_FAILURE;
+
+    struct Input
+    {
+        const char* name;
+        String text;
+    };
+    Input inputs[] = {
+        { "ascii 12B", "Hello World!" },
+        { "ascii 40B", "The quick brown fox jumps over the lazy" },
+        { "ascii 4KB", "" },
+        { "mixed 4KB", "" },
+    };
+    for (int i = 0; i < 100; ++i)
+    {
+        inputs[2].text += "The quick brown fox jumps over the lazy.";
+        inputs[3].text += "Gr\xc3\xbc\xc3\x9f" "e aus K\xc3\xb6ln \xe2\x82\xac 12, ok ok ok ok ok";
+    }
+
+    std::printf("%-10s %12s %12s %12s %12s\n", "", "by char", "scalar", "sse2", "avx2");
+    for (const Input& input : inputs)
+    {
+        const int runs = static_cast<int>(50000000 / (input.text.size() + 16));
+        volatile size_t sink = 0;
+
+        const double byCharacter = GwkBench::TimeEach(runs, [&] {
+            char* s = const_cast<char*>(input.text.c_str());
+            size_t count = 0;
+            while (Utility::Strings::utf8_to_wchart(s))
+                ++count;
+            sink = count;
+        });
+
+        double modeTimes[3];
+        std::u32string decoded;
+        for (int mode = 0; mode < 3; ++mode)
+        {
+            SetMode(cpu, mode);
+            modeTimes[mode] = GwkBench::TimeEach(runs, [&] {
+                Utility::Strings::DecodeUtf8(input.text, decoded);
+                sink = decoded.size();
+            });
+        }
+
+        std::printf("%-10s %9.1f ns %9.1f ns %9.1f ns %9.1f ns\n", input.name,
+                    byCharacter * 1e6, modeTimes[0] * 1e6, modeTimes[1] * 1e6,
+                    modeTimes[2] * 1e6);
+    }
+
+    Platform::SetCpuFeatures(cpu);
+    return EXIT_SUCCESS;
+}
@@ -12,6 +12,7 @@
 #include <Gwork/Controls/Button.h>
 #include <Gwork/Controls/DockBase.h>
 #include <Gwork/Controls/FieldLabel.h>
+#include <Gwork/Controls/FileDialog.h>
 #include <Gwork/Controls/FolderPicker.h>
 #include <Gwork/Controls/FilePicker.h>
 #include <Gwork/Controls/GroupBox.h>
@@ -62,6 +62,12 @@ namespace Gwk
                 return m_fScale;
             }
 
+            /// Load fonts and textures before they are first drawn, in
+            /// parallel. Fonts are sized for the canvas scale.
+            /// \see Renderer::Base::Preload().
+            virtual void Preload(const std::vector<Gwk::Font>& fonts,
+                                 const std::vector<Gwk::Texture>& textures);
+
             void OnBoundsChanged(Gwk::Rect oldBounds) override;
 
             /// Delete all children (this is done called in the destructor too)
@@ -50,6 +50,17 @@ namespace Gwk
             /// @return Is expanded?
             bool IsExpanded() const;
 
+            /// Adds the items of a category. \see SetItemBuilder().
+            typedef std::function<void(CollapsibleCategory* category)> ItemBuilder;
+
+            /// Add the items when the category is first shown expanded,
+            /// rather than up front.
+            /// @param builder : Adds the items, with Add().
+            /// @param clearWhenCollapsed : Remove the items when the category
+            ///                             is collapsed, and add them again when
+            ///                             it is next expanded.
+            void SetItemBuilder(ItemBuilder builder, bool clearWhenCollapsed = false);
+
         public:
 
             Gwk::Event::Listener onSelection;
@@ -58,9 +69,14 @@ namespace Gwk
             void CalculateSize(Skin::Base *skin, Dim dim) override;
 
             virtual void OnSelection(Event::Info info);
+            virtual void OnExpandToggled(Event::Info info);
 
             Controls::Button*           m_button;
             Controls::CollapsibleList*  m_list;
+
+            ItemBuilder m_itemBuilder;
+            bool m_bItemsBuilt;
+            bool m_bClearWhenCollapsed;
         };
 
 
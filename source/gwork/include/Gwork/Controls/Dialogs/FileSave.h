@@ -10,6 +10,7 @@
 #define GWK_CONTROLS_DIALOGS_FILESAVE_H
 
 #include <Gwork/Gwork.h>
+#include <Gwork/Controls/FileDialog.h>
 
 namespace Gwk
 {
@@ -29,9 +30,19 @@ namespace Gwk
         //!
         //! @note Templated function simply to avoid having to manually cast the
         //!       callback function.
+        //! @note System only. Returns false if bUseSystem is false or the
+        //!       platform has no system dialogs (see Platform::HasFileDialogs()).
+        //!       Use the overload taking a parent to show the Gwork dialog.
         //
         bool FileSave(bool bUseSystem, const String& Name, const String& StartPath,
                       const String& Extension, String& fileSaveOut);
+
+        //! Show a Gwork file save dialog, which does not block.
+        //! @param parent : Control whose canvas shows the dialog.
+        //! @return The dialog. Its onFileChosen event gives the file chosen.
+        //
+        Controls::FileDialog* FileSave(Controls::Base* parent, const String& Name,
+                                       const String& StartPath, const String& Extension);
     }
 }
 
@@ -10,6 +10,7 @@
 #define GWK_CONTROLS_DIALOGS_FOLDEROPEN_H
 
 #include <Gwork/Gwork.h>
+#include <Gwork/Controls/FileDialog.h>
 
 namespace Gwk
 {
@@ -27,9 +28,19 @@ namespace Gwk
         //! ~~~~
         //! @note Templated function simply to avoid having to manually cast the
         //!       callback function.
+        //! @note System only. Returns false if bUseSystem is false or the
+        //!       platform has no system dialogs (see Platform::HasFileDialogs()).
+        //!       Use the overload taking a parent to show the Gwork dialog.
         //
         bool FolderOpen(bool bUseSystem, const String& Name, const String& StartPath,
                         String& folderChosenOut);
+
+        //! Show a Gwork folder dialog, which does not block.
+        //! @param parent : Control whose canvas shows the dialog.
+        //! @return The dialog. Its onFileChosen event gives the folder chosen.
+        //
+        Controls::FileDialog* FolderOpen(Controls::Base* parent, const String& Name,
+                                         const String& StartPath);
     }
 }
 
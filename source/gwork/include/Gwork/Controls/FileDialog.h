@@ -0,0 +1,139 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_CONTROLS_FILEDIALOG_H
+#define GWK_CONTROLS_FILEDIALOG_H
+
+#include <Gwork/Gwork.h>
+#include <Gwork/PlatformCommon.h>
+#include <Gwork/Controls/WindowControl.h>
+#include <Gwork/Controls/TextBox.h>
+#include <Gwork/Controls/ComboBox.h>
+#include <memory>
+#include <vector>
+
+namespace Gwk
+{
+    namespace ControlsInternal
+    {
+        class FileList;
+    }
+
+    namespace Controls
+    {
+        //
+        //! \brief A window to choose a file or folder, drawn by Gwork.
+        //!
+        //! The folder is read on a background thread. Its entries are shown
+        //! as they arrive, and only the rows in view are drawn, so large
+        //! folders open without a pause. Entries are kept sorted, folders
+        //! first, and filtered by the file type chosen and, when opening a
+        //! file, by the name typed.
+        //!
+        //! onFileChosen is called with the path chosen in Event::Info::String,
+        //! then the window closes. onWindowClosed is called either way.
+        //
+        class GWK_EXPORT FileDialog : public WindowControl
+        {
+        public:
+
+            GWK_CONTROL(FileDialog, WindowControl);
+
+            virtual ~FileDialog();
+
+            enum class Mode
+            {
+                Open,       //!< Choose an existing file.
+                Save,       //!< Choose a file name, which may not exist.
+                Folder      //!< Choose a folder.
+            };
+
+            void SetMode(Mode mode);
+            Mode GetMode() const { return m_mode; }
+
+            //! Set the file types to choose from, as pairs of a description
+            //! and patterns, e.g. "Images|*.png;*.jpg|Any Type|*.*".
+            void SetFileTypes(const String& fileTypes);
+
+            //! Show a folder. Its entries are read in the background.
+            void SetFolder(const String& folder);
+            const String& GetFolder() const { return m_folder; }
+
+            void SetFileName(const String& name);
+
+            //! Show the dialog modally, in the middle of the canvas, and
+            //! delete it once closed.
+            //! \param folder : Folder to start in, or the executable's if empty.
+            void ShowModal(const String& folder);
+
+            //! Entries read from the folder so far.
+            size_t GetEntryCount() const { return m_entries.size(); }
+
+            //! Entries shown, i.e. that pass the filters.
+            size_t GetShownCount() const { return m_shown.size(); }
+
+            //! True while the folder is still being read.
+            bool IsListing() const { return m_listing != nullptr; }
+
+            void Think() override;
+
+            Event::Listener onFileChosen;
+
+        protected:
+
+            friend class ControlsInternal::FileList;
+
+            struct Entry
+            {
+                String name;
+                String key;         // Lowercase name, to sort and filter by.
+                bool isDirectory;
+            };
+
+            struct Listing;
+
+            void AddEntries(std::vector<Platform::DirectoryEntry>& batch);
+            void Refilter(bool bNarrowed);
+            bool PassesFilters(const Entry& entry) const;
+            bool SortsBefore(unsigned int a, unsigned int b) const;
+            void UpdateStatus();
+
+            void OnSelected(int entry);
+            void Activate(int row);
+            void Choose(const String& path);
+
+            void OnUp(Event::Info);
+            void OnPathEntered(Event::Info);
+            void OnNameChanged(Event::Info);
+            void OnFileTypeChanged(Event::Info);
+            void OnOk(Event::Info);
+            void OnCancel(Event::Info);
+
+            Mode m_mode;
+            String m_folder;
+
+            std::vector<Entry> m_entries;       // All entries read, in the order read.
+            std::vector<unsigned int> m_sorted; // Their indices, sorted.
+            std::vector<unsigned int> m_shown;  // Those of m_sorted that pass the filters.
+            String m_nameFilter;                // Lowercase.
+            std::vector<String> m_typePatterns; // Lowercase.
+
+            std::shared_ptr<Listing> m_listing; // Null when the folder has been read.
+            bool m_bListFailed;
+
+            TextBox*                     m_path;
+            ControlsInternal::FileList*  m_list;
+            TextBox*                     m_name;
+            ComboBox*                    m_fileTypes;
+            Button*                      m_ok;
+            Label*                       m_status;
+        };
+
+    }
+}
+
+#endif // ifndef GWK_CONTROLS_FILEDIALOG_H
@@ -10,6 +10,7 @@
 #define GWK_CONTROLS_FILEPICKER_H
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/Platform.h>
 #include <Gwork/Controls/Dialogs/FileOpen.h>
 #include <Gwork/Controls/TextBox.h>
 
@@ -60,13 +61,29 @@ namespace Gwk
 
             void OnBrowse(Event::Info)
             {
+                // Start in the folder of the file chosen, if any.
+                const String& fileName = GetFileName();
+                const String startPath = fileName.substr(0, fileName.find_last_of("/\\") + 1);
+
+                if (!Platform::HasFileDialogs())
+                {
+                    Dialogs::FileOpen(this, "Name", startPath, m_fileType)
+                        ->onFileChosen.Add(this, &FilePicker::OnFileChosen);
+                    return;
+                }
+
                 String fileChosen;
-                if (Dialogs::FileOpen(true, "Name", "Start Path", m_fileType, fileChosen))
+                if (Dialogs::FileOpen(true, "Name", startPath, m_fileType, fileChosen))
                 {
                     SetFileName(fileChosen);
                 }
             }
 
+            void OnFileChosen(Event::Info info)
+            {
+                SetFileName(info.String);
+            }
+
             String GetValue() override
             {
                 return GetFileName();
@@ -10,6 +10,7 @@
 #define GWK_CONTROLS_FOLDERPICKER_H
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/Platform.h>
 #include <Gwork/Controls/Dialogs/FolderOpen.h>
 #include <Gwork/Controls/TextBox.h>
 
@@ -51,6 +52,13 @@ namespace Gwk
 
             void OnBrowse(Event::Info)
             {
+                if (!Platform::HasFileDialogs())
+                {
+                    Dialogs::FolderOpen(this, m_browseName, GetFolder())
+                        ->onFileChosen.Add(this, &FolderPicker::OnFolderChosen);
+                    return;
+                }
+
                 String folder;
                 if (Dialogs::FolderOpen(true, "Name", GetFolder(), folder))
                 {
@@ -58,6 +66,11 @@ namespace Gwk
                 }
             }
 
+            void OnFolderChosen(Event::Info info)
+            {
+                SetFolder(info.String);
+            }
+
             String GetValue() override
             {
                 return GetFolder();
@@ -28,11 +28,14 @@ namespace Gwk {
                 SetStretch(true);
                 m_texWidth = 0.0f;
                 m_texHeight = 0.0f;
+                m_status = Texture::Status::Unloaded;
             }
 
             virtual ~ImagePanel()
             {
-                GetSkin()->GetRender()->GetLoader().FreeTexture(m_texture);
+                IResourceLoader& loader = GetSkin()->GetRender()->GetLoader();
+                loader.CancelTextureLoad(m_texture, this);
+                loader.FreeTexture(m_texture);
             }
 
             virtual void SetUV(float u1, float v1, float u2, float v2)
@@ -43,28 +46,42 @@ namespace Gwk {
                 m_uv[3] = v2;
             }
 
-            virtual void SetImage(const String& imageName)
+            //! Set the image shown.
+            //! \param imageName : Texture name.
+            //! \param async : Load the image in the background, if the
+            //!                renderer can. Until it is loaded, the panel draws
+            //!                a placeholder and its texture size is 0.
+            //!                onImageLoaded is called when it is ready.
+            virtual void SetImage(const String& imageName, bool async = false)
             {
-                m_texture.name = imageName;
                 IResourceLoader& loader = GetSkin()->GetRender()->GetLoader();
-                Texture::Status m_status = loader.LoadTexture(m_texture);
-                switch (m_status)
+                loader.CancelTextureLoad(m_texture, this);
+
+                m_texture.SetName(imageName);
+                m_texWidth = 0.0f;
+                m_texHeight = 0.0f;
+
+                if (async)
+                {
+                    m_status = loader.LoadTextureAsync(m_texture, this,
+                                                       [this](Texture::Status status)
+                                                       {
+                                                           OnImageLoaded(status);
+                                                       });
+                    if (m_status == Texture::Status::Loading)
+                        return;
+                }
+                else
                 {
-                    case Texture::Status::Loaded:
-                    {
-                        TextureData texData = loader.GetTextureData(m_texture);
-                        m_texWidth = texData.width;
-                        m_texHeight = texData.height;
-                        break;
-                    }
-                    default:
-                        ;
+                    m_status = loader.LoadTexture(m_texture);
                 }
+
+                UpdateTextureSize();
             }
 
-            virtual String& GetImage()
+            virtual const String& GetImage()
             {
-                return m_texture.name;
+                return m_texture.GetName();
             }
 
             virtual int TextureWidth()
@@ -79,13 +96,19 @@ namespace Gwk {
 
             virtual const String& GetImageName()
             {
-                return m_texture.name;
+                return m_texture.GetName();
             }
 
             void Render(Skin::Base* skin) override
             {
                 Renderer::Base* render = skin->GetRender();
 
+                if (m_status == Texture::Status::Loading)
+                {
+                    render->DrawLoadingImage(GetRenderBounds());
+                    return;
+                }
+
                 render->SetDrawColor(m_drawColor);
 
                 if (m_bStretch)
@@ -114,7 +137,13 @@ namespace Gwk {
 
             virtual bool FailedToLoad()
             {
-                return m_status != Texture::Status::Loaded;
+                return m_status != Texture::Status::Loaded && m_status != Texture::Status::Loading;
+            }
+
+            //! True while the image is being loaded in the background.
+            bool IsLoading() const
+            {
+                return m_status == Texture::Status::Loading;
             }
 
             virtual bool GetStretch()
@@ -127,8 +156,30 @@ namespace Gwk {
                 m_bStretch = b;
             }
 
+            //! Called when an image loaded in the background is ready, or has
+            //! failed to load.
+            Event::Listener onImageLoaded;
+
         protected:
 
+            virtual void OnImageLoaded(Texture::Status status)
+            {
+                m_status = status;
+                UpdateTextureSize();
+                Redraw();
+                onImageLoaded.Call(this);
+            }
+
+            void UpdateTextureSize()
+            {
+                if (m_status != Texture::Status::Loaded)
+                    return;
+
+                TextureData texData = GetSkin()->GetRender()->GetLoader().GetTextureData(m_texture);
+                m_texWidth = texData.width;
+                m_texHeight = texData.height;
+            }
+
             Texture m_texture;
             float m_uv[4];
             Gwk::Color m_drawColor;
@@ -42,6 +42,21 @@ namespace Gwk
             bool IsMenuOpen();
             void ClearItems();
 
+            //! Adds the items of a menu. \see SetItemBuilder().
+            typedef std::function<void(Menu* menu)> ItemBuilder;
+
+            //! \brief Add the items when the menu is first opened, rather than
+            //! up front.
+            //! \param builder : Adds the items to the menu.
+            //! \param clearWhenClosed : Remove the items when the menu is
+            //!                          closed, and add them again when it is
+            //!                          next opened.
+            void SetItemBuilder(ItemBuilder builder, bool clearWhenClosed = false);
+
+            //! Add the items, if the menu has a builder and they are not added.
+            //! Called when the menu is opened.
+            void BuildItems();
+
             virtual void Open(Position pos);
             virtual void Close();
 
@@ -83,6 +98,10 @@ namespace Gwk
 
             bool m_bDisableIconMargin;
             bool m_bDeleteOnClose;
+
+            ItemBuilder m_itemBuilder;
+            bool m_bItemsBuilt;
+            bool m_bClearWhenClosed;
         };
 
 
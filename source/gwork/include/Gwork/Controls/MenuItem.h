@@ -37,6 +37,17 @@ namespace Gwk
 
             Menu* GetMenu();
 
+            //! Adds the items of a submenu. The same as Menu::ItemBuilder.
+            typedef std::function<void(Menu* menu)> MenuBuilder;
+
+            //! \brief Give the item a submenu that is made, and has its items
+            //! added, when it is first opened.
+            //! \see Menu::SetItemBuilder().
+            void SetMenuBuilder(MenuBuilder builder, bool clearWhenClosed = false);
+
+            //! Delete the submenu, if there is one, when it is safe to.
+            void DeleteMenu();
+
             bool IsMenuOpen();
             void OpenMenu();
             void CloseMenu();
@@ -82,7 +93,11 @@ namespace Gwk
 
         private:
 
+            void AddSubmenuArrow();
+
             Menu*   m_menu;
+            MenuBuilder m_menuBuilder;      // Until the menu is made.
+            bool m_bClearMenuWhenClosed;
             bool m_bOnStrip;
             bool m_bCheckable;
             bool m_bChecked;
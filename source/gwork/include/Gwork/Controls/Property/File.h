@@ -11,6 +11,7 @@
 
 #include <Gwork/Controls/Properties.h>
 #include <Gwork/Controls/Button.h>
+#include <Gwork/Platform.h>
 #include <Gwork/Controls/Dialogs/FileOpen.h>
 
 namespace Gwk
@@ -41,6 +42,16 @@ namespace Gwk
 
                 void OnButtonPress(Event::Info)
                 {
+                    if (!Platform::HasFileDialogs())
+                    {
+                        const String& fileName = m_textBox->GetText();
+                        Dialogs::FileOpen(this, m_strDialogName,
+                                          fileName.substr(0, fileName.find_last_of("/\\") + 1),
+                                          m_strFileExtension)
+                            ->onFileChosen.Add(this, &ThisClass::OnFileChosen);
+                        return;
+                    }
+
                     String fileChosen;
                     if (Dialogs::FileOpen(true, m_strDialogName,
                                           m_textBox->GetText(), m_strFileExtension, fileChosen))
@@ -49,6 +60,11 @@ namespace Gwk
                     }
                 }
 
+                void OnFileChosen(Event::Info info)
+                {
+                    m_textBox->SetText(info.String);
+                }
+
                 String m_strDialogName;
                 String m_strFileExtension;
             };
@@ -11,6 +11,7 @@
 
 #include <Gwork/Controls/Properties.h>
 #include <Gwork/Controls/Button.h>
+#include <Gwork/Platform.h>
 #include <Gwork/Controls/Dialogs/FolderOpen.h>
 
 namespace Gwk
@@ -34,6 +35,13 @@ namespace Gwk
 
                 void OnButtonPress(Event::Info)
                 {
+                    if (!Platform::HasFileDialogs())
+                    {
+                        Dialogs::FolderOpen(this, m_strDialogName, m_textBox->GetText())
+                            ->onFileChosen.Add(this, &ThisClass::OnFolderChosen);
+                        return;
+                    }
+
                     String folder;
                     if (Dialogs::FolderOpen(true, m_strDialogName,
                                             m_textBox->GetText(), folder))
@@ -42,6 +50,11 @@ namespace Gwk
                     }
                 }
 
+                void OnFolderChosen(Event::Info info)
+                {
+                    m_textBox->SetText(info.String);
+                }
+
                 String m_strDialogName;
             };
 
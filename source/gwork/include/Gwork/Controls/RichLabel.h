@@ -12,6 +12,7 @@
 #include <Gwork/BaseRender.h>
 #include <Gwork/Controls/Base.h>
 #include <Gwork/Controls/Text.h>
+#include <vector>
 
 
 namespace Gwk
@@ -28,6 +29,7 @@ namespace Gwk
             void AddText(const Gwk::String& text, Gwk::Color color, Gwk::Font* font = nullptr);
 
             bool SizeToChildren(bool w = true, bool h = true) override;
+            Gwk::Point ChildrenSize() override;
 
         protected:
 
@@ -47,7 +49,18 @@ namespace Gwk
             };
 
 
+            //! A piece of text laid out on one line, in one style.
+            struct Fragment
+            {
+                Gwk::String text;
+                Gwk::Color color;
+                const Gwk::Font* font;
+                Gwk::Rect bounds;
+            };
+
+            void Render(Gwk::Skin::Base* skin) override;
             void Layout(Gwk::Skin::Base* skin) override;
+            void CalculateSize(Gwk::Skin::Base* skin, Dim dim) override;
             void SplitLabel(const Gwk::String& text, const Gwk::Font& font,
                             const DividedText& txt, int& x, int& y, int& lineheight);
             void CreateNewline(int& x, int& y, int& lineheight);
@@ -58,6 +71,9 @@ namespace Gwk
             void OnBoundsChanged(Gwk::Rect oldBounds) override;
 
             DividedText::List m_textBlocks;
+            std::vector<Fragment> m_fragments;  //!< Laid out text, in line order.
+            Gwk::Point m_contentSize;
+            int m_fragmentHeight;               //!< Tallest fragment.
             bool m_bNeedsRebuild;
         };
 
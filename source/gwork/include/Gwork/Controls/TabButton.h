@@ -36,6 +36,25 @@ namespace Gwk
                 return m_page;
             }
 
+            //! Adds the content of a page to it. \see SetPageBuilder().
+            typedef std::function<void(Base* page)> PageBuilder;
+
+            //! \brief Build the content of the page when it is first shown,
+            //! rather than up front.
+            //! \param builder : Adds the content to the page, which is empty.
+            //! \param destroyWhenHidden : Delete the children of the page when
+            //!                            another page is shown, and build it
+            //!                            again when this one is next shown.
+            void SetPageBuilder(PageBuilder builder, bool destroyWhenHidden = false);
+
+            //! Build the content of the page, if it has a builder and is not
+            //! built. Called by the TabControl before the page is shown.
+            void BuildPage();
+
+            //! Delete the content of the page, if it is destroyed when hidden.
+            //! Called by the TabControl after the page is hidden.
+            void ReleasePage();
+
             void        SetTabControl(TabControl* ctrl);
             TabControl* GetTabControl()
             {
@@ -76,6 +95,10 @@ namespace Gwk
             Base*       m_page;
             TabControl* m_control;
 
+            PageBuilder m_pageBuilder;
+            bool        m_bPageBuilt;
+            bool        m_bDestroyPageWhenHidden;
+
         };
 
     }
@@ -37,8 +37,8 @@ namespace Gwk
 
             Base(Gwk::Renderer::Base* renderer = nullptr)
             {
-                m_defaultFont.facename = "Arial";
-                m_defaultFont.size = 10.0f;
+                m_defaultFont.SetFacename("Arial");
+                m_defaultFont.SetSize(10.0f);
                 m_render = renderer;
             }
 
@@ -276,8 +276,8 @@ namespace Gwk
 
             virtual void SetDefaultFont(const Gwk::String& strFacename, float fSize = 10.0f)
             {
-                m_defaultFont.facename = strFacename;
-                m_defaultFont.size = fSize;
+                m_defaultFont.SetFacename(strFacename);
+                m_defaultFont.SetSize(fSize);
             }
 
         protected:
@@ -59,8 +59,8 @@ namespace Gwk
                 m_colTooltipBackground      = Gwk::Color(255, 255, 225, 255);
                 m_colTooltipBorder          = Gwk::Color(0, 0, 0, 255);
                 m_colModal = Gwk::Color(25, 25, 25, 150);
-                m_defaultFont.facename  = "Microsoft Sans Serif";
-                m_defaultFont.size      = 11;
+                m_defaultFont.SetFacename("Microsoft Sans Serif");
+                m_defaultFont.SetSize(11);
             }
 
             void DrawGenericPanel(Controls::Base* control) override
@@ -295,13 +295,15 @@ namespace Gwk
 
             virtual void Init( const String & TextureName )
             {
-                m_defaultFont.facename  = "Microsoft Sans Serif";
-                m_defaultFont.size      = 11;
+                m_defaultFont.SetFacename("Microsoft Sans Serif");
+                m_defaultFont.SetSize(11);
 
-                m_texture.name = TextureName;
+                m_texture.SetName(TextureName);
                 m_texture.readable = true;
                 Gwk::Renderer::Base* render = GetRender();
-                render->GetLoader().LoadTexture(m_texture); // Readable texture
+                // Readable texture. Kept if it was preloaded.
+                if (render->GetTextureData(m_texture).width <= 0.f)
+                    render->GetLoader().LoadTexture(m_texture);
                 const TextureData& texData = render->GetTextureData(m_texture);
 
                 Colors.Window.TitleActive   = render->PixelColor( m_texture, 4 + 8 * 0, 508, Color( 255, 0, 0 ) );
@@ -99,6 +99,20 @@ namespace Gwk
                     m_margin.right *= DrawMarginScale;
                     m_margin.top *= DrawMarginScale;
                     m_margin.bottom *= DrawMarginScale;
+
+                    m_patch.u[0] = m_rects[0].m_uv[0];
+                    m_patch.u[1] = m_rects[1].m_uv[0];
+                    m_patch.u[2] = m_rects[2].m_uv[0];
+                    m_patch.u[3] = m_rects[2].m_uv[2];
+                    m_patch.v[0] = m_rects[0].m_uv[1];
+                    m_patch.v[1] = m_rects[3].m_uv[1];
+                    m_patch.v[2] = m_rects[6].m_uv[1];
+                    m_patch.v[3] = m_rects[6].m_uv[3];
+                    m_patch.left = m_margin.left;
+                    m_patch.top = m_margin.top;
+                    m_patch.right = m_margin.right;
+                    m_patch.bottom = m_margin.bottom;
+
                     m_width = w - x;
                     m_height = h - y;
                 }
@@ -127,49 +141,15 @@ namespace Gwk
                     if (!m_texture)
                         return;
 
-                    render->SetDrawColor( col );
-
                     if (r.w < m_width && r.h < m_height)
                     {
+                        render->SetDrawColor( col );
                         render->DrawTexturedRect(*m_texture, r,
                                                  m_rects[0].m_uv[0], m_rects[0].m_uv[1], m_rects[8].m_uv[2], m_rects[8].m_uv[3]);
                         return;
                     }
 
-                    if (draw & (1<<0))
-                        DrawRect( render, 0, r.x, r.y, m_margin.left, m_margin.top );
-
-                    if (draw & (1<<1))
-                        DrawRect( render, 1, r.x + m_margin.left, r.y, r.w - m_margin.left - m_margin.right, m_margin.top );
-
-                    if (draw & (1<<2))
-                        DrawRect( render, 2, ( r.x + r.w ) - m_margin.right, r.y, m_margin.right, m_margin.top );
-
-                    if (draw & (1<<3))
-                        DrawRect( render, 3, r.x, r.y + m_margin.top, m_margin.left, r.h - m_margin.top - m_margin.bottom );
-
-                    if (draw & (1<<4))
-                        DrawRect( render, 4, r.x + m_margin.left, r.y + m_margin.top,
-                                             r.w - m_margin.left - m_margin.right, r.h - m_margin.top - m_margin.bottom );
-
-                    if (draw & (1<<5))
-                        DrawRect( render, 5, ( r.x + r.w ) - m_margin.right, r.y + m_margin.top, m_margin.right, r.h - m_margin.top - m_margin.bottom );
-
-                    if (draw & (1<<6))
-                        DrawRect( render, 6, r.x, ( r.y + r.h ) - m_margin.bottom, m_margin.left, m_margin.bottom );
-
-                    if (draw & (1<<7))
-                        DrawRect( render, 7, r.x + m_margin.left, ( r.y + r.h ) - m_margin.bottom, r.w - m_margin.left - m_margin.right, m_margin.bottom );
-
-                    if (draw & (1<<8))
-                        DrawRect( render, 8, ( r.x + r.w ) - m_margin.right, ( r.y + r.h ) - m_margin.bottom, m_margin.right, m_margin.bottom );
-                }
-
-                void DrawRect( Gwk::Renderer::Base* render, int i, int x, int y, int w, int h )
-                {
-                    render->DrawTexturedRect( *m_texture,
-                                              Gwk::Rect( x, y, w, h ),
-                                              m_rects[i].m_uv[0], m_rects[i].m_uv[1], m_rects[i].m_uv[2], m_rects[i].m_uv[3] );
+                    render->DrawNinePatch( *m_texture, r, m_patch, col, draw );
                 }
 
                 Texture* m_texture;
@@ -181,6 +161,7 @@ namespace Gwk
                 };
 
                 SubRect m_rects[9];
+                Gwk::Renderer::NinePatch m_patch;
                 Margin m_margin;
                 float m_width;
                 float m_height;
@@ -10,19 +10,45 @@
 #include <Gwork/BaseRender.h>
 #include <Gwork/Utility.h>
 #include <Gwork/Platform.h>
+#include <Gwork/PlatformCommon.h>
+#include <Gwork/JobSystem.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace Gwk
 {
 namespace Renderer
 {
 
+//
+// Textures being loaded in the background. Decoders run on the background
+// threads, then queue their results here for the render thread to finish.
+//
+struct Base::TextureLoads
+{
+    typedef std::vector<std::pair<const void*, TextureLoadedCallback>> Callbacks;
+
+    // Callbacks waiting for each texture, by owner. Only used on the render thread.
+    std::unordered_map<Texture, Callbacks> waiting;
+
+    std::mutex mutex;
+    std::vector<std::pair<Texture, TextureFinisher>> decoded;   // Guarded by the mutex.
+    std::atomic<bool> ready;
+
+    TextureLoads() : ready(false) {}
+};
+
 Base::Base(ResourcePaths& paths)
 :   m_fScale(1.0f)
 ,   m_paths(paths)
 ,   m_renderOffset(Gwk::Point(0, 0))
 ,   m_RTT(nullptr)
+,   m_textureLoads(std::make_shared<TextureLoads>())
 {
 }
 
@@ -71,6 +97,64 @@ void Base::DrawShavedCornerRect(Gwk::Rect rect, bool bSlight)
     }
 }
 
+// Color i of n steps from a to b, inclusive.
+static Gwk::Color LerpColor(const Gwk::Color& a, const Gwk::Color& b, int i, int n)
+{
+    const float t = n > 1 ? float(i) / (n - 1) : 0.f;
+    return Gwk::Color(static_cast<unsigned char>(a.r + (b.r - a.r) * t + 0.5f),
+                      static_cast<unsigned char>(a.g + (b.g - a.g) * t + 0.5f),
+                      static_cast<unsigned char>(a.b + (b.b - a.b) * t + 0.5f),
+                      static_cast<unsigned char>(a.a + (b.a - a.a) * t + 0.5f));
+}
+
+void Base::DrawLinearGradientRect(Gwk::Rect rect, Gwk::Color start, Gwk::Color end,
+                                  bool vertical)
+{
+    // A line of each color.
+    const int n = vertical ? rect.h : rect.w;
+    for (int i = 0; i < n; ++i)
+    {
+        SetDrawColor(LerpColor(start, end, i, n));
+        if (vertical)
+            DrawFilledRect(Gwk::Rect(rect.x, rect.y + i, rect.w, 1));
+        else
+            DrawFilledRect(Gwk::Rect(rect.x + i, rect.y, 1, rect.h));
+    }
+}
+
+void Base::DrawBilinearGradientRect(Gwk::Rect rect,
+                                    Gwk::Color topLeft, Gwk::Color topRight,
+                                    Gwk::Color bottomLeft, Gwk::Color bottomRight)
+{
+    for (int i = 0; i < rect.h; ++i)
+    {
+        DrawLinearGradientRect(Gwk::Rect(rect.x, rect.y + i, rect.w, 1),
+                               LerpColor(topLeft, bottomLeft, i, rect.h),
+                               LerpColor(topRight, bottomRight, i, rect.h));
+    }
+}
+
+void Base::DrawNinePatch(const Gwk::Texture& texture, Gwk::Rect rect,
+                         const NinePatch& grid, Gwk::Color color, unsigned int draw)
+{
+    SetDrawColor(color);
+
+    // Edges of the areas, left to right and top to bottom.
+    const int x[4] = { rect.x, rect.x + grid.left, rect.Right() - grid.right, rect.Right() };
+    const int y[4] = { rect.y, rect.y + grid.top, rect.Bottom() - grid.bottom, rect.Bottom() };
+
+    for (int i = 0; i < 9; ++i)
+    {
+        if (!(draw & (1 << i)))
+            continue;
+
+        const int col = i % 3, row = i / 3;
+        DrawTexturedRect(texture,
+                         Gwk::Rect(x[col], y[row], x[col + 1] - x[col], y[row + 1] - y[row]),
+                         grid.u[col], grid.v[row], grid.u[col + 1], grid.v[row + 1]);
+    }
+}
+
 void Base::Translate(int& x, int& y)
 {
     x += m_renderOffset.x;
@@ -137,12 +221,158 @@ void Base::DrawMissingImage(Gwk::Rect targetRect)
     DrawFilledRect(targetRect);
 }
 
+void Base::DrawLoadingImage(Gwk::Rect targetRect)
+{
+    SetDrawColor(Color(128, 128, 128, 64));
+    DrawFilledRect(targetRect);
+}
+
+Texture::Status Base::LoadTextureAsync(const Gwk::Texture& texture, const void* owner,
+                                       const TextureLoadedCallback& onLoaded)
+{
+    auto found = m_textureLoads->waiting.find(texture);
+    if (found == m_textureLoads->waiting.end())
+    {
+        // Not being loaded already. The decoder holds on to the shared state,
+        // as the renderer may be gone by the time it has finished.
+        std::shared_ptr<TextureLoads> loads = m_textureLoads;
+        TextureDecoder decode = GetTextureDecoder(texture);
+        Platform::RunInBackground([loads, texture, decode]()
+        {
+            TextureFinisher finish = decode();
+
+            std::lock_guard<std::mutex> lock(loads->mutex);
+            loads->decoded.emplace_back(texture, std::move(finish));
+            loads->ready = true;
+        });
+
+        found = m_textureLoads->waiting.insert(std::make_pair(texture,
+                                                              TextureLoads::Callbacks())).first;
+    }
+
+    found->second.emplace_back(owner, onLoaded);
+    return Texture::Status::Loading;
+}
+
+void Base::CancelTextureLoad(const Gwk::Texture& texture, const void* owner)
+{
+    auto found = m_textureLoads->waiting.find(texture);
+    if (found == m_textureLoads->waiting.end())
+        return;
+
+    TextureLoads::Callbacks& callbacks = found->second;
+    callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(),
+                                   [owner](const TextureLoads::Callbacks::value_type& cb)
+                                   {
+                                       return cb.first == owner;
+                                   }),
+                    callbacks.end());
+
+    // With nobody waiting, the texture is dropped when it has been decoded.
+    if (callbacks.empty())
+        m_textureLoads->waiting.erase(found);
+}
+
+bool Base::TextureLoadsReady() const
+{
+    return m_textureLoads->ready;
+}
+
+void Base::FinishTextureLoads()
+{
+    if (!m_textureLoads->ready)
+        return;
+
+    std::vector<std::pair<Texture, TextureFinisher>> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_textureLoads->mutex);
+        decoded.swap(m_textureLoads->decoded);
+        m_textureLoads->ready = false;
+    }
+
+    for (auto& load : decoded)
+    {
+        auto found = m_textureLoads->waiting.find(load.first);
+        if (found == m_textureLoads->waiting.end())
+            continue;   // cancelled
+
+        // The callbacks may start or cancel other loads.
+        const TextureLoads::Callbacks callbacks = std::move(found->second);
+        m_textureLoads->waiting.erase(found);
+
+        const Texture::Status status = load.second();
+        for (const auto& cb : callbacks)
+        {
+            if (cb.second)
+                cb.second(status);
+        }
+    }
+}
+
+Base::TextureDecoder Base::GetTextureDecoder(const Gwk::Texture& texture)
+{
+    return [this, texture]() -> TextureFinisher
+    {
+        return [this, texture]() { return LoadTexture(texture); };
+    };
+}
+
+void Base::Preload(const std::vector<Gwk::Font>& fonts, const std::vector<Gwk::Texture>& textures)
+{
+    Platform::JobSystem& jobs = Platform::JobSystem::Get();
+    Platform::JobSystem::Group group;
+
+    // Each job sets its own finisher, so they need no locking.
+    std::vector<TextureFinisher> textureFinishers(textures.size());
+    for (size_t i = 0; i < textures.size(); ++i)
+    {
+        if (GetTextureData(textures[i]).width > 0.f)
+            continue;
+
+        TextureDecoder decode = GetTextureDecoder(textures[i]);
+        TextureFinisher* finish = &textureFinishers[i];
+        jobs.Run(group, [decode, finish]() { *finish = decode(); });
+    }
+
+    std::vector<FontFinisher> fontFinishers(fonts.size());
+    for (size_t i = 0; i < fonts.size(); ++i)
+    {
+        FontBaker bake = GetFontBaker(fonts[i]);
+        if (!bake)
+            continue;
+
+        FontFinisher* finish = &fontFinishers[i];
+        jobs.Run(group, [bake, finish]() { *finish = bake(); });
+    }
+
+    jobs.Wait(group);
+
+    for (const TextureFinisher& finish : textureFinishers)
+    {
+        if (finish)
+            finish();
+    }
+    for (const FontFinisher& finish : fontFinishers)
+    {
+        if (finish)
+            finish();
+    }
+}
+
+Base::FontBaker Base::GetFontBaker(const Gwk::Font& font)
+{
+    return [this, font]() -> FontFinisher
+    {
+        return [this, font]() { EnsureFont(font); };
+    };
+}
+
 ///  If they haven't defined these font functions in their renderer code
 ///  we just draw some rects where the letters would be to give them an
 ///  idea.
 void Base::RenderText(const Gwk::Font& font, Gwk::Point pos, const Gwk::String& text)
 {
-    const float fSize = font.size * Scale();
+    const float fSize = font.GetSize() * Scale();
 
     for (unsigned int i = 0; i < text.length(); i++)
     {
@@ -188,8 +418,8 @@ void Base::RenderText(const Gwk::Font& font, Gwk::Point pos, const Gwk::String&
 Gwk::Point Base::MeasureText(const Gwk::Font& font, const Gwk::String& text)
 {
     Gwk::Point p;
-    p.x = font.size * Scale() * text.length() * 0.4f;
-    p.y = font.size * Scale();
+    p.x = font.GetSize() * Scale() * text.length() * 0.4f;
+    p.y = font.GetSize() * Scale();
     return p;
 }
 
@@ -587,11 +587,15 @@ void Base::DoCacheRender(Gwk::Skin::Base* skin, Gwk::Controls::Base* master)
     else
     {
         render->SetRenderOffset(Gwk::Point(0, 0));
-        render->SetClipRegion(GetBounds());
+        render->SetClipRegion(Gwk::Rect(Gwk::Point(0, 0), GetBounds().GetSize()));
     }
 
-    // See if we need to update the cached texture. Dirty?
-    if (m_bCacheTextureDirty && render->ClipRegionVisible())
+    if (IsCachedToTexture())
+        cache->CreateControlCacheTexture(this, GetBounds().GetSize());
+
+    // See if we need to update the cached texture. Dirty, or freed by the cache?
+    if ((m_bCacheTextureDirty || !cache->IsCacheTextureValid(this))
+        && render->ClipRegionVisible())
     {
         render->StartClip();
         {
@@ -624,12 +628,14 @@ void Base::DoCacheRender(Gwk::Skin::Base* skin, Gwk::Controls::Base* master)
         render->EndClip();
     }
 
-    // Draw the cached texture.
+    // Draw the cached texture, where the control is.
     render->SetClipRegion(rOldRegion);
     render->StartClip();
     {
         render->SetRenderOffset(oldRenderOffset);
+        render->AddRenderOffset(GetBounds());
         cache->DrawCachedControlTexture(this);
+        render->SetRenderOffset(oldRenderOffset);
     }
     render->EndClip();
 }
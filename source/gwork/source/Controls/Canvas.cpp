@@ -37,10 +37,19 @@ Canvas::~Canvas()
     ReleaseChildren();
 }
 
+void Canvas::Preload(const std::vector<Gwk::Font>& fonts,
+                     const std::vector<Gwk::Texture>& textures)
+{
+    Gwk::Renderer::Base* render = m_skin->GetRender();
+    render->SetScale(Scale());
+    render->Preload(fonts, textures);
+}
+
 void Canvas::RenderCanvas()
 {
     DoThink();
     Gwk::Renderer::Base* render = m_skin->GetRender();
+    render->FinishTextureLoads();
     render->Begin();
     RecurseLayout(m_skin);
     render->SetClipRegion(GetBounds());
@@ -77,6 +86,10 @@ void Canvas::DoThink()
     if (Hidden())
         return;
 
+    // Draw a frame to finish the textures loaded in the background.
+    if (m_skin && m_skin->GetRender()->TextureLoadsReady())
+        Redraw();
+
 #if GWK_ANIMATE
     Gwk::Anim::Think();
 #endif
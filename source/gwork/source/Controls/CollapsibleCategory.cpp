@@ -100,6 +100,9 @@ GWK_CONTROL_CONSTRUCTOR(CollapsibleCategory)
     m_button->Dock(Position::Top);
     m_button->SetHeight(20);
     m_button->SetSizeFlags({SizeFlag::Elastic, SizeFlag::Fixed});
+    m_button->onToggle.Add(this, &ThisClass::OnExpandToggled);
+    m_bItemsBuilt = false;
+    m_bClearWhenCollapsed = false;
     SetPadding(Padding(1, 0, 1, 5));
     SetSize(512, 512);
 }
@@ -160,6 +163,13 @@ void CollapsibleCategory::UnselectAll()
 
 void CollapsibleCategory::CalculateSize(Skin::Base *skin, Dim dim)
 {
+    // Laid out expanded, so the items are about to be shown.
+    if (!m_button->GetToggleState() && m_itemBuilder && !m_bItemsBuilt)
+    {
+        m_bItemsBuilt = true;
+        m_itemBuilder(this);
+    }
+
     if(ProcessLayout(skin, dim))
         return;
 
@@ -214,6 +224,34 @@ Button* CollapsibleCategory::GetSelected()
 }
 
 
+void CollapsibleCategory::SetItemBuilder(ItemBuilder builder, bool clearWhenCollapsed)
+{
+    m_itemBuilder = builder;
+    m_bItemsBuilt = false;
+    m_bClearWhenCollapsed = clearWhenCollapsed;
+    Invalidate();
+}
+
+void CollapsibleCategory::OnExpandToggled(Event::Info info)
+{
+    if (IsExpanded() || !m_bItemsBuilt || !m_bClearWhenCollapsed)
+        return;
+
+    // Deleted later, as the category may be collapsed by one of its items.
+    for (auto&& control : GetChildren())
+    {
+        CategoryButton* child = gwk_cast<CategoryButton>(control);
+
+        if (!child)
+            continue;
+
+        child->SetHidden(true);
+        child->DelayedDelete();
+    }
+
+    m_bItemsBuilt = false;
+}
+
 void CollapsibleCategory::SetExpanded(bool expanded)
 {
     m_button->SetToggleState(!expanded);
@@ -177,14 +177,13 @@ void ColorLerpBox::Render(Gwk::Skin::Base* skin)
     // "actually" render these
     ParentClass::Render(skin);
 
-    for (int x = 0; x < Width(); x++)
-    {
-        for (int y = 0; y < Height(); y++)
-        {
-            skin->GetRender()->SetDrawColor(GetColorAtPos(x, y));
-            skin->GetRender()->DrawPixel(x, y);
-        }
-    }
+    // The color is bilinear in x and y, so only the corners are needed.
+    const int right = Width() - 1, bottom = Height() - 1;
+    skin->GetRender()->DrawBilinearGradientRect(GetRenderBounds(),
+                                                GetColorAtPos(0, 0),
+                                                GetColorAtPos(right, 0),
+                                                GetColorAtPos(0, bottom),
+                                                GetColorAtPos(right, bottom));
 
     skin->GetRender()->SetDrawColor(Gwk::Color(0, 0, 0, 255));
     skin->GetRender()->DrawLinedRect(GetRenderBounds());
@@ -212,11 +211,17 @@ void ColorSlider::Render(Gwk::Skin::Base* skin)
     // Is there any way to move this into skin? Not for now, no idea how we'll
     // "actually" render these
 
-    for (int y = 0; y < Height(); y++)
+    // The hue is linear between each sixth of the circle.
+    for (int sixth = 0; sixth < 6; sixth++)
     {
-        const float yPercent = static_cast<float>(y) / Height();
-        skin->GetRender()->SetDrawColor(HSVToColor(yPercent*360, 1, 1));
-        skin->GetRender()->DrawFilledRect(Gwk::Rect(5, y, Width()-10, 1));
+        const int top = (sixth * Height() + 5) / 6;
+        const int bottom = ((sixth + 1) * Height() + 5) / 6;
+        if (bottom > top)
+        {
+            skin->GetRender()->DrawLinearGradientRect(Gwk::Rect(5, top, Width()-10, bottom-top),
+                                                      GetColorAtHeight(top),
+                                                      GetColorAtHeight(bottom-1), true);
+        }
     }
 
     int drawHeight = m_selectedDist-3;
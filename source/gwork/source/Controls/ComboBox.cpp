@@ -118,6 +118,9 @@ void ComboBox::ClearItems()
 {
     if (m_menu)
         m_menu->ClearItems();
+
+    // The items are deleted, so the next one added is selected.
+    m_selectedItem = nullptr;
 }
 
 void ComboBox::SelectItem(MenuItem* item, bool bFireChangeEvents)
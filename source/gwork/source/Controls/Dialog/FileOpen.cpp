@@ -13,14 +13,23 @@
 bool Gwk::Dialogs::FileOpen(bool bUseSystem, const String& Name, const String& StartPath,
                             const String& Extension, String& fileOpenOut)
 {
-    String fileOpened;
-
     if (bUseSystem)
     {
-        return Gwk::Platform::FileOpen(Name, StartPath, Extension, fileOpened);
+        return Gwk::Platform::FileOpen(Name, StartPath, Extension, fileOpenOut);
     }
 
-    // TODO: SHOW Gwork FILE SELECTION DIALOG
-
+    // The Gwork dialog does not block. Use the overload taking a parent.
     return false;
 }
+
+Gwk::Controls::FileDialog* Gwk::Dialogs::FileOpen(Controls::Base* parent, const String& Name,
+                                                  const String& StartPath,
+                                                  const String& Extension)
+{
+    Controls::FileDialog* dialog = new Controls::FileDialog(parent->GetCanvas());
+    dialog->SetTitle(Name);
+    dialog->SetMode(Controls::FileDialog::Mode::Open);
+    dialog->SetFileTypes(Extension);
+    dialog->ShowModal(StartPath);
+    return dialog;
+}
@@ -18,7 +18,18 @@ bool Gwk::Dialogs::FileSave(bool bUseSystem, const String& Name, const String& S
         return Gwk::Platform::FileSave(Name, StartPath, Extension, fileOpenOut);
     }
 
-    // TODO: SHOW Gwork FILE SELECTION DIALOG
-
+    // The Gwork dialog does not block. Use the overload taking a parent.
     return false;
 }
+
+Gwk::Controls::FileDialog* Gwk::Dialogs::FileSave(Controls::Base* parent, const String& Name,
+                                                  const String& StartPath,
+                                                  const String& Extension)
+{
+    Controls::FileDialog* dialog = new Controls::FileDialog(parent->GetCanvas());
+    dialog->SetTitle(Name);
+    dialog->SetMode(Controls::FileDialog::Mode::Save);
+    dialog->SetFileTypes(Extension);
+    dialog->ShowModal(StartPath);
+    return dialog;
+}
@@ -18,7 +18,16 @@ bool Gwk::Dialogs::FolderOpen(bool bUseSystem, const String& Name, const String&
         return Gwk::Platform::FolderOpen(Name, StartPath, folderChosenOut);
     }
 
-    // TODO: SHOW Gwork FOLDER SELECTION DIALOG
-
+    // The Gwork dialog does not block. Use the overload taking a parent.
     return false;
 }
+
+Gwk::Controls::FileDialog* Gwk::Dialogs::FolderOpen(Controls::Base* parent, const String& Name,
+                                                    const String& StartPath)
+{
+    Controls::FileDialog* dialog = new Controls::FileDialog(parent->GetCanvas());
+    dialog->SetTitle(Name);
+    dialog->SetMode(Controls::FileDialog::Mode::Folder);
+    dialog->ShowModal(StartPath);
+    return dialog;
+}
@@ -0,0 +1,874 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/Controls/FileDialog.h>
+#include <Gwork/Controls/VerticalScrollBar.h>
+#include <Gwork/Platform.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <mutex>
+
+using namespace Gwk;
+using namespace Gwk::Controls;
+
+static const size_t c_MaxAddedPerFrame = 8192;
+
+namespace
+{
+    String ToLowerAscii(String str)
+    {
+        for (char& c : str)
+        {
+            if (c >= 'A' && c <= 'Z')
+                c += 'a' - 'A';
+        }
+        return str;
+    }
+
+    String Trim(const String& str)
+    {
+        const size_t first = str.find_first_not_of(" \t");
+        if (first == String::npos)
+            return String();
+
+        return str.substr(first, str.find_last_not_of(" \t") - first + 1);
+    }
+
+    // Match a name against a pattern with '*' and '?' wildcards.
+    bool WildcardMatch(const String& pattern, const String& name)
+    {
+        size_t p = 0, n = 0;
+        size_t star = String::npos, starName = 0;
+
+        while (n < name.size())
+        {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+            {
+                ++p;
+                ++n;
+            }
+            else if (p < pattern.size() && pattern[p] == '*')
+            {
+                star = p++;
+                starName = n;
+            }
+            else if (star != String::npos)
+            {
+                p = star + 1;
+                n = ++starName;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (p < pattern.size() && pattern[p] == '*')
+            ++p;
+
+        return p == pattern.size();
+    }
+
+    bool IsSeparator(char c)
+    {
+        return c == '/' || c == '\\';
+    }
+
+    String JoinPath(const String& folder, const String& name)
+    {
+        if (folder.empty() || IsSeparator(folder.back()))
+            return folder + name;
+
+        return folder + "/" + name;
+    }
+
+    String ParentFolder(String folder)
+    {
+        while (folder.size() > 1 && IsSeparator(folder.back()))
+            folder.pop_back();
+
+        const size_t sep = folder.find_last_of("/\\");
+        if (sep == String::npos)
+            return folder;
+
+        // Keep the separator of a root, e.g. "/" or "C:/".
+        if (sep == 0 || (sep == 2 && folder[1] == ':'))
+            return folder.substr(0, sep + 1);
+
+        return folder.substr(0, sep);
+    }
+}
+
+struct FileDialog::Listing
+{
+    std::mutex mutex;
+    std::vector<Platform::DirectoryEntry> pending;  // Read, but not yet added.
+    bool done = false;
+    bool failed = false;
+    std::atomic<bool> cancelled { false };
+};
+
+namespace Gwk
+{
+namespace ControlsInternal
+{
+
+//
+// Draws only the rows of the dialog's entries that are in view, so its cost
+// does not depend on the size of the folder.
+//
+class FileList : public Controls::Base
+{
+public:
+
+    GWK_CONTROL_INLINE(FileList, Controls::Base)
+    {
+        m_dialog = nullptr;
+        m_selected = -1;
+        m_scrollTop = 0;
+        m_contentHeight = 0;
+
+        m_scrollBar = new Controls::VerticalScrollBar(this);
+        m_scrollBar->Dock(Position::Right);
+        m_scrollBar->onBarMoved.Add(this, &FileList::OnBarMoved);
+
+        SetKeyboardInputEnabled(true);
+        SetMouseInputEnabled(true);
+    }
+
+    void SetDialog(Controls::FileDialog* dialog)
+    {
+        m_dialog = dialog;
+    }
+
+    //! Index of the entry selected, or -1.
+    int GetSelected() const
+    {
+        return m_selected;
+    }
+
+    void SetSelected(int entry)
+    {
+        m_selected = entry;
+        Redraw();
+    }
+
+    //! Row of the entry selected, or -1 if none or it is filtered out.
+    int GetSelectedRow() const
+    {
+        if (m_selected < 0)
+            return -1;
+
+        const std::vector<unsigned int>& shown = m_dialog->m_shown;
+        const unsigned int selected = static_cast<unsigned int>(m_selected);
+        auto it = std::lower_bound(shown.begin(), shown.end(), selected,
+                                   [this](unsigned int a, unsigned int b)
+                                   {
+                                       return m_dialog->SortsBefore(a, b);
+                                   });
+
+        if (it == shown.end() || *it != selected)
+            return -1;
+
+        return static_cast<int>(it - shown.begin());
+    }
+
+    //! Scroll the rows so that top is the offset of the first in view.
+    void ScrollTo(float top)
+    {
+        const float scrollable = std::max(0.f, m_contentHeight - Height());
+        m_scrollTop = Clamp(top, 0.f, scrollable);
+        m_scrollBar->SetScrolledAmount(scrollable > 0 ? m_scrollTop / scrollable : 0, true);
+        Redraw();
+    }
+
+    void Layout(Skin::Base* skin) override
+    {
+        const int rowHeight = GetRowHeight();
+        const float content = static_cast<float>(m_dialog->m_shown.size() * rowHeight);
+        const float scrollable = std::max(0.f, content - Height());
+
+        m_scrollBar->SetHidden(content <= Height());
+        m_scrollBar->SetContentSize(content);
+        m_scrollBar->SetViewableContentSize(static_cast<float>(Height()));
+        m_scrollBar->SetNudgeAmount(static_cast<float>(rowHeight * 3));
+
+        // Follow the bar, unless rows were added or removed. Then keep the
+        // offset, rather than the fraction scrolled.
+        if (content == m_contentHeight)
+            m_scrollTop = m_scrollBar->GetScrolledAmount() * scrollable;
+
+        m_contentHeight = content;
+        m_scrollTop = Clamp(m_scrollTop, 0.f, scrollable);
+        m_scrollBar->SetScrolledAmount(scrollable > 0 ? m_scrollTop / scrollable : 0, false);
+
+        ParentClass::Layout(skin);
+    }
+
+    void Render(Skin::Base* skin) override
+    {
+        skin->DrawListBox(this);
+
+        Renderer::Base* render = skin->GetRender();
+        const Font& font = GetSkin()->GetDefaultFont();
+        const std::vector<unsigned int>& shown = m_dialog->m_shown;
+        const int rowHeight = GetRowHeight();
+        const int width = Width() - (m_scrollBar->Hidden() ? 0 : m_scrollBar->Width());
+        const int top = static_cast<int>(m_scrollTop);
+
+        for (size_t row = top / rowHeight; row < shown.size(); ++row)
+        {
+            const int y = static_cast<int>(row) * rowHeight - top;
+            if (y >= Height())
+                break;
+
+            const FileDialog::Entry& entry = m_dialog->m_entries[shown[row]];
+            const bool bSelected = static_cast<int>(shown[row]) == m_selected;
+
+            if (bSelected)
+            {
+                render->SetDrawColor(skin->Colors.Category.Line.Button_Selected);
+                render->DrawFilledRect(Rect(0, y, width, rowHeight));
+                render->SetDrawColor(skin->Colors.Label.Bright);
+            }
+            else
+            {
+                render->SetDrawColor(skin->Colors.Label.Dark);
+            }
+
+            render->RenderText(font, Point(4, y + 1),
+                               entry.isDirectory ? entry.name + "/" : entry.name);
+        }
+    }
+
+    void OnMouseClickLeft(int x, int y, bool bDown) override
+    {
+        if (!bDown)
+            return;
+
+        Focus();
+
+        const int row = GetRowAt(CanvasPosToLocal(Point(x, y)).y);
+        if (row < 0)
+            return;
+
+        SetSelected(m_dialog->m_shown[row]);
+        m_dialog->OnSelected(m_selected);
+    }
+
+    void OnMouseDoubleClickLeft(int x, int y) override
+    {
+        const int row = GetRowAt(CanvasPosToLocal(Point(x, y)).y);
+        if (row >= 0)
+            m_dialog->Activate(row);
+    }
+
+    bool OnMouseWheeled(int iDelta) override
+    {
+        if (m_scrollBar->Hidden())
+            return false;
+
+        m_scrollBar->SetScrolledAmount(m_scrollBar->GetScrolledAmount()
+                                       - m_scrollBar->GetNudgeAmount() * iDelta / 60.0f, true);
+        return true;
+    }
+
+    bool OnKeyUp(bool bDown) override
+    {
+        if (bDown)
+            MoveSelection(-1);
+
+        return true;
+    }
+
+    bool OnKeyDown(bool bDown) override
+    {
+        if (bDown)
+            MoveSelection(1);
+
+        return true;
+    }
+
+    bool OnKeyHome(bool bDown) override
+    {
+        if (bDown)
+            MoveSelection(-static_cast<int>(m_dialog->m_shown.size()));
+
+        return true;
+    }
+
+    bool OnKeyEnd(bool bDown) override
+    {
+        if (bDown)
+            MoveSelection(static_cast<int>(m_dialog->m_shown.size()));
+
+        return true;
+    }
+
+    bool OnKeyReturn(bool bDown) override
+    {
+        const int row = GetSelectedRow();
+        if (bDown && row >= 0)
+            m_dialog->Activate(row);
+
+        return true;
+    }
+
+    void RenderFocus(Skin::Base* /*skin*/) override
+    {
+    }
+
+private:
+
+    int GetRowHeight()
+    {
+        return std::max(1, GetSkin()->GetRender()->MeasureText(GetSkin()->GetDefaultFont(),
+                                                               "Wg").y + 2);
+    }
+
+    int GetRowAt(int y)
+    {
+        const int row = static_cast<int>(std::floor((y + m_scrollTop) / GetRowHeight()));
+        if (y < 0 || row >= static_cast<int>(m_dialog->m_shown.size()))
+            return -1;
+
+        return row;
+    }
+
+    void MoveSelection(int rows)
+    {
+        const int count = static_cast<int>(m_dialog->m_shown.size());
+        if (count == 0)
+            return;
+
+        const int current = GetSelectedRow();
+        const int row = current < 0 ? 0 : Clamp(current + rows, 0, count - 1);
+        SetSelected(m_dialog->m_shown[row]);
+        m_dialog->OnSelected(m_selected);
+
+        // Scroll the row into view.
+        const int rowHeight = GetRowHeight();
+        if (row * rowHeight < m_scrollTop)
+            ScrollTo(static_cast<float>(row * rowHeight));
+        else if ((row + 1) * rowHeight > m_scrollTop + Height())
+            ScrollTo(static_cast<float>((row + 1) * rowHeight - Height()));
+    }
+
+    void OnBarMoved(Event::Info)
+    {
+        Invalidate();
+    }
+
+    Controls::FileDialog* m_dialog;
+    Controls::VerticalScrollBar* m_scrollBar;
+    int m_selected;         // Index of the entry, so it stays as entries are added.
+    float m_scrollTop;      // Offset of the rows in view.
+    float m_contentHeight;  // Of all the rows, when last laid out.
+};
+
+} // namespace ControlsInternal
+} // namespace Gwk
+
+
+GWK_CONTROL_CONSTRUCTOR(FileDialog)
+{
+    m_mode = Mode::Open;
+    m_bListFailed = false;
+
+    SetSize(480, 360);
+    SetMinimumSize(Size(260, 200));
+    SetClosable(true);
+
+    Base* pathBar = new Base(this);
+    pathBar->Dock(Position::Top);
+    pathBar->SetHeight(20);
+    pathBar->SetMargin(Margin(0, 0, 0, 4));
+    {
+        Button* up = new Button(pathBar);
+        up->SetText("Up");
+        up->SetWidth(40);
+        up->Dock(Position::Left);
+        up->SetMargin(Margin(0, 0, 4, 0));
+        up->onPress.Add(this, &FileDialog::OnUp);
+
+        m_path = new TextBox(pathBar);
+        m_path->Dock(Position::Fill);
+        m_path->onReturnPressed.Add(this, &FileDialog::OnPathEntered);
+    }
+
+    m_status = new Label(this);
+    m_status->Dock(Position::Bottom);
+    m_status->SetHeight(16);
+    m_status->SetMargin(Margin(0, 2, 0, 0));
+
+    Base* typeBar = new Base(this);
+    typeBar->Dock(Position::Bottom);
+    typeBar->SetHeight(20);
+    typeBar->SetMargin(Margin(0, 4, 0, 0));
+    {
+        Button* cancel = new Button(typeBar);
+        cancel->SetText("Cancel");
+        cancel->SetWidth(70);
+        cancel->Dock(Position::Right);
+        cancel->SetMargin(Margin(4, 0, 0, 0));
+        cancel->onPress.Add(this, &FileDialog::OnCancel);
+
+        m_fileTypes = new ComboBox(typeBar);
+        m_fileTypes->Dock(Position::Fill);
+        m_fileTypes->onSelection.Add(this, &FileDialog::OnFileTypeChanged);
+    }
+
+    Base* nameBar = new Base(this);
+    nameBar->Dock(Position::Bottom);
+    nameBar->SetHeight(20);
+    nameBar->SetMargin(Margin(0, 4, 0, 0));
+    {
+        m_ok = new Button(nameBar);
+        m_ok->SetWidth(70);
+        m_ok->Dock(Position::Right);
+        m_ok->SetMargin(Margin(4, 0, 0, 0));
+        m_ok->onPress.Add(this, &FileDialog::OnOk);
+
+        m_name = new TextBox(nameBar);
+        m_name->Dock(Position::Fill);
+        m_name->onTextChanged.Add(this, &FileDialog::OnNameChanged);
+        m_name->onReturnPressed.Add(this, &FileDialog::OnOk);
+    }
+
+    m_list = new ControlsInternal::FileList(this);
+    m_list->SetDialog(this);
+    m_list->Dock(Position::Fill);
+
+    SetMode(Mode::Open);
+    SetFileTypes("Any Type|*.*");
+}
+
+FileDialog::~FileDialog()
+{
+    // Stop reading the folder. The listing outlives us until it stops.
+    if (m_listing)
+        m_listing->cancelled = true;
+}
+
+void FileDialog::SetMode(Mode mode)
+{
+    m_mode = mode;
+    m_ok->SetText(mode == Mode::Save ? "Save" : (mode == Mode::Folder ? "Choose" : "Open"));
+    m_fileTypes->GetParent()->SetHidden(mode == Mode::Folder);
+    m_name->GetParent()->SetHidden(mode == Mode::Folder);
+
+    m_nameFilter.clear();
+    Refilter(false);
+}
+
+void FileDialog::SetFileTypes(const String& fileTypes)
+{
+    m_fileTypes->ClearItems();
+
+    MenuItem* first = nullptr;
+    String description;
+    bool bDescription = true;
+    size_t start = 0;
+    while (start <= fileTypes.size())
+    {
+        size_t end = fileTypes.find('|', start);
+        if (end == String::npos)
+            end = fileTypes.size();
+
+        const String part = Trim(fileTypes.substr(start, end - start));
+        if (bDescription)
+        {
+            description = part;
+        }
+        else
+        {
+            MenuItem* item = m_fileTypes->AddItem(description, part);
+            if (!first)
+                first = item;
+        }
+
+        bDescription = !bDescription;
+        start = end + 1;
+    }
+
+    // Selecting a type applies its patterns.
+    if (first)
+        m_fileTypes->SelectItem(first);
+    else
+        OnFileTypeChanged(this);
+}
+
+void FileDialog::SetFolder(const String& folder)
+{
+    if (m_listing)
+        m_listing->cancelled = true;
+
+    m_folder = folder;
+    m_path->SetText(folder, false);
+    m_path->MoveCaretToEnd();
+
+    m_entries.clear();
+    m_sorted.clear();
+    m_shown.clear();
+    m_list->SetSelected(-1);
+    m_list->ScrollTo(0);
+    m_bListFailed = false;
+
+    std::shared_ptr<Listing> listing = std::make_shared<Listing>();
+    m_listing = listing;
+
+    Platform::RunInBackground([listing, folder]()
+    {
+        const bool bListed = Platform::ListDirectory(folder,
+            [&listing](std::vector<Platform::DirectoryEntry>&& batch)
+            {
+                if (listing->cancelled)
+                    return false;
+
+                std::lock_guard<std::mutex> lock(listing->mutex);
+                if (listing->pending.empty())
+                    listing->pending = std::move(batch);
+                else
+                    listing->pending.insert(listing->pending.end(),
+                                            std::make_move_iterator(batch.begin()),
+                                            std::make_move_iterator(batch.end()));
+                return true;
+            });
+
+        std::lock_guard<std::mutex> lock(listing->mutex);
+        listing->failed = !bListed;
+        listing->done = true;
+    });
+
+    UpdateStatus();
+}
+
+void FileDialog::SetFileName(const String& name)
+{
+    m_name->SetText(name);
+    m_name->MoveCaretToEnd();
+}
+
+void FileDialog::ShowModal(const String& folder)
+{
+    SetFolder(folder.empty() ? Platform::GetExecutableDir() : folder);
+    SetDeleteOnClose(true);
+    MakeModal(true);
+    SetPosition(Position::Center);
+    m_name->Focus();
+}
+
+void FileDialog::Think()
+{
+    ParentClass::Think();
+
+    if (!m_listing)
+        return;
+
+    // Entries are added a few thousand a frame, to keep the window responsive
+    // while a large folder is read.
+    std::vector<Platform::DirectoryEntry> batch;
+    bool bDone;
+    {
+        std::lock_guard<std::mutex> lock(m_listing->mutex);
+        std::vector<Platform::DirectoryEntry>& pending = m_listing->pending;
+        if (pending.size() <= c_MaxAddedPerFrame)
+        {
+            batch.swap(pending);
+        }
+        else
+        {
+            // They are sorted when added, so take them from the end.
+            auto from = pending.end() - c_MaxAddedPerFrame;
+            batch.assign(std::make_move_iterator(from), std::make_move_iterator(pending.end()));
+            pending.erase(from, pending.end());
+        }
+
+        bDone = m_listing->done && pending.empty();
+        m_bListFailed = m_listing->failed;
+    }
+
+    if (!batch.empty())
+        AddEntries(batch);
+
+    if (bDone)
+        m_listing.reset();
+
+    if (!batch.empty() || bDone)
+        UpdateStatus();
+
+    // Keep drawing frames until the whole folder has been read.
+    Redraw();
+}
+
+void FileDialog::AddEntries(std::vector<Platform::DirectoryEntry>& batch)
+{
+    const size_t sorted = m_sorted.size();
+    const size_t shown = m_shown.size();
+    m_entries.reserve(m_entries.size() + batch.size());
+
+    for (Platform::DirectoryEntry& added : batch)
+    {
+        Entry entry;
+        entry.key = ToLowerAscii(added.name);
+        entry.name = std::move(added.name);
+        entry.isDirectory = added.isDirectory;
+        m_entries.push_back(std::move(entry));
+        m_sorted.push_back(static_cast<unsigned int>(m_entries.size() - 1));
+    }
+
+    // Sort only what was added, then merge it with what was sorted already.
+    auto sortsBefore = [this](unsigned int a, unsigned int b) { return SortsBefore(a, b); };
+    std::sort(m_sorted.begin() + sorted, m_sorted.end(), sortsBefore);
+
+    for (auto it = m_sorted.begin() + sorted; it != m_sorted.end(); ++it)
+    {
+        if (PassesFilters(m_entries[*it]))
+            m_shown.push_back(*it);
+    }
+
+    std::inplace_merge(m_sorted.begin(), m_sorted.begin() + sorted, m_sorted.end(), sortsBefore);
+    std::inplace_merge(m_shown.begin(), m_shown.begin() + shown, m_shown.end(), sortsBefore);
+
+    m_list->Invalidate();
+    m_list->Redraw();
+}
+
+void FileDialog::Refilter(bool bNarrowed)
+{
+    // Filtering entries in order keeps them in order, so nothing is sorted.
+    if (bNarrowed)
+    {
+        // Only entries shown already can pass.
+        m_shown.erase(std::remove_if(m_shown.begin(), m_shown.end(),
+                                     [this](unsigned int i) { return !PassesFilters(m_entries[i]); }),
+                      m_shown.end());
+    }
+    else
+    {
+        m_shown.clear();
+        for (unsigned int i : m_sorted)
+        {
+            if (PassesFilters(m_entries[i]))
+                m_shown.push_back(i);
+        }
+    }
+
+    m_list->Invalidate();
+    m_list->Redraw();
+    UpdateStatus();
+}
+
+bool FileDialog::PassesFilters(const Entry& entry) const
+{
+    if (!entry.isDirectory)
+    {
+        if (m_mode == Mode::Folder)
+            return false;
+
+        if (!m_typePatterns.empty()
+            && std::none_of(m_typePatterns.begin(), m_typePatterns.end(),
+                            [&entry](const String& pattern)
+                            {
+                                return WildcardMatch(pattern, entry.key);
+                            }))
+        {
+            return false;
+        }
+    }
+
+    return m_nameFilter.empty() || entry.key.find(m_nameFilter) != String::npos;
+}
+
+bool FileDialog::SortsBefore(unsigned int a, unsigned int b) const
+{
+    const Entry& lhs = m_entries[a];
+    const Entry& rhs = m_entries[b];
+
+    if (lhs.isDirectory != rhs.isDirectory)
+        return lhs.isDirectory;
+
+    const int order = lhs.key.compare(rhs.key);
+    if (order != 0)
+        return order < 0;
+
+    return lhs.name < rhs.name;
+}
+
+void FileDialog::UpdateStatus()
+{
+    String status;
+    if (m_bListFailed)
+        status = "Could not read the folder";
+    else if (m_shown.size() != m_entries.size())
+        status = Utility::Format("%u of %u items", static_cast<unsigned int>(m_shown.size()),
+                                 static_cast<unsigned int>(m_entries.size()));
+    else
+        status = Utility::Format("%u items", static_cast<unsigned int>(m_entries.size()));
+
+    if (m_listing)
+        status += "...";
+
+    m_status->SetText(status);
+}
+
+void FileDialog::OnSelected(int entry)
+{
+    // Saving over a file starts from its name.
+    if (m_mode == Mode::Save && !m_entries[entry].isDirectory)
+        SetFileName(m_entries[entry].name);
+}
+
+void FileDialog::Activate(int row)
+{
+    const Entry& entry = m_entries[m_shown[row]];
+    const String path = JoinPath(m_folder, entry.name);
+
+    if (entry.isDirectory)
+    {
+        SetFolder(path);
+
+        if (m_mode == Mode::Open)
+            m_name->SetText("");
+    }
+    else
+    {
+        Choose(path);
+    }
+}
+
+void FileDialog::Choose(const String& path)
+{
+    Event::Info info(this);
+    info.String = path;
+    onFileChosen.Call(this, info);
+
+    CloseButtonPressed(this);
+}
+
+void FileDialog::OnUp(Event::Info)
+{
+    const String parent = ParentFolder(m_folder);
+    if (parent != m_folder)
+        SetFolder(parent);
+}
+
+void FileDialog::OnPathEntered(Event::Info)
+{
+    SetFolder(m_path->GetText());
+}
+
+void FileDialog::OnNameChanged(Event::Info)
+{
+    // Only opening filters by name. Saving types a new one.
+    if (m_mode != Mode::Open)
+        return;
+
+    const String filter = ToLowerAscii(m_name->GetText());
+    if (filter == m_nameFilter)
+        return;
+
+    // Entries that contain the new text also contain the old.
+    const bool bNarrowed = filter.find(m_nameFilter) != String::npos;
+    m_nameFilter = filter;
+    Refilter(bNarrowed);
+}
+
+void FileDialog::OnFileTypeChanged(Event::Info)
+{
+    m_typePatterns.clear();
+
+    if (Controls::Label* item = m_fileTypes->GetSelectedItem())
+    {
+        const String patterns = ToLowerAscii(item->GetName());
+        size_t start = 0;
+        while (start <= patterns.size())
+        {
+            size_t end = patterns.find(';', start);
+            if (end == String::npos)
+                end = patterns.size();
+
+            const String pattern = Trim(patterns.substr(start, end - start));
+            if (pattern == "*" || pattern == "*.*")
+            {
+                // Any file, including those without an extension.
+                m_typePatterns.clear();
+                break;
+            }
+
+            if (!pattern.empty())
+                m_typePatterns.push_back(pattern);
+
+            start = end + 1;
+        }
+    }
+
+    Refilter(false);
+}
+
+void FileDialog::OnOk(Event::Info)
+{
+    const int row = m_list->GetSelectedRow();
+
+    if (m_mode == Mode::Folder)
+    {
+        Choose(row >= 0 ? JoinPath(m_folder, m_entries[m_shown[row]].name) : m_folder);
+        return;
+    }
+
+    const String name = m_name->GetText();
+
+    if (m_mode == Mode::Open)
+    {
+        if (row >= 0)
+        {
+            Activate(row);
+        }
+        else if (m_shown.size() == 1)
+        {
+            // The name typed picks out a single entry.
+            Activate(0);
+        }
+        return;
+    }
+
+    // Saving.
+    if (name.empty())
+    {
+        if (row >= 0 && m_entries[m_shown[row]].isDirectory)
+            Activate(row);
+        return;
+    }
+
+    for (const Entry& entry : m_entries)
+    {
+        if (entry.isDirectory && entry.name == name)
+        {
+            SetFolder(JoinPath(m_folder, name));
+            m_name->SetText("");
+            return;
+        }
+    }
+
+    // Add the extension of the file type chosen if none was typed.
+    String fileName = name;
+    if (fileName.find('.') == String::npos && !m_typePatterns.empty()
+        && m_typePatterns.front().compare(0, 2, "*.") == 0
+        && m_typePatterns.front().find_first_of("*?", 2) == String::npos)
+    {
+        fileName += m_typePatterns.front().substr(1);
+    }
+
+    Choose(JoinPath(m_folder, fileName));
+}
+
+void FileDialog::OnCancel(Event::Info)
+{
+    CloseButtonPressed(this);
+}
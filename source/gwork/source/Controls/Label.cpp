@@ -105,9 +105,9 @@ void Label::SetFont(Gwk::String strFacename, int iSize, bool bBold)
 
     m_createdFont = new Gwk::Font();
     GWK_ASSERT_MSG(m_createdFont != nullptr, "Couldn't Create Font!");
-    m_createdFont->bold = bBold;
-    m_createdFont->facename = strFacename;
-    m_createdFont->size = iSize;
+    m_createdFont->SetBold(bBold);
+    m_createdFont->SetFacename(strFacename);
+    m_createdFont->SetSize(iSize);
     SetFont(*m_createdFont);
     m_text->RefreshSize();
 }
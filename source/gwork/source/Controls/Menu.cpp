@@ -24,6 +24,8 @@ GWK_CONTROL_CONSTRUCTOR(Menu)
     SetAutoHideBars(true);
     SetScroll(false, true);
     SetDeleteOnClose(false);
+    m_bItemsBuilt = false;
+    m_bClearWhenClosed = false;
 }
 
 
@@ -97,6 +99,11 @@ void Menu::ClearItems()
         if (!child)
             continue;
 
+        // Submenus belong to the canvas, so are deleted with their items.
+        MenuItem* item = gwk_cast<MenuItem>(child);
+        if (item)
+            item->DeleteMenu();
+
         child->DelayedDelete();
     }
 }
@@ -147,8 +154,29 @@ void Menu::OnHoverItem(Event::Info info)
     item->OpenMenu();
 }
 
+void Menu::SetItemBuilder(ItemBuilder builder, bool clearWhenClosed)
+{
+    m_itemBuilder = builder;
+    m_bItemsBuilt = false;
+    m_bClearWhenClosed = clearWhenClosed;
+
+    if (!Hidden())
+        BuildItems();
+}
+
+void Menu::BuildItems()
+{
+    if (!m_itemBuilder || m_bItemsBuilt)
+        return;
+
+    m_bItemsBuilt = true;
+    m_itemBuilder(this);
+    Invalidate();
+}
+
 void Menu::Open(Position pos)
 {
+    BuildItems();
     SetHidden(false);
     BringToFront();
     Gwk::Point MousePos = Input::GetMousePosition();
@@ -159,6 +187,13 @@ void Menu::Close()
 {
     SetHidden(true);
 
+    if (m_bItemsBuilt && m_bClearWhenClosed)
+    {
+        CloseAll();
+        ClearItems();
+        m_bItemsBuilt = false;
+    }
+
     if (DeleteOnClose())
         DelayedDelete();
 }
@@ -34,6 +34,7 @@ public:
 GWK_CONTROL_CONSTRUCTOR(MenuItem)
 {
     m_menu = nullptr;
+    m_bClearMenuWhenClosed = false;
     m_bOnStrip = false;
     m_submenuArrow = nullptr;
     m_accelerator = nullptr;
@@ -70,18 +71,54 @@ Menu* MenuItem::GetMenu()
         m_menu = new Menu(GetCanvas());
         m_menu->SetHidden(true);
 
-        if (!m_bOnStrip)
+        if (m_menuBuilder)
         {
-            m_submenuArrow = new RightArrow(this);
-            m_submenuArrow->SetSize(15, 15);
+            m_menu->SetItemBuilder(m_menuBuilder, m_bClearMenuWhenClosed);
+            m_menuBuilder = nullptr;
         }
 
-        Invalidate();
+        AddSubmenuArrow();
     }
 
     return m_menu;
 }
 
+void MenuItem::SetMenuBuilder(MenuBuilder builder, bool clearWhenClosed)
+{
+    if (m_menu)
+    {
+        m_menu->SetItemBuilder(builder, clearWhenClosed);
+        return;
+    }
+
+    m_menuBuilder = builder;
+    m_bClearMenuWhenClosed = clearWhenClosed;
+    AddSubmenuArrow();
+}
+
+void MenuItem::DeleteMenu()
+{
+    if (!m_menu)
+        return;
+
+    // Clearing the items also deletes their submenus, which belong to the
+    // canvas. The items are queued first, so are deleted before the menu.
+    m_menu->ClearItems();
+    m_menu->DelayedDelete();
+    m_menu = nullptr;
+}
+
+void MenuItem::AddSubmenuArrow()
+{
+    if (!m_bOnStrip && !m_submenuArrow)
+    {
+        m_submenuArrow = new RightArrow(this);
+        m_submenuArrow->SetSize(15, 15);
+    }
+
+    Invalidate();
+}
+
 void MenuItem::SetChecked(bool bCheck)
 {
     if (bCheck == m_bChecked)
@@ -98,7 +135,7 @@ void MenuItem::SetChecked(bool bCheck)
 
 void MenuItem::OnPress(Event::Info info)
 {
-    if (m_menu)
+    if (m_menu || m_menuBuilder)
     {
         ToggleMenu();
     }
@@ -130,9 +167,10 @@ bool MenuItem::IsMenuOpen()
 
 void MenuItem::OpenMenu()
 {
-    if (!m_menu)
+    if (!m_menu && !m_menuBuilder)
         return;
 
+    GetMenu()->BuildItems();
     m_menu->SetHidden(false);
     m_menu->BringToFront();
     Gwk::Point p = LocalPosToCanvas(Gwk::Point(0, 0));
@@ -8,8 +8,8 @@
 
 #include <Gwork/Gwork.h>
 #include <Gwork/Controls/RichLabel.h>
-#include <Gwork/Controls/Label.h>
 #include <Gwork/Utility.h>
+#include <algorithm>
 
 using namespace Gwk;
 using namespace Gwk::Controls;
@@ -19,6 +19,7 @@ const unsigned char Type_Newline = 1;
 
 GWK_CONTROL_CONSTRUCTOR(RichLabel)
 {
+    m_fragmentHeight = 0;
     m_bNeedsRebuild = false;
 }
 
@@ -59,6 +60,14 @@ bool RichLabel::SizeToChildren(bool w, bool h)
     return ParentClass::SizeToChildren(w, h);
 }
 
+Gwk::Point RichLabel::ChildrenSize()
+{
+    Gwk::Point size = ParentClass::ChildrenSize();
+    size.x = std::max(size.x, m_contentSize.x);
+    size.y = std::max(size.y, m_contentSize.y);
+    return size;
+}
+
 void RichLabel::SplitLabel(const Gwk::String& text, const Gwk::Font& font,
                            const DividedText& txt, int& x, int& y, int& lineheight)
 {
@@ -143,15 +152,24 @@ void RichLabel::CreateLabel(const Gwk::String& text, const DividedText& txt, int
     if (x+p.x >= Width())
         CreateNewline(x, y, lineheight);
 
-    Gwk::Controls::Label*  label = new Gwk::Controls::Label(this);
-    label->SetText(x == 0 ? Gwk::Utility::Strings::TrimLeft<Gwk::String>(text,
-                                                                                   " ") : text);
-    label->SetTextColor(txt.color);
-    label->SetFont(*font);
-    label->SizeToContents();
-    label->SetPos(x, y);
-    // lineheight = (lineheight + label->Height()) / 2;
-    x += label->Width();
+    Fragment fragment;
+    fragment.text = x == 0 ? Gwk::Utility::Strings::TrimLeft<Gwk::String>(text, " ") : text;
+    fragment.color = txt.color;
+    fragment.font = font;
+
+    // Same size as a Label would be
+    Gwk::Point size(1, font->GetSize());
+    if (!fragment.text.empty())
+        size = GetSkin()->GetRender()->MeasureText(*font, fragment.text);
+    size.y = std::max(size.y, int(font->GetSize()));
+
+    fragment.bounds = Gwk::Rect(x, y, size.x, size.y);
+    m_contentSize.x = std::max(m_contentSize.x, fragment.bounds.Right());
+    m_contentSize.y = std::max(m_contentSize.y, fragment.bounds.Bottom());
+    m_fragmentHeight = std::max(m_fragmentHeight, size.y);
+    m_fragments.push_back(fragment);
+
+    x += size.x;
 
     if (x >= Width())
         CreateNewline(x, y, lineheight);
@@ -165,7 +183,9 @@ void RichLabel::CreateNewline(int& x, int& y, int& lineheight)
 
 void RichLabel::Rebuild()
 {
-    RemoveAllChildren();
+    m_fragments.clear();
+    m_contentSize = Gwk::Point();
+    m_fragmentHeight = 0;
     int x = 0;
     int y = 0;
     int lineheight = -1;
@@ -186,6 +206,7 @@ void RichLabel::Rebuild()
     }
 
     m_bNeedsRebuild = false;
+    Redraw();
 }
 
 void RichLabel::OnBoundsChanged(Gwk::Rect oldBounds)
@@ -201,3 +222,58 @@ void RichLabel::Layout(Gwk::Skin::Base* skin)
     if (m_bNeedsRebuild)
         Rebuild();
 }
+
+void RichLabel::CalculateSize(Gwk::Skin::Base* skin, Dim dim)
+{
+    if (m_bNeedsRebuild)
+        Rebuild();
+
+    ParentClass::CalculateSize(skin, dim);
+
+    // The text is not made of child controls, so add it here.
+    if (dim == Dim::X)
+    {
+        if (m_sizeFlags.horizontal != SizeFlag::Fixed)
+        {
+            m_preferredSize.width = std::max(m_preferredSize.width,
+                m_contentSize.x + m_padding.left + m_padding.right);
+        }
+    }
+    else if (m_sizeFlags.vertical != SizeFlag::Fixed)
+    {
+        m_preferredSize.height = std::max(m_preferredSize.height,
+            m_contentSize.y + m_padding.top + m_padding.bottom);
+    }
+}
+
+void RichLabel::Render(Gwk::Skin::Base* skin)
+{
+    Gwk::Renderer::Base* render = skin->GetRender();
+
+    // Only draw the lines that are inside the clip region.
+    Gwk::Rect clip = render->ClipRegion();
+    clip.x -= render->GetRenderOffset().x;
+    clip.y -= render->GetRenderOffset().y;
+
+    // Fragments are in line order, so skip to the first visible line.
+    auto it = std::lower_bound(m_fragments.begin(), m_fragments.end(),
+                               clip.y - m_fragmentHeight,
+                               [](const Fragment& fragment, int top)
+                               {
+                                   return fragment.bounds.y < top;
+                               });
+
+    for (; it != m_fragments.end() && it->bounds.y < clip.Bottom(); ++it)
+    {
+        const Fragment& fragment = *it;
+        if (fragment.text.empty()
+            || fragment.bounds.Right() <= clip.x || fragment.bounds.x >= clip.Right())
+        {
+            continue;
+        }
+
+        render->SetDrawColor(fragment.color);
+        render->RenderText(*fragment.font, Gwk::Point(fragment.bounds.x, fragment.bounds.y),
+                           fragment.text);
+    }
+}
@@ -21,6 +21,8 @@ GWK_CONTROL_CONSTRUCTOR(TabButton)
 {
     m_page = nullptr;
     m_control = nullptr;
+    m_bPageBuilt = false;
+    m_bDestroyPageWhenHidden = false;
     DragAndDrop_SetPackage(true, "TabButtonMove");
     SetAlignment(Position::Top|Position::Left);
     SetTextPadding(Padding(2, 2, 2, 2));
@@ -56,6 +58,42 @@ void TabButton::SetTabControl(TabControl* ctrl)
     m_control = ctrl;
 }
 
+void TabButton::SetPageBuilder(PageBuilder builder, bool destroyWhenHidden)
+{
+    m_pageBuilder = builder;
+    m_bPageBuilt = false;
+    m_bDestroyPageWhenHidden = destroyWhenHidden;
+
+    // Already the current page?
+    if (m_page && !m_page->Hidden())
+        BuildPage();
+}
+
+void TabButton::BuildPage()
+{
+    if (!m_page || !m_pageBuilder || m_bPageBuilt)
+        return;
+
+    m_bPageBuilt = true;
+    m_pageBuilder(m_page);
+    m_page->Invalidate();
+}
+
+void TabButton::ReleasePage()
+{
+    if (!m_page || !m_bPageBuilt || !m_bDestroyPageWhenHidden)
+        return;
+
+    // Deleted later, as the tab may have been switched by a control on the page.
+    for (auto&& child : m_page->Children)
+    {
+        child->SetHidden(true);
+        child->DelayedDelete();
+    }
+
+    m_bPageBuilt = false;
+}
+
 bool TabButton::DragAndDrop_ShouldStartDrag()
 {
     return m_control->DoesAllowDrag();
@@ -143,11 +143,13 @@ void TabControl::OnTabPressed(Event::Info info)
         if (subpage)
             subpage->SetHidden(true);
 
+        m_currentButton->ReleasePage();
         m_currentButton->Redraw();
         m_currentButton = nullptr;
     }
 
     m_currentButton = button;
+    button->BuildPage();
     page->SetHidden(false);
     m_tabStrip->Invalidate();
     Invalidate();
@@ -232,7 +232,7 @@ Size Text::RefreshSize(bool update)
         return Size(0, 0);
     }
 
-    Gwk::Point p(1, GetFont().size);
+    Gwk::Point p(1, GetFont().GetSize());
 
     if (Length() > 0)
         p = GetSkin()->GetRender()->MeasureText(GetFont(), m_string);
@@ -243,8 +243,8 @@ Size Text::RefreshSize(bool update)
     if (p.x == Width() && p.y == Height())
         return Size(p.x, p.y);
 
-    if (p.y < GetFont().size)
-        p.y = GetFont().size;
+    if (p.y < GetFont().GetSize())
+        p.y = GetFont().GetSize();
 
     if(update)
     {
@@ -412,7 +412,7 @@ void TextBox::MakeCaretVisible()
     {
         int iCaretPos = m_text->GetCharacterPosition(m_cursorPos).x;
         int iRealCaretPos = iCaretPos+m_text->X();
-        int iSlidingZone = m_text->GetFont().size + 1;   // Width()*0.1f
+        int iSlidingZone = m_text->GetFont().GetSize() + 1;   // Width()*0.1f
 
         // If the carat is already in a semi-good position, leave it.
         if (iRealCaretPos >= iSlidingZone && iRealCaretPos <= Width()-iSlidingZone)
@@ -528,7 +528,7 @@ void TextBoxMultiline::Render(Skin::Base* skin)
         int iSelectionEndPos =    (m_cursorPos < m_cursorEnd) ? m_cursorEnd : m_cursorPos;
 
         skin->GetRender()->SetDrawColor(Gwk::Color(50, 170, 255, 200));
-        m_rectSelectionBounds.h = m_text->GetFont().size + 2;
+        m_rectSelectionBounds.h = m_text->GetFont().GetSize() + 2;
 
         for (int iLine = iSelectionStartLine; iLine <= iSelectionEndLine; ++iLine)
         {
@@ -593,7 +593,7 @@ void TextBoxMultiline::MakeCaretVisible()
         Rect pos = m_text->GetCharacterPosition(m_cursorPos);
         int iCaretPos = pos.y; // + pos.h;
         int iRealCaretPos = iCaretPos+m_text->Y();
-        //int iSlidingZone =  m_text->GetFont()->size; //Width()*0.1f
+        //int iSlidingZone =  m_text->GetFont()->GetSize(); //Width()*0.1f
 
         // If the carat is already in a semi-good position, leave it.
 //        int mi = GetPadding().top;
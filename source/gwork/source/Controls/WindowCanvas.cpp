@@ -147,6 +147,7 @@ void WindowCanvas::RenderCanvas()
 
     if (render->BeginContext(this))
     {
+        render->FinishTextureLoads();
         render->Begin();
         RecurseLayout(m_skin);
         render->SetClipRegion(GetRenderBounds());
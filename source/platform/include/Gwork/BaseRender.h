@@ -10,6 +10,7 @@
 #define GWK_BASERENDER_H
 
 #include <Gwork/PlatformTypes.h>
+#include <vector>
 
 namespace Gwk
 {
@@ -36,6 +37,29 @@ namespace Gwk
             virtual void CreateControlCacheTexture(CacheHandle control, const Point& size) = 0;
             virtual void UpdateControlCacheTexture(CacheHandle control) = 0;
             virtual void SetRenderer(Gwk::Renderer::Base* renderer) = 0;
+
+            //! Check the control's texture still holds what was last rendered to
+            //! it. Caches that free textures to save memory return false, so that
+            //! the control is rendered again.
+            virtual bool IsCacheTextureValid(CacheHandle control) { return true; }
+        };
+
+        //
+        //! \brief A texture split into a 3x3 grid, for drawing resizable borders.
+        //!
+        //! The corners are drawn unscaled, the edges are stretched along their
+        //! length and the middle is stretched to fill. The areas are numbered:
+        //!
+        //!  | :-: | :-: | :-: |
+        //!  |  0  |  1  |  2  |
+        //!  |  3  |  4  |  5  |
+        //!  |  6  |  7  |  8  |
+        //
+        struct NinePatch
+        {
+            float u[4];     //!< Texture coordinates of the grid columns, left to right.
+            float v[4];     //!< Texture coordinates of the grid rows, top to bottom.
+            int left, top, right, bottom;   //!< Size of the borders when drawn.
         };
 
         //
@@ -84,6 +108,9 @@ namespace Gwk
 
             virtual void DrawMissingImage(Gwk::Rect targetRect);
 
+            //! Draw in place of an image that is still being loaded.
+            virtual void DrawLoadingImage(Gwk::Rect targetRect);
+
             virtual Gwk::Color PixelColor(const Gwk::Texture& texture,
                                           unsigned int x, unsigned int y,
                                           const Gwk::Color& col_default = Gwk::Colors::White)
@@ -110,6 +137,29 @@ namespace Gwk
             virtual void DrawLinedRect(Gwk::Rect rect);
             virtual void DrawPixel(int x, int y);
             virtual void DrawShavedCornerRect(Gwk::Rect rect, bool bSlight = false);
+
+            //! Draw a rectangle filled with a linear gradient. The first and
+            //! last rows or columns are the start and end colors. May change
+            //! the draw color.
+            //! \param vertical : Top to bottom if true, otherwise left to right.
+            virtual void DrawLinearGradientRect(Gwk::Rect rect, Gwk::Color start, Gwk::Color end,
+                                                bool vertical = false);
+
+            //! Draw a rectangle filled by interpolating between the colors of
+            //! its corner pixels. May change the draw color.
+            virtual void DrawBilinearGradientRect(Gwk::Rect rect,
+                                                  Gwk::Color topLeft, Gwk::Color topRight,
+                                                  Gwk::Color bottomLeft, Gwk::Color bottomRight);
+
+            //! Draw a nine-patch texture, stretched to fill a rectangle.
+            //! \param texture : Texture to draw.
+            //! \param targetRect : Outer edge of the drawing.
+            //! \param grid : Where the texture is split, and the border sizes.
+            //! \param color : Draw color.
+            //! \param draw : Bitfield of the areas to draw.
+            virtual void DrawNinePatch(const Gwk::Texture& texture, Gwk::Rect targetRect,
+                                       const NinePatch& grid, Gwk::Color color,
+                                       unsigned int draw = ~0u);
             //! \}
 
             //! \sect{Translate}
@@ -173,11 +223,74 @@ namespace Gwk
                 return false;
             }
 
+            //
+            // Background texture loading
+            //
+
+            //! Decodes the image in the background. The texture is made at the
+            //! next FinishTextureLoads().
+            Texture::Status LoadTextureAsync(const Gwk::Texture& texture, const void* owner,
+                                             const TextureLoadedCallback& onLoaded) override;
+            void CancelTextureLoad(const Gwk::Texture& texture, const void* owner) override;
+
+            //! Check if textures loaded in the background are waiting for
+            //! FinishTextureLoads(). Can be used to wake up a sleeping UI.
+            bool TextureLoadsReady() const;
+
+            //! Make the textures decoded in the background, and call their
+            //! callbacks. The canvas calls this on the render thread before
+            //! each frame, so GPU uploads happen before Begin().
+            void FinishTextureLoads();
+
+            //
+            // Preloading
+            //
+
+            //! \brief Load fonts and textures before they are first used, such
+            //! as at startup.
+            //!
+            //! Images are decoded and glyphs rasterized in parallel, by the
+            //! JobSystem. The fonts and textures are then made on this thread,
+            //! which must be the render thread. Returns once all are loaded.
+            //! Ones already loaded are skipped.
+            void Preload(const std::vector<Gwk::Font>& fonts,
+                         const std::vector<Gwk::Texture>& textures);
+
         protected:
 
             virtual bool EnsureFont(const Gwk::Font& font) { return false; }
             virtual bool EnsureTexture(const Gwk::Texture& texture) { return false; }
 
+            //! Makes a texture from data decoded in the background. Run on the
+            //! render thread.
+            typedef std::function<Texture::Status()> TextureFinisher;
+
+            //! Decodes a texture. Run on a background thread, so it must not
+            //! use the renderer.
+            typedef std::function<TextureFinisher()> TextureDecoder;
+
+            //! \brief Get how to load a texture in the background, for
+            //! LoadTextureAsync(). Called on the render thread.
+            //!
+            //! By default nothing is decoded in the background, and the texture
+            //! is loaded with LoadTexture() when the load is finished.
+            virtual TextureDecoder GetTextureDecoder(const Gwk::Texture& texture);
+
+            //! Makes a font from glyphs rasterized ahead. Run on the render thread.
+            typedef std::function<void()> FontFinisher;
+
+            //! Rasterizes the glyphs of a font. Run on a job thread, so it must
+            //! not use the renderer.
+            typedef std::function<FontFinisher()> FontBaker;
+
+            //! \brief Get how to rasterize a font in parallel, for Preload().
+            //! Called on the render thread.
+            //!
+            //! By default nothing is rasterized ahead, and the font is loaded
+            //! with EnsureFont() when it is finished. Return an empty function
+            //! for a font already loaded, and Preload() skips it.
+            virtual FontBaker GetFontBaker(const Gwk::Font& font);
+
             float m_fScale;
 
         private:
@@ -186,6 +299,10 @@ namespace Gwk
             Gwk::Point m_renderOffset;
             Gwk::Rect m_rectClipRegion;
             ICacheToTexture* m_RTT;
+
+            // Shared with the background threads, which may outlive the renderer.
+            struct TextureLoads;
+            std::shared_ptr<TextureLoads> m_textureLoads;
         };
 
     }
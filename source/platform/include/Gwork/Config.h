@@ -76,4 +76,24 @@
 #   define GWK_IF_ALLOC_STATS(SRC) // ignore
 #endif // GWK_ALLOC_STATS
 
+// SIMD code paths. These are selected at runtime, depending on the CPU, so
+// the build does not need any special compiler flags. Define GWK_SIMD=0 to
+// only build the scalar code.
+#ifndef GWK_SIMD
+#   if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#       define GWK_SIMD 1
+#   else
+#       define GWK_SIMD 0
+#   endif
+#endif
+
+// Allow functions to use instructions beyond the compiler's target architecture.
+#if GWK_SIMD && (defined(__GNUC__) || defined(__clang__))
+#   define GWK_TARGET_SSE2 __attribute__((target("sse2")))
+#   define GWK_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#   define GWK_TARGET_SSE2
+#   define GWK_TARGET_AVX2
+#endif
+
 #endif // GWK_CONFIG_H
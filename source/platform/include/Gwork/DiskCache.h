@@ -0,0 +1,106 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_DISKCACHE_H
+#define GWK_DISKCACHE_H
+
+#include <Gwork/PlatformTypes.h>
+#include <Gwork/PlatformCommon.h>
+#include <functional>
+#include <memory>
+
+namespace Gwk
+{
+    namespace Renderer
+    {
+        //
+        //! \brief Decoded resources saved to disk, so that they are not decoded
+        //! again when the program next starts.
+        //!
+        //! Off until SetDirectory() is called. Each entry is data made from a
+        //! source file, such as an image decoded to RGBA, and is named by the
+        //! source path and a variant saying how it was made. An entry is only
+        //! used while its source is unchanged: the source's size and
+        //! modification time are checked, and if they differ its contents
+        //! are hashed. Entries are memory-mapped when found. All functions
+        //! are safe to call from any thread.
+        //
+        class GWK_EXPORT DiskCache
+        {
+        public:
+
+            //! Version of the file format. Entries saved by other versions are
+            //! ignored, and replaced when saved again.
+            static const unsigned int FormatVersion = 1;
+
+            //! Data found in the cache, mapped read-only.
+            class Entry
+            {
+            public:
+                explicit operator bool() const { return m_data != nullptr; }
+
+                const unsigned char* Data() const { return m_data; }
+                size_t Size() const { return m_size; }
+
+            private:
+                friend class DiskCache;
+
+                std::shared_ptr<const Platform::MappedFile> m_file;
+                const unsigned char* m_data = nullptr;
+                size_t m_size = 0;
+            };
+
+            //! Set the directory entries are saved in. It must already exist.
+            //! An empty path turns the cache off.
+            static void SetDirectory(const String& directory);
+            static bool IsEnabled();
+
+            //! Find the data made from a file.
+            //! \param source : Path of the file the data was made from.
+            //! \param variant : How the data was made, e.g. "rgba8".
+            //! \return The data, or an empty entry if there is none for the
+            //!         current contents of the source.
+            static Entry Find(const String& source, const String& variant);
+
+            //! Save the data made from a file, replacing any saved before.
+            //! \return False if the cache is off or the data was not saved.
+            static bool Store(const String& source, const String& variant,
+                              const void* data, size_t size);
+
+            //! Find an RGBA image decoded from a file. The entry is the pixels.
+            static Entry FindImage(const String& source, const String& variant,
+                                   int& width, int& height);
+
+            //! Save an RGBA image decoded from a file.
+            static bool StoreImage(const String& source, const String& variant,
+                                   int width, int height, const unsigned char* pixels);
+
+            //! RGBA pixels, freed by their deleter. Mapped from the cache, they
+            //! are read-only.
+            typedef std::unique_ptr<const unsigned char,
+                                    std::function<void(const unsigned char*)>> ImagePixels;
+
+            //! Called on newly decoded RGBA pixels, before they are saved.
+            typedef std::function<void(unsigned char* pixels, int width, int height)> ImagePrepare;
+
+            //! Decode an image file to RGBA, or map the pixels decoded by an
+            //! earlier run. Logs an error if the file cannot be decoded. Works
+            //! with the cache off too, so renderers always load images with it.
+            //! \param filename : Path of the image file.
+            //! \param variant : How the pixels are made, e.g. "rgba8".
+            //! \param prepare : Optional change to the decoded pixels, e.g. to
+            //!                  premultiply them, which \p variant must name.
+            //! \return The pixels, or null if the file could not be decoded.
+            static ImagePixels DecodeImage(const String& filename, const String& variant,
+                                           int& width, int& height,
+                                           const ImagePrepare& prepare = ImagePrepare());
+        };
+
+    }
+}
+
+#endif // ifndef GWK_DISKCACHE_H
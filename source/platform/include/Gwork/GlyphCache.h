@@ -0,0 +1,265 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_GLYPHCACHE_H
+#define GWK_GLYPHCACHE_H
+
+#include <Gwork/PlatformTypes.h>
+#include <Gwork/PlatformCommon.h>
+#include <Gwork/DiskCache.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct stbtt_fontinfo;
+
+namespace Gwk
+{
+    namespace Renderer
+    {
+        //
+        //! \brief A TrueType font file, parsed by stb_truetype.
+        //!
+        //! Faces are memory-mapped and shared: loading the same path again, for
+        //! another size or renderer, returns the face already loaded. Faces stay
+        //! cached when unused, so reloading fonts after a scale change does not
+        //! touch the disk, until ReleaseUnused() is called.
+        //
+        class GWK_EXPORT FontFace
+        {
+        public:
+            //! Get a font file, loading it if it is not already loaded.
+            //! \param filename : Path of the font file.
+            //! \param status : Set to the result of the load.
+            //! \return The face, or null if it could not be loaded.
+            static std::shared_ptr<FontFace> Load(const String& filename, Font::Status& status);
+
+            //! Unload the cached faces that are not used by any font.
+            static void ReleaseUnused();
+
+            ~FontFace();
+
+            const stbtt_fontinfo& Info() const { return *m_info; }
+
+            //! Path of the font file.
+            const String& Filename() const { return m_filename; }
+
+            //! Scale from font units to pixels, for glyphs \p pixelHeight high.
+            float ScaleForPixelHeight(float pixelHeight) const;
+
+        private:
+            FontFace();
+
+            String m_filename;
+            std::shared_ptr<const Platform::MappedFile> m_file;
+            std::unique_ptr<stbtt_fontinfo> m_info;
+        };
+
+        //
+        //! \brief Rasterizes glyphs on demand into shared atlas pages.
+        //!
+        //! Glyphs are rasterized the first time they are asked for and packed
+        //! into rows ("shelves") of 8-bit coverage pages. When the memory limit
+        //! is reached, the least recently used page is emptied and reused.
+        //! Renderers draw straight from the page pixels, or upload the pages to
+        //! textures.
+        //!
+        //! When the DiskCache is on, the glyphs of each font file and size are
+        //! saved, and copied from the cache rather than rasterized next time.
+        //
+        class GWK_EXPORT GlyphCache
+        {
+        public:
+
+            typedef unsigned int FontId;
+
+            struct Glyph
+            {
+                int page;           //!< Atlas page, or -1 if the glyph has no pixels.
+                Rect rect;          //!< Position of the glyph in the page.
+                Point offset;       //!< Offset of the top-left of the glyph from the pen.
+                float advance;      //!< Horizontal pen advance.
+            };
+
+            struct Page
+            {
+                Point size;
+                std::vector<unsigned char> pixels;  //!< Coverage, one byte per pixel.
+                Rect dirty;         //!< Area changed since the last MarkUploaded().
+            };
+
+            //! How glyphs of a font are stored in the pages.
+            enum class Format
+            {
+                Coverage,       //!< Antialiased coverage, for drawing at the font size.
+                DistanceField   //!< Signed distance field, for drawing at any scale.
+            };
+
+            //! Distance field pixels outside the glyph outline.
+            static const int SdfPadding = 4;
+            //! Distance field value on the glyph outline. Higher is inside.
+            static const unsigned char SdfOnEdge = 128;
+            //! Distance field value change per pixel of distance.
+            static constexpr float SdfPixelDistScale = float(SdfOnEdge) / SdfPadding;
+
+            static const size_t DefaultMemoryLimit = 4 * 1024 * 1024;
+
+            explicit GlyphCache(Point pageSize = Point(512, 512),
+                                size_t memoryLimit = DefaultMemoryLimit);
+            ~GlyphCache();
+
+            //! \brief Add a font at a given size.
+            //!
+            //! Adding a face at a size and format already added returns the
+            //! same font, with the glyphs already rasterized. It is removed
+            //! when removed as many times as it was added.
+            //! \param face : The font face, shared with the caller.
+            //! \param pixelHeight : Height of the glyphs, in pixels.
+            //! \param format : How the glyphs are rasterized.
+            //! \return Identifier used to get the glyphs of the font. Never 0.
+            FontId AddFont(std::shared_ptr<const FontFace> face, float pixelHeight,
+                           Format format = Format::Coverage);
+
+            //! Remove a font and forget its glyphs, once it has been removed as
+            //! often as added. New glyphs are saved first.
+            void RemoveFont(FontId font);
+
+            //! Save the glyphs rasterized since the fonts were added to the
+            //! DiskCache, if it is on. Also done when the cache is destroyed.
+            void SaveGlyphs();
+
+            //! Glyphs rasterized ahead of use, by RasterizeGlyphs().
+            struct RasterizedGlyphs
+            {
+                std::shared_ptr<const FontFace> face;
+                float pixelHeight;
+                Format format;
+                std::vector<unsigned char> glyphs;  //!< As saved in the disk cache.
+            };
+
+            //! \brief Rasterize glyphs without adding them to a cache, e.g. to
+            //! load fonts in parallel. Safe to call from any thread.
+            //! \param first, last : Range of codepoints. Printable ASCII by default.
+            static RasterizedGlyphs RasterizeGlyphs(std::shared_ptr<const FontFace> face,
+                                                    float pixelHeight, Format format,
+                                                    char32_t first = 0x20, char32_t last = 0x7e);
+
+            //! \brief Add glyphs rasterized by RasterizeGlyphs() to a font. They
+            //! are copied into the pages when first asked for.
+            //! \return False if they were rasterized for another face, size or
+            //!         format, and were not added.
+            bool AddRasterizedGlyphs(FontId font, const RasterizedGlyphs& glyphs);
+
+            //! Get a glyph, rasterizing it if it is not in the cache.
+            //! \return The glyph, or null if the font is unknown. Only valid
+            //!         until the next call.
+            const Glyph* GetGlyph(FontId font, char32_t codepoint);
+
+            int GetPageCount() const { return static_cast<int>(m_pages.size()); }
+            const Page& GetPage(int page) const { return m_pages[page]; }
+
+            //! Mark the page as copied to a texture. Clears the dirty area.
+            void MarkUploaded(int page) { m_pages[page].dirty = Rect(); }
+
+            //! Set the most memory the pages may use. At least one page is always kept.
+            void SetMemoryLimit(size_t bytes);
+            size_t GetMemoryLimit() const { return m_memoryLimit; }
+            size_t GetMemoryUsed() const;
+
+            //! \brief Set a function called just before a page is emptied for reuse.
+            //!
+            //! Renderers that batch draws should flush any that use the page.
+            void SetEvictListener(std::function<void(int page)> listener)
+            {
+                m_evictListener = listener;
+            }
+
+            //! Empty the cache. Fonts remain registered.
+            void Clear();
+
+        private:
+
+            struct Shelf
+            {
+                int y, height, x;
+            };
+
+            struct PagePacking
+            {
+                std::vector<Shelf> shelves;
+                int nextShelfY;
+                unsigned long long lastUsed;
+                std::vector<unsigned long long> glyphs;
+            };
+
+            struct FontEntry
+            {
+                std::shared_ptr<const FontFace> face;
+                float pixelHeight;
+                float scale;
+                Format format;
+                int adds;           // AddFont() calls not yet matched by RemoveFont().
+
+                // Glyphs saved in the disk cache, and rasterized since. Only
+                // kept when the cache is on, or when glyphs were rasterized
+                // ahead of use.
+                bool saveGlyphs;
+                DiskCache::Entry savedGlyphs;
+                std::vector<unsigned char> newGlyphs;
+                size_t newGlyphsSaved;
+                // Offset of each glyph, in the saved then the new glyphs.
+                std::unordered_map<char32_t, size_t> glyphOffsets;
+            };
+
+            void SaveGlyphs(FontEntry& entry);
+
+            bool Allocate(int page, Point size, Point& pos);
+            int AddPage();
+            void EvictPage(int page);
+            size_t MaxPages() const;
+
+            Point m_pageSize;
+            size_t m_memoryLimit;
+            unsigned long long m_clock;
+            FontId m_nextFontId;
+
+            std::unordered_map<FontId, FontEntry> m_fonts;
+            std::unordered_map<unsigned long long, Glyph> m_glyphs;
+            std::vector<Page> m_pages;
+            std::vector<PagePacking> m_packing;
+            std::function<void(int page)> m_evictListener;
+        };
+
+        //
+        //! \brief The glyphs of a font sized for the renderer's scale.
+        //!
+        //! The glyphs for the scale before are kept, so switching back and
+        //! forth, as when a window moves between monitors, doesn't rasterize
+        //! them again.
+        //
+        struct GWK_EXPORT ScaledFont
+        {
+            GlyphCache::FontId id = 0;          //!< Glyphs for renderScale, or 0.
+            float renderScale = 0.f;            //!< Renderer scale the glyphs of id are sized for.
+            GlyphCache::FontId otherId = 0;     //!< Glyphs for the scale before, or 0.
+            float otherScale = 0.f;
+
+            //! Size the glyphs for a new scale, reusing those for the scale before.
+            //! \param scale : The renderer's new scale.
+            //! \param pixelHeight : Height of the glyphs at that scale.
+            void Rescale(GlyphCache& cache, const std::shared_ptr<const FontFace>& face,
+                         float scale, float pixelHeight);
+
+            //! Remove the glyphs of both scales from the cache.
+            void Remove(GlyphCache& cache);
+        };
+
+    }
+}
+
+#endif // ifndef GWK_GLYPHCACHE_H
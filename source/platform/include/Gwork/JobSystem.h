@@ -0,0 +1,124 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_JOBSYSTEM_H
+#define GWK_JOBSYSTEM_H
+
+#include <Gwork/PlatformTypes.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gwk
+{
+    namespace Platform
+    {
+        //
+        //! \brief Runs jobs in parallel, such as decoding the resources
+        //! needed at startup, drawing tiles, or work run in the background.
+        //!
+        //! Each worker thread has its own queue. Jobs queued by a worker go on
+        //! its own queue, and it runs the newest first. A worker with nothing
+        //! left to run steals the oldest job from another queue. Threads
+        //! waiting for a group to finish run its queued jobs themselves rather
+        //! than sleep, so they are run even when there are no workers. Jobs
+        //! are not run in order.
+        //
+        class GWK_EXPORT JobSystem
+        {
+        public:
+
+            //! Jobs that are waited for together.
+            class Group
+            {
+            public:
+                Group() : m_pending(0), m_queued(0) {}
+
+            private:
+                friend class JobSystem;
+
+                Group(const Group&) = delete;
+                Group& operator=(const Group&) = delete;
+
+                std::atomic<int> m_pending;     // Jobs queued or running.
+                std::atomic<int> m_queued;      // Jobs queued.
+            };
+
+            //! Get the job system shared by the library, with a worker for
+            //! each core but the caller's, and at least one. Started on first
+            //! use.
+            static JobSystem& Get();
+
+            //! \param workers : Number of worker threads. May be 0.
+            explicit JobSystem(unsigned int workers);
+
+            //! Stop the workers. Jobs still queued are not run.
+            ~JobSystem();
+
+            unsigned int GetWorkerCount() const
+            {
+                return static_cast<unsigned int>(m_threads.size());
+            }
+
+            //! Queue a job. Safe to call from any thread, including from jobs.
+            void Run(Group& group, std::function<void()> job);
+
+            //! Wait for the jobs of a group to finish, running its queued jobs
+            //! meanwhile. Jobs of other groups are left to the workers.
+            void Wait(Group& group);
+
+            //! Queue a job that is not waited for. Only workers run it, so
+            //! there must be at least one.
+            void RunInBackground(std::function<void()> job)
+            {
+                Run(m_background, std::move(job));
+            }
+
+        private:
+
+            struct Job
+            {
+                std::function<void()> work;
+                Group* group;
+            };
+
+            struct Queue
+            {
+                std::mutex mutex;
+                std::deque<Job> jobs;
+            };
+
+            JobSystem(const JobSystem&) = delete;
+            JobSystem& operator=(const JobSystem&) = delete;
+
+            void WorkerLoop(int index);
+            bool Take(Queue& queue, bool newest, const Group* group, Job& job);
+            bool RunOne(int index, const Group* group);
+            int ThreadQueue() const;
+
+            Group m_background;
+
+            std::vector<std::unique_ptr<Queue>> m_queues;   // One per worker, or one if none.
+            std::vector<std::thread> m_threads;
+            std::atomic<unsigned int> m_nextQueue;          // For threads that are not workers.
+            std::atomic<int> m_queued;
+
+            // Guards sleeping, so that wake-ups are not missed.
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            bool m_stop;
+        };
+
+    }
+}
+
+#endif // ifndef GWK_JOBSYSTEM_H
@@ -44,6 +44,9 @@ namespace Gwk
         //
         // System Dialogs (Can return false if unhandled)
         //
+        //! True if the platform has the system dialogs below. Without them
+        //! they always return false, and a Gwork dialog can be shown instead.
+        GWK_EXPORT bool HasFileDialogs();
         GWK_EXPORT bool FileOpen(const String& Name, const String& StartPath,
                                  const String& Extension, String& filePathOut);
         GWK_EXPORT bool FileSave(const String& Name, const String& StartPath,
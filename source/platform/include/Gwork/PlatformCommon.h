@@ -11,6 +11,8 @@
 #define GWK_PLATFORM_COMMON_H
 
 #include <Gwork/PlatformTypes.h>
+#include <functional>
+#include <memory>
 #include <vector>
 
 namespace Gwk
@@ -36,6 +38,114 @@ namespace Gwk
             String GetPath(Type type, String const& relPath) final;
         };
 
+        //! SIMD instruction sets available on the running CPU.
+        struct CpuFeatures
+        {
+            bool sse2 = false;
+            bool avx2 = false;
+        };
+
+        //! Get the SIMD instruction sets we can use. Detected on first call.
+        GWK_EXPORT const CpuFeatures& GetCpuFeatures();
+
+        //! Restrict the instruction sets used, e.g. to compare with the scalar code.
+        //! Features the CPU does not have cannot be turned on.
+        GWK_EXPORT void SetCpuFeatures(const CpuFeatures& features);
+
+        //! Size and modification time of a file, to tell if it has changed.
+        struct FileStamp
+        {
+            unsigned long long size = 0;
+            long long modified = 0;     //!< Modification time, in platform units.
+
+            bool operator==(const FileStamp& rhs) const
+            {
+                return size == rhs.size && modified == rhs.modified;
+            }
+            bool operator!=(const FileStamp& rhs) const { return !(*this == rhs); }
+        };
+
+        //! Get the size and modification time of a file.
+        //! \return False if the file does not exist.
+        GWK_EXPORT bool GetFileStamp(const String& filename, FileStamp& stamp);
+
+        //! An entry of a directory.
+        struct DirectoryEntry
+        {
+            String name;            //!< Name within the directory, in UTF-8.
+            bool isDirectory;
+        };
+
+        //! \brief List the entries of a directory, in batches.
+        //!
+        //! Entries are passed on as they are read, in no particular order, so
+        //! the first can be shown before a large directory has been read.
+        //! "." and ".." are left out. Slow on large directories, so better
+        //! called from a background thread, e.g. with RunInBackground().
+        //! \param path : Path of the directory.
+        //! \param onEntries : Called with each batch. Return false to stop.
+        //! \param batchSize : Most entries passed in one batch.
+        //! \return False if the directory could not be read.
+        GWK_EXPORT bool ListDirectory(const String& path,
+                                      const std::function<bool(std::vector<DirectoryEntry>&&)>& onEntries,
+                                      size_t batchSize = 256);
+
+        //! A file mapped read-only into memory.
+        class GWK_EXPORT MappedFile
+        {
+        public:
+            MappedFile();
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            //! Map a file, closing any file already mapped.
+            //! \param filename : Path of the file.
+            //! \return True if the file was mapped. Empty files cannot be mapped.
+            bool Open(const String& filename);
+            void Close();
+
+            bool IsOpen() const { return m_data != nullptr; }
+            const unsigned char* Data() const { return m_data; }
+            size_t Size() const { return m_size; }
+
+            //! The file's size and modification time when it was mapped.
+            const FileStamp& Stamp() const { return m_stamp; }
+
+        private:
+            const unsigned char* m_data;
+            size_t m_size;
+            void* m_mapping;    // Windows mapping handle.
+            FileStamp m_stamp;
+        };
+
+        //! \brief Map a resource file read-only, sharing the mapping.
+        //!
+        //! Fonts are read straight from the mapping rather than from a copy.
+        //! Images are not mapped: stb_image gathers their data into its own
+        //! buffer, so a mapping would only add to the peak resident size.
+        //! A file already mapped is shared, and a few small, recently used
+        //! files stay mapped after they are released, so loading them again
+        //! does not go to the disk. A file that changed since it was mapped is
+        //! mapped again. Safe to call from any thread.
+        //! \param filename : Path of the file, e.g. from ResourcePaths.
+        //! \return The mapping, or null if the file could not be mapped.
+        GWK_EXPORT std::shared_ptr<const MappedFile> MapResourceFile(const String& filename);
+
+        //! Unmap the resource files kept mapped for reuse. Files still in use
+        //! stay mapped until they are released. On Windows a mapped file
+        //! cannot be overwritten.
+        GWK_EXPORT void ReleaseResourceFiles();
+
+        //! \brief Run a function on a background thread.
+        //!
+        //! Functions are run by the workers of JobSystem::Get(), not
+        //! necessarily in the order queued. Threads waiting for their own
+        //! jobs do not run them. Work still queued when the program exits is
+        //! not run.
+        GWK_EXPORT void RunInBackground(std::function<void()> work);
+
 #if GWK_ALLOC_STATS
 
         struct AllocStats
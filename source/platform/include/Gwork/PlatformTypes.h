@@ -16,6 +16,7 @@
 #endif
 
 #include <Gwork/Config.h>
+#include <atomic>
 #include <functional>
 #include <string>
 #include <list>
@@ -245,7 +246,7 @@ namespace Gwk
         static const Color GworkPink(255, 65, 199, 255);
     }
 
-    struct Font
+    struct GWK_EXPORT Font
     {
         typedef std::list<Font*> List;
 
@@ -259,30 +260,87 @@ namespace Gwk
         };
 
         Font()
-        :   facename("?")
-        ,   size(10)
-        ,   bold(false)
+        :   m_facename("?")
+        ,   m_size(10)
+        ,   m_bold(false)
+        ,   m_handle(0)
         {}
 
-        Font(const Font&) = default;
-        Font& operator=(const Font&) = default;
+        Font(const Font& other)
+        :   m_facename(other.m_facename)
+        ,   m_size(other.m_size)
+        ,   m_bold(other.m_bold)
+        ,   m_handle(0)
+        {
+            ShareHandle(other);
+        }
+
+        ~Font() { ResetHandle(); }
 
-        inline bool operator==(const Font& rhs) const
+        Font& operator=(const Font& other)
         {
-            return facename == rhs.facename && size == rhs.size && bold == rhs.bold;
+            if (this != &other)
+            {
+                ResetHandle();
+                m_facename = other.m_facename;
+                m_size = other.m_size;
+                m_bold = other.m_bold;
+                ShareHandle(other);
+            }
+            return *this;
         }
 
-        inline bool operator!=(const Font& rhs) const
+        inline bool operator==(const Font& rhs) const { return GetHandle() == rhs.GetHandle(); }
+        inline bool operator!=(const Font& rhs) const { return GetHandle() != rhs.GetHandle(); }
+
+        const String& GetFacename() const { return m_facename; }
+        void SetFacename(const String& facename) { ResetHandle(); m_facename = facename; }
+
+        float GetSize() const { return m_size; }
+        void SetSize(float size) { ResetHandle(); m_size = size; }
+
+        bool IsBold() const { return m_bold; }
+        void SetBold(bool bold) { ResetHandle(); m_bold = bold; }
+
+        //! \brief Number identifying fonts with the same face, size and boldness.
+        //!
+        //! Renderers compare and hash fonts by their handles, rather than by
+        //! name. It is assigned when first needed and copied with the font.
+        //! Safe to call from several threads on the same font. The handle is
+        //! freed, and may be given to another font, once no Font holds it.
+        unsigned int GetHandle() const
         {
-            return  bold != rhs.bold || size != rhs.size || facename != rhs.facename;
+            const unsigned int handle = m_handle.load(std::memory_order_relaxed);
+            return handle != 0 ? handle : Intern();
         }
 
-        String facename;
-        float size;
-        bool bold;
+    private:
+
+        void ResetHandle()
+        {
+            if (m_handle.load(std::memory_order_relaxed) != 0)
+                ReleaseHandle();
+        }
+        // Call with the key of other copied.
+        void ShareHandle(const Font& other)
+        {
+            if (other.m_handle.load(std::memory_order_relaxed) != 0)
+                AddHandleRef();
+        }
+        unsigned int Intern() const;
+        void AddHandleRef();
+        void ReleaseHandle();
+
+        String m_facename;
+        float m_size;
+        bool m_bold;
+
+        // 0 until first needed. Threads interning at once store the same value.
+        // Each Font holding a handle counts as a reference to it.
+        mutable std::atomic<unsigned int> m_handle;
     };
 
-    struct Texture
+    struct GWK_EXPORT Texture
     {
         typedef std::list<Texture*> List;
 
@@ -293,21 +351,80 @@ namespace Gwk
             Loaded,                 //!< Loaded successful.
             ErrorFileNotFound,      //!< File requested was not found.
             ErrorBadData,           //!< Resource was bad data.
+            Loading,                //!< Being loaded in the background.
             MaxStatus
         };
 
         Texture()
-            : readable(false)
+            :   readable(false)
+            ,   m_handle(0)
         {}
 
-        Texture(const Texture&) = default;
-        Texture& operator=(const Texture&) = default;
+        Texture(const Texture& other)
+            :   readable(other.readable)
+            ,   m_name(other.m_name)
+            ,   m_handle(0)
+        {
+            ShareHandle(other);
+        }
+
+        ~Texture() { ResetHandle(); }
+
+        Texture& operator=(const Texture& other)
+        {
+            if (this != &other)
+            {
+                ResetHandle();
+                readable = other.readable;
+                m_name = other.m_name;
+                ShareHandle(other);
+            }
+            return *this;
+        }
+
+        inline bool operator==(const Texture& rhs) const { return GetHandle() == rhs.GetHandle(); }
+        inline bool operator!=(const Texture& rhs) const { return GetHandle() != rhs.GetHandle(); }
+
+        const String& GetName() const { return m_name; }
+        void SetName(const String& name) { ResetHandle(); m_name = name; }
 
-        inline bool operator==(const Texture& rhs) const { return name == rhs.name; }
-        inline bool operator!=(const Texture& rhs) const { return name != rhs.name; }
+        //! \brief Number identifying textures with the same name.
+        //!
+        //! Renderers compare and hash textures by their handles, rather than
+        //! by name. It is assigned when first needed and copied with the
+        //! texture. Safe to call from several threads on the same texture.
+        //! The handle is freed, and may be given to another texture, once no
+        //! Texture holds it.
+        unsigned int GetHandle() const
+        {
+            const unsigned int handle = m_handle.load(std::memory_order_relaxed);
+            return handle != 0 ? handle : Intern();
+        }
 
-        String  name;
         bool readable;
+
+    private:
+
+        void ResetHandle()
+        {
+            if (m_handle.load(std::memory_order_relaxed) != 0)
+                ReleaseHandle();
+        }
+        // Call with the key of other copied.
+        void ShareHandle(const Texture& other)
+        {
+            if (other.m_handle.load(std::memory_order_relaxed) != 0)
+                AddHandleRef();
+        }
+        unsigned int Intern() const;
+        void AddHandleRef();
+        void ReleaseHandle();
+
+        String m_name;
+
+        // 0 until first needed. Threads interning at once store the same value.
+        // Each Texture holding a handle counts as a reference to it.
+        mutable std::atomic<unsigned int> m_handle;
     };
 
     struct TextureData
@@ -366,6 +483,27 @@ namespace Gwk
         virtual void FreeTexture(const Gwk::Texture& texture) = 0;
         virtual Gwk::TextureData GetTextureData(const Gwk::Texture& texture) const = 0;
 
+        //! Called when a texture loaded in the background has loaded, or failed to.
+        typedef std::function<void(Gwk::Texture::Status)> TextureLoadedCallback;
+
+        //! \brief Load a texture without waiting for it.
+        //!
+        //! Loaders that support this return Loading, and call \p onLoaded on
+        //! the render thread once the texture is ready. Others load the
+        //! texture immediately and return the result, without calling
+        //! \p onLoaded.
+        //! \param owner : Identifies the caller, to cancel the callback.
+        virtual Gwk::Texture::Status LoadTextureAsync(const Gwk::Texture& texture,
+                                                      const void* owner,
+                                                      const TextureLoadedCallback& onLoaded)
+        {
+            return LoadTexture(texture);
+        }
+
+        //! Stop waiting for a texture being loaded in the background. Its
+        //! callback for \p owner is not called.
+        virtual void CancelTextureLoad(const Gwk::Texture& texture, const void* owner) {}
+
         //! Notification of certain events. May be platform specific.
         //! Loader can deal with the events accordingly.
         virtual void Notify(NotificationType msg) {}
@@ -387,14 +525,9 @@ namespace std
         typedef std::size_t result_type;
 
 
-        result_type operator()(argument_type const& f) const noexcept
+        result_type operator()(argument_type const& f) const
         {
-            result_type res = std::hash<Gwk::String>{}(f.facename);
-
-            Gwk::hash_combine<decltype(f.size)>(res, f.size);
-            Gwk::hash_combine<decltype(f.bold)>(res, f.bold);
-
-            return res;
+            return f.GetHandle();
         }
     };
     template<> struct hash<Gwk::Texture>
@@ -403,9 +536,9 @@ namespace std
         typedef std::size_t result_type;
 
 
-        result_type operator()(argument_type const& f) const noexcept
+        result_type operator()(argument_type const& f) const
         {
-            return std::hash<decltype(f.name)>{}(f.name);
+            return f.GetHandle();
         }
     };
 } // namespace std
@@ -9,6 +9,7 @@
 #define GWK_RENDERERS_DIRECTX11_H
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/TextureBudget.h>
 #include <d3d11.h>
 #include <vector>
 #include <unordered_map>
@@ -67,6 +68,9 @@ namespace Gwk
             TextureData GetTextureData(const Gwk::Texture& texture) const override;
             bool EnsureTexture(const Gwk::Texture& texture) override;
 
+            //! Limits and reports the memory used by textures.
+            TextureBudget& GetTextureBudget() { return m_textureBudget; }
+
         protected:
 
             FLOAT                   width, height;
@@ -119,6 +123,7 @@ namespace Gwk
                     std::swap(readable, other.readable);
                     std::swap(m_Texture, other.m_Texture);
                     std::swap(m_TextureResource, other.m_TextureResource);
+                    std::swap(budget, other.budget);
 
                     m_ReadData.swap(other.m_ReadData);
                 }
@@ -131,13 +136,24 @@ namespace Gwk
 
                 ID3D11Texture2D* m_Texture;
                 ID3D11ShaderResourceView* m_TextureResource;
-                deleted_unique_ptr<unsigned char> m_ReadData;
+                deleted_unique_ptr<const unsigned char> m_ReadData;
+                TextureBudget::Entry budget;
             };
 
+            //! Make a D3D texture from decoded RGBA pixels.
+            Texture::Status CreateTexture(const Gwk::Texture& texture, int width, int height,
+                                          deleted_unique_ptr<const unsigned char> pixels);
+
+            TextureDecoder GetTextureDecoder(const Gwk::Texture& texture) override;
+
+            //! Bake a font for a new Scale(), keeping the one for the scale before.
+            bool RescaleFont(const Gwk::Font& font);
+
             struct DxFontData
             {
                 DxFontData()
                     : m_Spacing(0.f)
+                    , renderScale(0.f)
                     , m_Texture(nullptr)
                     , m_TextureResource(nullptr)
                 {
@@ -149,6 +165,8 @@ namespace Gwk
                 {
                     std::swap(width, other.width);
                     std::swap(height, other.height);
+                    std::swap(m_Spacing, other.m_Spacing);
+                    std::swap(renderScale, other.renderScale);
                     std::swap(m_Texture, other.m_Texture);
                     std::swap(m_TextureResource, other.m_TextureResource);
                     std::swap(m_TexCoords, other.m_TexCoords);
@@ -171,6 +189,7 @@ namespace Gwk
                 std::vector<FLOAT4> m_TexCoords;
 
                 float   m_Spacing;
+                float   renderScale;    // Scale() the font was baked at.
 
                 float width;
                 float height;
@@ -179,9 +198,13 @@ namespace Gwk
             };
 
             std::unordered_map<Font, DxFontData> m_fonts;
+            std::unordered_map<Font, DxFontData> m_otherScaleFonts;  // Baked at the scale before.
             std::unordered_map<Texture, DxTextureData> m_textures;
             std::pair<const Font, DxFontData>* m_lastFont;
             std::pair<const Texture, DxTextureData>* m_lastTexture;
+            std::u32string m_textCodepoints;    // Scratch buffer for decoded text.
+            TextureBudget m_textureBudget;
+            bool m_readBackCopies;      // PixelColor() copied a texture that isn't readable.
 
             void Flush();
             void Present();
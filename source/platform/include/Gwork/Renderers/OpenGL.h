@@ -9,6 +9,9 @@
 #define GWK_RENDERERS_OPENGL_H
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/GlyphCache.h>
+#include <Gwork/TextureAtlas.h>
+#include <Gwork/TextureBudget.h>
 #include <unordered_map>
 #include <memory>
 #include <vector>
@@ -27,9 +30,7 @@ namespace Gwk
             template<typename T>
             using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
 
-            static const wchar_t BeginCharacter = L' ';    // First Character of Wide Character Table
-            static const wchar_t LastCharacter = 0x2FFF;   // Last Character of Wide Character Table
-            static const wchar_t NewLineCharacter = L'\n'; // New Line Character
+            static const wchar_t BeginCharacter = L' ';    // First printable character
 
         public:
             OpenGL(ResourcePaths& paths, const Gwk::Rect& viewRect);
@@ -68,11 +69,20 @@ namespace Gwk
             void FreeTexture(const Gwk::Texture& texture) override;
             TextureData GetTextureData(const Gwk::Texture& texture) const override;
             bool EnsureTexture(const Gwk::Texture& texture) override;
+
+            //! Glyphs rasterized for drawing text. Can be used to set the memory limit.
+            GlyphCache& GetGlyphCache() { return m_glyphCache; }
+
+            //! Limits and reports the memory used by textures.
+            TextureBudget& GetTextureBudget() { return m_textureBudget; }
+
         protected:// Resourses
 
             struct GLTextureData : public Gwk::TextureData
             {
                 GLTextureData()
+                    :   texture_id(0)
+                    ,   atlasImage(0)
                 {
                 }
                 GLTextureData(const GLTextureData&) = delete;
@@ -83,62 +93,58 @@ namespace Gwk
                     std::swap(height, other.height);
                     std::swap(readable, other.readable);
                     std::swap(texture_id, other.texture_id);
+                    std::swap(atlasImage, other.atlasImage);
+                    std::swap(budget, other.budget);
 
                     m_ReadData.swap(other.m_ReadData);
                 }
 
                 ~GLTextureData();
 
-                unsigned int texture_id;
-                deleted_unique_ptr<unsigned char> m_ReadData;
+                unsigned int texture_id;            //!< 0 if only in the atlas.
+                TextureAtlas::ImageId atlasImage;   //!< 0 if not in the atlas.
+                deleted_unique_ptr<const unsigned char> m_ReadData;
+                TextureBudget::Entry budget;
             };
 
-            struct GLFontData
-            {
-                GLFontData()
-                    : m_Spacing(0.f)
-                {
-                }
-
-                GLFontData(const GLFontData&) = delete;
-                GLFontData(GLFontData&& other)
-                    : GLFontData()
-                {
-                    std::swap(width, other.width);
-                    std::swap(height, other.height);
-                    std::swap(texture_id, other.texture_id);
-                    std::swap(baked_chars, other.baked_chars);
-                }
-
-                ~GLFontData()
-                {
-                }
-
-                struct stbtt_bakedchar
-                {
-                    unsigned short x0, y0, x1, y1; // coordinates of bbox in bitmap
-                    float xoff, yoff, xadvance;
-                };
+            //! Make a GL texture from decoded RGBA pixels.
+            Texture::Status CreateTexture(const Gwk::Texture& texture, int width, int height,
+                                          deleted_unique_ptr<const unsigned char> pixels);
 
-                std::vector<stbtt_bakedchar> baked_chars;
+            //! Give an image in the atlas a texture of its own, so UVs can repeat.
+            void SeparateFromAtlas(GLTextureData& texData);
 
-                float   m_Spacing;
+            TextureDecoder GetTextureDecoder(const Gwk::Texture& texture) override;
+            FontBaker GetFontBaker(const Gwk::Font& font) override;
 
-                float width;
-                float height;
-                unsigned int texture_id;
+            struct GLFontData
+            {
+                std::shared_ptr<const FontFace> face;
+                ScaledFont glyphs;
             };
 
+            //! Size a font's glyphs for a new Scale().
+            void RescaleFont(const Gwk::Font& font, GLFontData& fontData);
+
             std::unordered_map<Font, GLFontData> m_fonts;
             std::unordered_map<Texture, GLTextureData> m_textures;
             std::pair<const Font, GLFontData>* m_lastFont;
             std::pair<const Texture, GLTextureData>* m_lastTexture;
+            std::u32string m_textCodepoints;    // Scratch buffer for decoded text.
+            GlyphCache m_glyphCache;
+            std::vector<unsigned int> m_glyphTextures;  // Texture for each glyph page.
+            TextureAtlas m_textureAtlas;                // Small textures, packed together.
+            std::vector<unsigned int> m_atlasTextures;  // Texture for each atlas page.
+            TextureBudget m_textureBudget;
+            bool m_readBackCopies;      // PixelColor() copied a texture that isn't readable.
         protected:
 
             Rect m_viewRect;
             Color m_color;
             unsigned int m_current_texture;
             unsigned char m_textures_on;
+            Rect m_clipRect;        // Scaled clip region.
+            bool m_clipping;
 
             static const int MaxVerts = 1024;
             struct Vertex
@@ -153,8 +159,18 @@ namespace Gwk
 
             void Flush();
             void AddVert(int x, int y, float u = 0.0f, float v = 0.0f);
+
+            //! Add a rectangle, clipped to the clip region while clipping.
+            void AddQuad(Gwk::Rect rect, float u1 = 0.0f, float v1 = 0.0f,
+                         float u2 = 1.0f, float v2 = 1.0f);
             void SetTexture(unsigned int texture);
 
+            //! Bind the texture of a glyph page, uploading any new glyphs.
+            void BindGlyphPage(int page);
+
+            //! Bind the texture of an atlas page, uploading any new images.
+            void BindAtlasPage(int page);
+
         public:
 
             bool InitializeContext(Gwk::WindowProvider* window) override;
@@ -3,6 +3,9 @@
 
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/GlyphCache.h>
+#include <Gwork/TextureAtlas.h>
+#include <Gwork/TextureBudget.h>
 #include <vector>
 #include <glm/glm.hpp>
 #include <unordered_map>
@@ -21,9 +24,7 @@ namespace Gwk
             template<typename T>
             using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
 
-            static const wchar_t BeginCharacter = L' ';    // First Character of Wide Character Table
-            static const wchar_t LastCharacter = 0x2FFF;   // Last Character of Wide Character Table
-            static const wchar_t NewLineCharacter = L'\n'; // New Line Character
+            static const wchar_t BeginCharacter = L' ';    // First printable character
 
         public:
 
@@ -64,11 +65,19 @@ namespace Gwk
             TextureData GetTextureData(const Gwk::Texture& texture) const override;
             bool EnsureTexture(const Gwk::Texture& texture) override;
 
+            //! Glyphs rasterized for drawing text. Can be used to set the memory limit.
+            GlyphCache& GetGlyphCache() { return m_glyphCache; }
+
+            //! Limits and reports the memory used by textures.
+            TextureBudget& GetTextureBudget() { return m_textureBudget; }
+
         protected:// Resourses
 
             struct GLTextureData : public Gwk::TextureData
             {
                 GLTextureData()
+                    :   texture_id(0)
+                    ,   atlasImage(0)
                 {
                 }
                 GLTextureData(const GLTextureData&) = delete;
@@ -79,56 +88,50 @@ namespace Gwk
                     std::swap(height, other.height);
                     std::swap(readable, other.readable);
                     std::swap(texture_id, other.texture_id);
+                    std::swap(atlasImage, other.atlasImage);
+                    std::swap(budget, other.budget);
 
                     m_ReadData.swap(other.m_ReadData);
                 }
 
                 ~GLTextureData();
 
-                unsigned int texture_id;
-                deleted_unique_ptr<unsigned char> m_ReadData;
+                unsigned int texture_id;            //!< 0 if only in the atlas.
+                TextureAtlas::ImageId atlasImage;   //!< 0 if not in the atlas.
+                deleted_unique_ptr<const unsigned char> m_ReadData;
+                TextureBudget::Entry budget;
             };
 
-            struct GLFontData
-            {
-                GLFontData()
-                    : m_Spacing(0.f)
-                {
-                }
+            //! Make a GL texture from decoded RGBA pixels.
+            Texture::Status CreateTexture(const Gwk::Texture& texture, int width, int height,
+                                          deleted_unique_ptr<const unsigned char> pixels);
 
-                GLFontData(const GLFontData&) = delete;
-                GLFontData(GLFontData&& other)
-                    : GLFontData()
-                {
-                    std::swap(width, other.width);
-                    std::swap(height, other.height);
-                    std::swap(texture_id, other.texture_id);
-                    std::swap(baked_chars, other.baked_chars);
-                }
+            //! Give an image in the atlas a texture of its own, so UVs can repeat.
+            void SeparateFromAtlas(GLTextureData& texData);
 
-                ~GLFontData()
-                {
-                }
-
-                struct stbtt_bakedchar
-                {
-                    unsigned short x0, y0, x1, y1; // coordinates of bbox in bitmap
-                    float xoff, yoff, xadvance;
-                };
+            TextureDecoder GetTextureDecoder(const Gwk::Texture& texture) override;
+            FontBaker GetFontBaker(const Gwk::Font& font) override;
 
-                std::vector<stbtt_bakedchar> baked_chars;
-
-                float   m_Spacing;
-
-                int width;
-                int height;
-                unsigned int texture_id;
+            struct GLFontData
+            {
+                std::shared_ptr<const FontFace> face;
+                ScaledFont glyphs;
             };
 
+            //! Size a font's glyphs for a new Scale().
+            void RescaleFont(const Gwk::Font& font, GLFontData& fontData);
+
             std::unordered_map<Font, GLFontData> m_fonts;
             std::unordered_map<Texture, GLTextureData> m_textures;
             std::pair<const Font, GLFontData>* m_lastFont;
             std::pair<const Texture, GLTextureData>* m_lastTexture;
+            std::u32string m_textCodepoints;    // Scratch buffer for decoded text.
+            GlyphCache m_glyphCache;
+            std::vector<unsigned int> m_glyphTextures;  // Texture for each glyph page.
+            TextureAtlas m_textureAtlas;                // Small textures, packed together.
+            std::vector<unsigned int> m_atlasTextures;  // Texture for each atlas page.
+            TextureBudget m_textureBudget;
+            bool m_readBackCopies;      // PixelColor() copied a texture that isn't readable.
         public:
 
             bool InitializeContext(Gwk::WindowProvider* window) override;
@@ -157,12 +160,24 @@ namespace Gwk
              * @param v
              */
             void AddVert(int x, int y, float u = 0.0f, float v = 0.0f);
+
+            //! Add a rectangle, clipped to the clip region while clipping.
+            void AddQuad(Gwk::Rect rect, float u1 = 0.0f, float v1 = 0.0f,
+                         float u2 = 1.0f, float v2 = 1.0f);
             void SetTexture(unsigned int texture);
 
+            //! Bind the texture of a glyph page, uploading any new glyphs.
+            void BindGlyphPage(int page);
+
+            //! Bind the texture of an atlas page, uploading any new images.
+            void BindAtlasPage(int page);
+
             Rect m_viewRect;
             Color m_color;
             unsigned int m_current_texture;
             unsigned char m_textures_on;
+            Rect m_clipRect;        // Scaled clip region.
+            bool m_clipping;
 
             struct Vertex
             {
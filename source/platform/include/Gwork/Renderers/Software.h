@@ -11,41 +11,97 @@
 #define GWK_RENDERERS_SOFTWARE_H
 
 #include <Gwork/BaseRender.h>
+#include <Gwork/GlyphCache.h>
+#include <Gwork/TextureBudget.h>
+#include <cstddef>
 #include <unordered_map>
 #include <memory>
 #include <vector>
 #include <functional>
+#include <atomic>
 
 namespace Gwk
 {
     namespace Renderer
     {
-        //! Simple 2D pixel buffer.
-        class PixelBuffer
+        //
+        //! \brief Simple 2D pixel buffer.
+        //!
+        //! Buffers that allocate their own memory start each row on a
+        //! RowAlignment byte boundary. A buffer can also wrap memory owned
+        //! elsewhere, such as a shared memory segment or a window system image,
+        //! so that frames are drawn straight into it.
+        //
+        class GWK_EXPORT PixelBuffer
         {
-            Point m_size;
-            Color *m_buffer;
         public:
-            PixelBuffer() : m_buffer(nullptr) {}
-            ~PixelBuffer()
+
+            //! Formats the pixels can be converted to.
+            enum class Format
+            {
+                RGBA,       //!< Bytes R, G, B, A. The format of the buffer.
+                BGRA,       //!< Bytes B, G, R, A.
+                RGBX,       //!< Bytes R, G, B, then 255.
+                RGB565      //!< 16 bits: 5 red in the high bits, 6 green, 5 blue.
+            };
+
+            //! Alignment of the rows of allocated buffers, in bytes.
+            static const int RowAlignment = 64;
+
+            PixelBuffer();
+            ~PixelBuffer();
+
+            PixelBuffer(const PixelBuffer&) = delete;
+            PixelBuffer& operator = (const PixelBuffer&) = delete;
+
+            //! Allocate the pixels. They are set to opaque white.
+            void Init(Point const& sz);
+
+            //! \brief Draw into memory owned by the caller, which must outlive
+            //! the buffer. The pixels are left as they are.
+            //! \param memory : First pixel of the top row.
+            //! \param stride : Bytes from the start of one row to the next. A
+            //!                 multiple of 4.
+            void Init(Point const& sz, void* memory, int stride);
+
+            Point GetSize() const { return m_size; }
+
+            //! Bytes from the start of one row to the next.
+            int GetStride() const { return m_stride; }
+
+            Color* Row(int y)
             {
-                delete [] m_buffer;
+                return reinterpret_cast<Color*>(reinterpret_cast<unsigned char*>(m_buffer)
+                                                + static_cast<std::ptrdiff_t>(y) * m_stride);
             }
-            void Init(Point const& sz)
+            const Color* Row(int y) const
             {
-                m_size = sz;
-                m_buffer = new Color[m_size.x * m_size.y];
+                return reinterpret_cast<const Color*>(reinterpret_cast<const unsigned char*>(m_buffer)
+                                                      + static_cast<std::ptrdiff_t>(y) * m_stride);
             }
 
-            Point GetSize() const { return m_size; }
-
-            Color& At(int x, int y) { return m_buffer[y * m_size.x + x]; }
+            Color& At(int x, int y) { return Row(y)[x]; }
             Color& At(Point const& pt) { return At(pt.x, pt.y); }
 
-            const Color& At(int x, int y) const { return m_buffer[y * m_size.x + x]; }
+            const Color& At(int x, int y) const { return Row(y)[x]; }
             const Color& At(Point const& pt) const { return At(pt.x, pt.y); }
+
+            //! Convert the pixels to another format.
+            //! \param format : Format of the destination.
+            //! \param dst : Destination, the size of the buffer.
+            //! \param dstStride : Bytes from the start of one destination row to the next.
+            void ConvertTo(Format format, void* dst, int dstStride) const;
+
+        private:
+
+            Point m_size;
+            Color* m_buffer;
+            int m_stride;
+            std::unique_ptr<unsigned char[]> m_memory;  // Allocated, if not external.
         };
 
+        class SoftwareCTT;
+
         //! \brief Renders to a buffer without needing external dependencies.
         //!
         //! This can be used for screenshots and testing.
@@ -54,15 +110,15 @@ namespace Gwk
             template<typename T>
             using deleted_unique_ptr = std::unique_ptr<T, std::function<void(T*)>>;
 
-            static const wchar_t BeginCharacter = L' ';    // First Character of Wide Character Table
-            static const wchar_t LastCharacter = 0x2FFF;   // Last Character of Wide Character Table
-            static const wchar_t NewLineCharacter = L'\n'; // New Line Character
+            static const wchar_t BeginCharacter = L' ';    // First printable character
 
         public:
 
             Software(ResourcePaths& paths, PixelBuffer& pbuff);
             virtual ~Software();
 
+            void End() override;
+
             void StartClip() override;
             void EndClip() override;
 
@@ -71,10 +127,22 @@ namespace Gwk
             void DrawFilledRect(Gwk::Rect rect) override;
             void DrawLinedRect(Gwk::Rect rect) override;
             void DrawPixel(int x, int y) override;
+            void DrawShavedCornerRect(Gwk::Rect rect, bool bSlight = false) override;
+
+            void DrawLinearGradientRect(Gwk::Rect rect, Gwk::Color start, Gwk::Color end,
+                                        bool vertical = false) override;
+            void DrawBilinearGradientRect(Gwk::Rect rect,
+                                          Gwk::Color topLeft, Gwk::Color topRight,
+                                          Gwk::Color bottomLeft, Gwk::Color bottomRight) override;
 
             void DrawTexturedRect(const Gwk::Texture& texture, Gwk::Rect targetRect, float u1 = 0.0f,
                                   float v1 = 0.0f, float u2 = 1.0f, float v2 = 1.0f) override;
 
+            //! Draws the areas of the patch as one command.
+            void DrawNinePatch(const Gwk::Texture& texture, Gwk::Rect targetRect,
+                               const NinePatch& grid, Gwk::Color color,
+                               unsigned int draw = ~0u) override;
+
             Gwk::Color PixelColor(const Gwk::Texture& texture,
                                   unsigned int x, unsigned int y,
                                   const Gwk::Color& col_default) override;
@@ -94,6 +162,68 @@ namespace Gwk
             void FreeTexture(const Gwk::Texture& texture) override;
             TextureData GetTextureData(const Gwk::Texture& texture) const override;
             bool EnsureTexture(const Gwk::Texture& texture) override;
+
+            //! \brief Build all the mip levels of a texture now.
+            //!
+            //! Textures drawn at under half their size are sampled from a mip
+            //! level, a copy scaled down by a power of two, so fewer texels
+            //! are read and detail doesn't shimmer. Levels are otherwise built
+            //! the first time they are needed, which may be slow for large
+            //! textures.
+            void GenerateMipmaps(const Gwk::Texture& texture);
+
+            //! Glyphs rasterized for drawing text. Can be used to set the memory limit.
+            GlyphCache& GetGlyphCache() { return m_glyphCache; }
+
+            //! Limits and reports the memory used by textures.
+            TextureBudget& GetTextureBudget() { return m_textureBudget; }
+
+            //! \brief Draw text using signed distance fields.
+            //!
+            //! Each glyph is rasterized once at a reference size and scaled when
+            //! drawn, so fonts of any size or scale share the same glyphs. This
+            //! makes scale changes cheap, at some loss of sharpness in small text.
+            //! Changing the mode frees all fonts.
+            void SetDistanceFieldText(bool enable);
+            bool IsDistanceFieldText() const { return m_distanceFieldText; }
+
+            //! \brief Blend with premultiplied alpha.
+            //!
+            //! Textures are premultiplied when loaded and the draw color when
+            //! set, so blending is S + D*(1 - S_alpha), saving a multiply per
+            //! channel. The pixel buffer then holds premultiplied colors, which
+            //! is the same as straight colors where it is opaque. Changing the
+            //! mode frees all textures.
+            void SetPremultipliedAlpha(bool enable);
+            bool IsPremultipliedAlpha() const { return m_premultipliedAlpha; }
+
+            //! \brief Rasterize on several threads. Experimental.
+            //!
+            //! With 1 or more threads, draws are binned into tiles of the
+            //! pixel buffer during the frame. At End() the tiles are drawn in
+            //! parallel, each in the order the draws were made. With 0 threads,
+            //! the default, draws are made immediately. The calling thread
+            //! draws tiles too, and the others are jobs of JobSystem::Get(), so
+            //! no more threads are used than it has workers.
+            //!
+            //! The output is the same either way, but the speedup on several
+            //! cores has not been measured yet. Off by default until it has;
+            //! see source/bench/RasterThreadsBench.cpp.
+            void SetRasterThreads(int threads);
+            int GetRasterThreads() const { return m_rasterThreads; }
+
+            //! Draw all binned draws now.
+            void Flush();
+
+            ICacheToTexture* GetCTT() override;
+
+            //! \brief Set the most memory the buffers of controls cached to
+            //! texture may use.
+            //!
+            //! When it is reached, the buffers drawn least recently are freed.
+            //! Their controls are rendered again the next time they are drawn.
+            void SetCacheMemoryLimit(size_t bytes);
+            size_t GetCacheMemoryUsed() const;
             
         protected:// Resourses
 
@@ -111,6 +241,8 @@ namespace Gwk
                     std::swap(readable, other.readable);
 
                     m_ReadData.swap(other.m_ReadData);
+                    m_mips.swap(other.m_mips);
+                    std::swap(budget, other.budget);
                 }
 
                 ~SWTextureData() {}
@@ -120,61 +252,91 @@ namespace Gwk
                     return Point(static_cast<int>(width), static_cast<int>(height));
                 }
 
-                Color& At(int x, int y)
-                {
-                    return reinterpret_cast<Color*>(m_ReadData.get())[y * static_cast<int>(width) + x];
-                }
-                Color& At(Point const& pt) { return At(pt.x, pt.y); }
-
                 const Color& At(int x, int y) const
                 {
-                    return reinterpret_cast<Color*>(m_ReadData.get())[y * static_cast<int>(width) + x];
+                    return reinterpret_cast<const Color*>(m_ReadData.get())[y * static_cast<int>(width) + x];
                 }
                 const Color& At(Point const& pt) const { return At(pt.x, pt.y); }
 
-                deleted_unique_ptr<unsigned char> m_ReadData;
+                //! Read-only, as it may be mapped from the disk cache.
+                deleted_unique_ptr<const unsigned char> m_ReadData;
+
+                //! Mip levels built so far, after the texture itself. Each is
+                //! half the size of the one before.
+                std::vector<std::unique_ptr<PixelBuffer>> m_mips;
+
+                TextureBudget::Entry budget;    // Counts the mip levels too.
             };
 
             struct SWFontData
             {
-                SWFontData()
-                    : m_Spacing(0.f)
-                {}
+                std::shared_ptr<const FontFace> face;
+                ScaledFont glyphs;  // Distance fields only use id and renderScale.
+                float scale;        // Scale from glyph pixels to text pixels.
+            };
 
-                SWFontData(const SWFontData&) = delete;
-                SWFontData(SWFontData&& other)
-                    : SWFontData()
-                {
-                    std::swap(width, other.width);
-                    std::swap(height, other.height);
-                    std::swap(baked_chars, other.baked_chars);
+            //! Size a font's glyphs for a new Scale().
+            void RescaleFont(const Gwk::Font& font, SWFontData& fontData);
 
-                    m_ReadData.swap(other.m_ReadData);
-                }
+            //! Decode an image file. Safe to call on any thread.
+            static Texture::Status DecodeTexture(const String& filename, bool premultiplied,
+                                                 SWTextureData& texData);
 
-                ~SWFontData()
-                {
-                }
+            TextureDecoder GetTextureDecoder(const Gwk::Texture& texture) override;
+            FontBaker GetFontBaker(const Gwk::Font& font) override;
 
-                struct stbtt_bakedchar
-                {
-                    unsigned short x0, y0, x1, y1; // coordinates of bbox in bitmap
-                    float xoff, yoff, xadvance;
-                };
+            //! Get a mip level of a texture, building it and the levels
+            //! before it if needed. Level 0 is the texture itself.
+            //! \return The level, or null for level 0.
+            const PixelBuffer* GetMipLevel(SWTextureData& texData, int level);
+
+            void RenderDistanceFieldText(const SWFontData& fontData, Point pos, float baseline,
+                                         const String& text);
 
-                std::vector<stbtt_bakedchar> baked_chars;
+            //! A draw, made immediately or later when binned.
+            struct DrawCommand
+            {
+                enum class Type { Pixel, Fill, Gradient, Textured, NinePatch, Cached, Glyph,
+                                  DistanceGlyph };
+
+                Type type;
+                Rect bounds;        // Pixels drawn, clipped.
+                Color color;
+                Rect area;          // Textured, Gradient: stretched over. Glyph: area in page.
+                const SWTextureData* texture;
+                const PixelBuffer* cached;  // Cached control, premultiplied.
+                const PixelBuffer* mip;     // Textured: mip level drawn, or null for the texture.
+                float u1, v1, u2, v2;
+                int page;           // Glyph page, or nine-patch or gradient index.
+                float x, y, scale;  // Glyph position and scale.
+            };
 
-                float   m_Spacing;
+            // Nine-patch areas, kept aside as they don't fit in a DrawCommand.
+            struct NinePatchAreas
+            {
+                Rect areas[9];      // Translated but not clipped. Empty if not drawn.
+                float u[4], v[4];
+            };
 
-                float width;
-                float height;
-                deleted_unique_ptr<unsigned char> m_ReadData;
+            // Gradient corner colors, kept aside as they don't fit in a DrawCommand.
+            struct GradientColors
+            {
+                Color corners[4];   // Top-left, top-right, bottom-left, bottom-right.
             };
 
+            void Submit(const DrawCommand& cmd);
+            void Execute(const DrawCommand& cmd, const Rect& clip);
+            void RasterizeTiles();
+
             std::unordered_map<Font, SWFontData> m_fonts;
             std::unordered_map<Texture, SWTextureData> m_textures;
             std::pair<const Font, SWFontData>* m_lastFont;
             std::pair<const Texture, SWTextureData>* m_lastTexture;
+            std::u32string m_textCodepoints;    // Scratch buffer for decoded text.
+            GlyphCache m_glyphCache;
+            TextureBudget m_textureBudget;
+            bool m_distanceFieldText;
+            std::unordered_map<String, GlyphCache::FontId> m_distanceFields; // By font file.
             
         public:
 
@@ -195,11 +357,28 @@ namespace Gwk
 
         private:
 
+            friend class SoftwareCTT;
+
             bool Clip(Rect& rect);
             bool m_isClipping;
+            bool m_premultipliedAlpha;
+            bool m_drawingToCache;      // Into a SoftwareCTT buffer, so alpha is composited.
 
             Gwk::Color m_color;
+            Gwk::Color m_fillColor;     // Draw color, premultiplied if blending is.
             PixelBuffer *m_pixbuf;
+            SoftwareCTT *m_ctt;
+
+            // Binned rasterization
+            static const int TileSize = 64;
+            int m_rasterThreads;
+            int m_tilesX, m_tilesY;
+            std::vector<DrawCommand> m_commands;
+            std::vector<NinePatchAreas> m_ninePatches;
+            std::vector<GradientColors> m_gradients;
+            std::vector<std::vector<unsigned int>> m_bins;  // Commands in each tile.
+            std::vector<int> m_activeTiles;                 // Tiles with commands.
+            std::atomic<int> m_nextTile;
         };
 
 
@@ -0,0 +1,136 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_TEXTUREATLAS_H
+#define GWK_TEXTUREATLAS_H
+
+#include <Gwork/PlatformTypes.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace Gwk
+{
+    namespace Renderer
+    {
+        //
+        //! \brief Packs small images into shared RGBA pages.
+        //!
+        //! Renderers that batch draws by texture put small textures, like
+        //! icons, in an atlas so that drawing them does not change texture.
+        //! Images are packed into rows ("shelves") and given a one pixel
+        //! border copied from their edges, so filtering does not bleed.
+        //! Freed space is reused, and when an image does not fit a page
+        //! with many holes is repacked, rather than adding a page. Pages
+        //! left mostly empty by removals have their images moved to others.
+        //! Renderers look up where an image is each time it is drawn.
+        //
+        class GWK_EXPORT TextureAtlas
+        {
+        public:
+
+            typedef unsigned int ImageId;   //!< Identifies an image. Never 0.
+
+            struct Page
+            {
+                Point size;
+                std::vector<unsigned char> pixels;  //!< RGBA. Empty if the page is unused.
+                Rect dirty;         //!< Area changed since the last MarkUploaded().
+            };
+
+            //! Where an image is.
+            struct Placement
+            {
+                int page;
+                Rect rect;          //!< Pixels of the image in the page, without the border.
+            };
+
+            static const int DefaultMaxImageSize = 64;
+
+            //! \param pageSize : Size of the pages.
+            //! \param maxImageSize : Largest width and height of images added.
+            explicit TextureAtlas(Point pageSize = Point(512, 512),
+                                  int maxImageSize = DefaultMaxImageSize);
+
+            //! Check if an image is small enough to add.
+            bool Fits(Point size) const;
+
+            //! Add an image.
+            //! \param size : Size of the image, which must Fits().
+            //! \param rgba : The pixels, in rows.
+            //! \return Identifier of the image, or 0 if it is too big.
+            ImageId Add(Point size, const unsigned char* rgba);
+
+            //! Remove an image. May move the images left in its page.
+            void Remove(ImageId image);
+
+            const Placement& GetPlacement(ImageId image) const;
+
+            int GetPageCount() const { return static_cast<int>(m_pages.size()); }
+            const Page& GetPage(int page) const { return m_pages[page]; }
+
+            //! Mark the page as copied to a texture. Clears the dirty area.
+            void MarkUploaded(int page) { m_pages[page].dirty = Rect(); }
+
+            //! \brief Set a function called just before images are moved in, or
+            //! out of, a page.
+            //!
+            //! Renderers that batch draws should flush any that use the page.
+            void SetMoveListener(std::function<void(int page)> listener)
+            {
+                m_moveListener = listener;
+            }
+
+            size_t GetMemoryUsed() const;
+
+        private:
+
+            struct Slot
+            {
+                int x, width;
+                ImageId image;      // 0 if free
+            };
+
+            struct Shelf
+            {
+                int y, height;
+                std::vector<Slot> slots;    // in order of x
+            };
+
+            struct PagePacking
+            {
+                std::vector<Shelf> shelves;
+                int nextShelfY;
+                int usedArea;       // of the slots in use
+            };
+
+            struct Image
+            {
+                Placement placement;
+                Point size;         // with the border
+            };
+
+            bool Allocate(int page, ImageId image, Point size, Point& pos);
+            void Free(int page, Point pos);
+            int AddPage();
+            void CopyIn(int page, Point pos, Point size, const unsigned char* rgba, bool border);
+            void Repack(int page, bool toOtherPages);
+
+            Point m_pageSize;
+            int m_maxImageSize;
+            ImageId m_nextImageId;
+
+            std::unordered_map<ImageId, Image> m_images;
+            std::vector<Page> m_pages;
+            std::vector<PagePacking> m_packing;
+            std::function<void(int page)> m_moveListener;
+        };
+
+    }
+}
+
+#endif // ifndef GWK_TEXTUREATLAS_H
@@ -0,0 +1,128 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#pragma once
+#ifndef GWK_TEXTUREBUDGET_H
+#define GWK_TEXTUREBUDGET_H
+
+#include <Gwork/PlatformTypes.h>
+#include <deque>
+#include <unordered_map>
+
+namespace Gwk
+{
+    namespace Renderer
+    {
+        //
+        //! \brief Keeps the memory used by a renderer's textures under a limit,
+        //! and reports it.
+        //!
+        //! Renderers record the memory each texture uses and when it was last
+        //! drawn. When textures are loaded past the limit, those drawn least
+        //! recently are freed at the end of the frame. EnsureTexture() loads
+        //! them again the next time they are drawn. Textures drawn in the
+        //! current frame are never freed, so the limit is exceeded if one
+        //! frame draws more. The GPU renderers also count the copies that
+        //! PixelColor() reads back from textures that aren't readable, and
+        //! free them at the end of the frame.
+        //
+        class GWK_EXPORT TextureBudget
+        {
+        public:
+
+            static const size_t DefaultMemoryLimit = 256 * 1024 * 1024;
+
+            //! Most freed textures remembered, to count those loaded again.
+            static const size_t MaxEvictionsTracked = 1024;
+
+            struct Stats
+            {
+                size_t memoryLimit = DefaultMemoryLimit;
+                size_t residentBytes = 0;               //!< Used by textures loaded.
+                size_t residentTextures = 0;            //!< Textures loaded.
+                unsigned long long evictions = 0;       //!< Textures freed for the limit.
+                unsigned long long evictedBytes = 0;    //!< Memory they used.
+                //! Freed textures loaded again, within the last
+                //! MaxEvictionsTracked evictions.
+                unsigned long long reloads = 0;
+            };
+
+            //! Kept by the renderer with each texture, as a member named budget.
+            struct Entry
+            {
+                size_t bytes = 0;
+                unsigned long long lastUsed = 0;        // Frame last drawn in.
+            };
+
+            void SetMemoryLimit(size_t bytes) { m_stats.memoryLimit = bytes; }
+            size_t GetMemoryLimit() const { return m_stats.memoryLimit; }
+
+            const Stats& GetStats() const { return m_stats; }
+
+            //! End a frame. Textures drawn in it may now be freed.
+            void EndFrame() { ++m_frame; }
+
+            //! Record a texture being drawn.
+            void Used(Entry& entry) { entry.lastUsed = m_frame; }
+
+            //! Record a texture loaded. It counts as drawn.
+            void Loaded(const Texture& texture, Entry& entry, size_t bytes);
+
+            //! Record a change in the memory a texture uses.
+            void Resized(Entry& entry, size_t bytes);
+
+            //! Record a texture freed.
+            void Freed(Entry& entry);
+
+            //! \brief Free the textures drawn least recently until the rest
+            //! fit in the limit.
+            //! \param textures : The renderer's textures, mapped from Texture
+            //!                   to data with a budget Entry.
+            //! \param free : Called to free a texture. It must call Freed().
+            template <typename Map, typename Free>
+            void FreeLeastRecentlyUsed(Map& textures, Free free)
+            {
+                while (m_stats.residentBytes > m_stats.memoryLimit)
+                {
+                    auto oldest = textures.end();
+                    for (auto it = textures.begin(); it != textures.end(); ++it)
+                    {
+                        const unsigned long long lastUsed = it->second.budget.lastUsed;
+                        if (lastUsed < m_frame
+                            && (oldest == textures.end()
+                                || lastUsed < oldest->second.budget.lastUsed))
+                        {
+                            oldest = it;
+                        }
+                    }
+
+                    if (oldest == textures.end())
+                        break;
+
+                    const Texture texture = oldest->first;
+                    Evicted(texture, oldest->second.budget);
+                    free(texture);
+                }
+            }
+
+        private:
+
+            void Evicted(const Texture& texture, const Entry& entry);
+
+            Stats m_stats;
+            unsigned long long m_frame = 1;
+
+            // Textures freed for the limit and not loaded again yet, with
+            // their eviction number. The queue drops the oldest, and may
+            // hold stale entries for textures evicted again since.
+            std::unordered_map<Texture, unsigned long long> m_evicted;
+            std::deque<std::pair<Texture, unsigned long long>> m_evictedOrder;
+        };
+
+    }
+}
+
+#endif // ifndef GWK_TEXTUREBUDGET_H
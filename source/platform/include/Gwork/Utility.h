@@ -135,6 +135,21 @@ namespace Gwk
                 return 0;
             }
 
+            //! \brief Decode UTF-8 into Unicode code points.
+            //!
+            //! Runs of ASCII are converted in bulk, using SSE2 or AVX2 if the CPU
+            //! supports them. Malformed sequences are skipped.
+            //! \param in : UTF-8 input. Does not need to be terminated.
+            //! \param len : Number of bytes in the input.
+            //! \param out : Output, with room for at least \p len code points.
+            //! \return Number of code points written.
+            GWK_EXPORT size_t DecodeUtf8(const char* in, size_t len, char32_t* out);
+
+            //! Decode a UTF-8 string into Unicode code points.
+            //! \param str : UTF-8 input.
+            //! \param out : Receives the code points. Any previous contents are replaced.
+            GWK_EXPORT void DecodeUtf8(const Gwk::String& str, std::u32string& out);
+
             namespace To
             {
                 GWK_EXPORT bool  Bool(const Gwk::String& str);
@@ -97,6 +97,11 @@ float Gwk::Platform::GetTimeInSeconds()
     return al_get_time();
 }
 
+bool Gwk::Platform::HasFileDialogs()
+{
+    return true;
+}
+
 bool Gwk::Platform::FileOpen(const String& Name,
                              const String& StartPath,
                              const String& Extension,
@@ -157,6 +157,11 @@ bool Gwk::Platform::SetClipboardText(const Gwk::String& str)
     return true;
 }
 
+bool Gwk::Platform::HasFileDialogs()
+{
+    return false;
+}
+
 bool Gwk::Platform::FileOpen(const String& Name, const String& StartPath, const String& Extension,
                              String& filePathOut)
 {
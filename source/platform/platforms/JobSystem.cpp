@@ -0,0 +1,161 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/JobSystem.h>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace Gwk;
+using namespace Gwk::Platform;
+
+// The job system and queue of the worker running on this thread, if any.
+static thread_local const JobSystem* t_jobSystem = nullptr;
+static thread_local int t_jobQueue = -1;
+
+JobSystem& JobSystem::Get()
+{
+    // The count may be unknown (0). Background jobs need a worker.
+    static JobSystem jobs(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return jobs;
+}
+
+JobSystem::JobSystem(unsigned int workers)
+    :   m_nextQueue(0)
+    ,   m_queued(0)
+    ,   m_stop(false)
+{
+    for (unsigned int i = 0; i < std::max(1u, workers); ++i)
+        m_queues.emplace_back(new Queue);
+
+    for (unsigned int i = 0; i < workers; ++i)
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, static_cast<int>(i));
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+void JobSystem::Run(Group& group, std::function<void()> job)
+{
+    int index = ThreadQueue();
+    if (index < 0)
+        index = static_cast<int>(m_nextQueue++ % m_queues.size());
+
+    ++group.m_pending;
+    {
+        Queue& queue = *m_queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job{ std::move(job), &group });
+        ++group.m_queued;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_queued;
+    }
+    // Wake a worker, and any thread waiting for the group.
+    m_wake.notify_all();
+}
+
+void JobSystem::Wait(Group& group)
+{
+    const int index = ThreadQueue();
+    while (group.m_pending > 0)
+    {
+        if (RunOne(index, &group))
+            continue;
+
+        // The jobs left are running on other threads.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [&group] { return group.m_pending == 0 || group.m_queued > 0; });
+    }
+}
+
+void JobSystem::WorkerLoop(int index)
+{
+    t_jobSystem = this;
+    t_jobQueue = index;
+
+    for (;;)
+    {
+        if (RunOne(index, nullptr))
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+        if (m_stop)
+            return;
+    }
+}
+
+bool JobSystem::Take(Queue& queue, bool newest, const Group* group, Job& job)
+{
+    // Any job, or only those of the group.
+    auto matches = [group](const Job& queued) { return group == nullptr || queued.group == group; };
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    std::deque<Job>::iterator found;
+    if (newest)
+    {
+        auto last = std::find_if(queue.jobs.rbegin(), queue.jobs.rend(), matches);
+        if (last == queue.jobs.rend())
+            return false;
+        found = std::prev(last.base());
+    }
+    else
+    {
+        found = std::find_if(queue.jobs.begin(), queue.jobs.end(), matches);
+        if (found == queue.jobs.end())
+            return false;
+    }
+
+    job = std::move(*found);
+    queue.jobs.erase(found);
+    --job.group->m_queued;
+    return true;
+}
+
+bool JobSystem::RunOne(int index, const Group* group)
+{
+    Job job;
+
+    // Newest from our own queue, as its data is most likely still cached.
+    bool found = index >= 0 && Take(*m_queues[index], true, group, job);
+
+    // Otherwise steal the oldest from another queue.
+    const int count = static_cast<int>(m_queues.size());
+    for (int i = 1; i <= count && !found; ++i)
+        found = Take(*m_queues[(std::max(index, 0) + i) % count], false, group, job);
+
+    if (!found)
+        return false;
+
+    --m_queued;
+    job.work();
+
+    // The group may be gone as soon as its count reaches 0. Taking the lock
+    // makes sure a thread about to wait for it sees the count, or is woken.
+    if (--job.group->m_pending == 0)
+    {
+        m_mutex.lock();
+        m_mutex.unlock();
+        m_wake.notify_all();
+    }
+    return true;
+}
+
+int JobSystem::ThreadQueue() const
+{
+    return t_jobSystem == this ? t_jobQueue : -1;
+}
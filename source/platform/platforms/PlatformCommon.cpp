@@ -6,14 +6,38 @@
 
 #include <Gwork/PlatformCommon.h>
 #include <Gwork/Platform.h>
+#include <Gwork/JobSystem.h>
 #include <Gwork/Utility.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 #include "DebugBreak.h"
 
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#   undef min
+#   undef max
+#else
+#   include <dirent.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#if GWK_SIMD && defined(_MSC_VER)
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif
+
 using namespace Gwk;
 
 //------------------------------------------------------------------------------
@@ -38,6 +62,525 @@ String Gwk::Platform::RelativeToExecutablePaths::GetPath(Type type, String const
 
 //------------------------------------------------------------------------------
 
+static Platform::CpuFeatures DetectCpuFeatures()
+{
+    Platform::CpuFeatures features;
+#if GWK_SIMD && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2") != 0;
+    features.avx2 = __builtin_cpu_supports("avx2") != 0;
+#elif GWK_SIMD && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    // AVX state must be enabled by the OS (OSXSAVE, XCR0 bits 1 & 2)
+    const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (maxLeaf >= 7 && osSavesAvx)
+    {
+        __cpuidex(info, 7, 0);
+        features.avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#endif
+    return features;
+}
+
+static Platform::CpuFeatures& CpuFeaturesInUse()
+{
+    static Platform::CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+const Platform::CpuFeatures& Platform::GetCpuFeatures()
+{
+    return CpuFeaturesInUse();
+}
+
+void Platform::SetCpuFeatures(const CpuFeatures& features)
+{
+    const CpuFeatures available = DetectCpuFeatures();
+    CpuFeaturesInUse().sse2 = features.sse2 && available.sse2;
+    CpuFeaturesInUse().avx2 = features.avx2 && available.avx2;
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef _WIN32
+static long long ToStampTime(const FILETIME& time)
+{
+    return (static_cast<long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+#else
+static long long ToStampTime(const struct stat& st)
+{
+#   ifdef __APPLE__
+    return st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#   else
+    return st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#   endif
+}
+#endif
+
+bool Platform::GetFileStamp(const String& filename, FileStamp& stamp)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!::GetFileAttributesExW(Utility::Widen(filename).c_str(), GetFileExInfoStandard, &info))
+        return false;
+
+    stamp.size = (static_cast<unsigned long long>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    stamp.modified = ToStampTime(info.ftLastWriteTime);
+#else
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0)
+        return false;
+
+    stamp.size = static_cast<unsigned long long>(st.st_size);
+    stamp.modified = ToStampTime(st);
+#endif
+    return true;
+}
+
+bool Platform::ListDirectory(const String& path,
+                             const std::function<bool(std::vector<DirectoryEntry>&&)>& onEntries,
+                             size_t batchSize)
+{
+    std::vector<DirectoryEntry> batch;
+    batch.reserve(batchSize);
+
+    auto isDots = [](const char* name) {
+        return name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+    };
+
+#ifdef _WIN32
+    String pattern(path);
+    if (!pattern.empty() && pattern.back() != '/' && pattern.back() != '\\')
+        pattern += '\\';
+    pattern += '*';
+
+    WIN32_FIND_DATAW data;
+    HANDLE find = ::FindFirstFileExW(Utility::Widen(pattern).c_str(), FindExInfoBasic, &data,
+                                     FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE)
+        return false;
+
+    bool more = true;
+    do
+    {
+        const String name = Utility::Narrow(data.cFileName);
+        if (isDots(name.c_str()))
+            continue;
+
+        batch.push_back(DirectoryEntry{ name,
+                                        (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 });
+        if (batch.size() >= batchSize)
+        {
+            more = onEntries(std::move(batch));
+            batch.clear();
+        }
+    } while (more && ::FindNextFileW(find, &data));
+
+    ::FindClose(find);
+#else
+    DIR* dir = ::opendir(path.c_str());
+    if (!dir)
+        return false;
+
+    String dirPath(path);
+    if (!dirPath.empty() && dirPath.back() != '/')
+        dirPath += '/';
+
+    bool more = true;
+    while (more)
+    {
+        const struct dirent* entry = ::readdir(dir);
+        if (!entry)
+            break;
+        if (isDots(entry->d_name))
+            continue;
+
+        bool isDirectory = false;
+#   ifdef DT_DIR
+        if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK)
+            isDirectory = entry->d_type == DT_DIR;
+        else
+#   endif
+        {
+            // The file system does not say, or it is a link. Follow it.
+            struct stat st;
+            isDirectory = ::stat((dirPath + entry->d_name).c_str(), &st) == 0
+                          && S_ISDIR(st.st_mode);
+        }
+
+        batch.push_back(DirectoryEntry{ entry->d_name, isDirectory });
+        if (batch.size() >= batchSize)
+        {
+            more = onEntries(std::move(batch));
+            batch.clear();
+        }
+    }
+
+    ::closedir(dir);
+#endif
+
+    if (more && !batch.empty())
+        onEntries(std::move(batch));
+    return true;
+}
+
+Platform::MappedFile::MappedFile()
+:   m_data(nullptr)
+,   m_size(0)
+,   m_mapping(nullptr)
+{}
+
+Platform::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool Platform::MappedFile::Open(const String& filename)
+{
+    Close();
+
+#ifdef _WIN32
+    const std::wstring wideName = Utility::Widen(filename);
+    HANDLE file = ::CreateFileW(wideName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    FILETIME written;
+    HANDLE mapping = nullptr;
+    if (::GetFileSizeEx(file, &size) && size.QuadPart > 0
+        && ::GetFileTime(file, nullptr, nullptr, &written))
+    {
+        mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    ::CloseHandle(file);    // the mapping keeps the file open
+
+    if (mapping == nullptr)
+        return false;
+
+    m_data = static_cast<const unsigned char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        ::CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_stamp.size = static_cast<unsigned long long>(size.QuadPart);
+    m_stamp.modified = ToStampTime(written);
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // the mapping keeps the file open
+
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<size_t>(st.st_size);
+    m_stamp.size = static_cast<unsigned long long>(st.st_size);
+    m_stamp.modified = ToStampTime(st);
+#endif
+    return true;
+}
+
+void Platform::MappedFile::Close()
+{
+    if (m_data == nullptr)
+        return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    ::munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_stamp = FileStamp();
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+    // Released resource files kept mapped. Mapped pages count towards the
+    // resident size, so large files are not kept.
+    constexpr size_t c_keptResourceFiles = 8;
+    constexpr size_t c_keptResourceBytes = 4 * 1024 * 1024;
+
+    class ResourceFileCache
+    {
+    public:
+
+        std::shared_ptr<const Platform::MappedFile> Map(const String& filename)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            std::shared_ptr<const Platform::MappedFile> file;
+            auto found = m_mapped.find(filename);
+            if (found != m_mapped.end())
+            {
+                file = found->second.lock();
+
+                // Changed on disk? Users of the old mapping keep it.
+                Platform::FileStamp stamp;
+                if (file && (!Platform::GetFileStamp(filename, stamp) || stamp != file->Stamp()))
+                {
+                    Unkeep(file);
+                    file.reset();
+                }
+            }
+
+            if (!file)
+            {
+                std::shared_ptr<Platform::MappedFile> mapped = std::make_shared<Platform::MappedFile>();
+                if (!mapped->Open(filename))
+                {
+                    m_mapped.erase(filename);
+                    return nullptr;
+                }
+                file = mapped;
+
+                // Forget files that are no longer mapped.
+                for (auto it = m_mapped.begin(); it != m_mapped.end();)
+                {
+                    if (it->second.expired())
+                        it = m_mapped.erase(it);
+                    else
+                        ++it;
+                }
+                m_mapped[filename] = file;
+            }
+
+            // Most recently used first.
+            Unkeep(file);
+            if (file->Size() <= c_keptResourceBytes)
+            {
+                m_kept.push_front(file);
+                m_keptBytes += file->Size();
+            }
+            while (m_kept.size() > c_keptResourceFiles || m_keptBytes > c_keptResourceBytes)
+            {
+                m_keptBytes -= m_kept.back()->Size();
+                m_kept.pop_back();
+            }
+
+            return file;
+        }
+
+        void Release()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_kept.clear();
+            m_keptBytes = 0;
+        }
+
+    private:
+
+        void Unkeep(const std::shared_ptr<const Platform::MappedFile>& file)
+        {
+            auto kept = std::find(m_kept.begin(), m_kept.end(), file);
+            if (kept != m_kept.end())
+            {
+                m_keptBytes -= file->Size();
+                m_kept.erase(kept);
+            }
+        }
+
+        std::mutex m_mutex;
+        std::unordered_map<String, std::weak_ptr<const Platform::MappedFile>> m_mapped;
+        std::deque<std::shared_ptr<const Platform::MappedFile>> m_kept;
+        size_t m_keptBytes = 0;
+    };
+
+    ResourceFileCache& GetResourceFileCache()
+    {
+        static ResourceFileCache cache;
+        return cache;
+    }
+}
+
+std::shared_ptr<const Platform::MappedFile> Platform::MapResourceFile(const String& filename)
+{
+    return GetResourceFileCache().Map(filename);
+}
+
+void Platform::ReleaseResourceFiles()
+{
+    GetResourceFileCache().Release();
+}
+
+//------------------------------------------------------------------------------
+
+void Platform::RunInBackground(std::function<void()> work)
+{
+    JobSystem::Get().RunInBackground(std::move(work));
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+    struct FontKey
+    {
+        String facename;
+        float size;
+        bool bold;
+
+        bool operator==(const FontKey& rhs) const
+        {
+            return facename == rhs.facename && size == rhs.size && bold == rhs.bold;
+        }
+    };
+
+    struct FontKeyHash
+    {
+        size_t operator()(const FontKey& key) const
+        {
+            size_t res = std::hash<String>{}(key.facename);
+            hash_combine(res, key.size);
+            hash_combine(res, key.bold);
+            return res;
+        }
+    };
+
+    struct HandleEntry
+    {
+        unsigned int handle;
+        unsigned int refs;      // Fonts or Textures holding the handle.
+    };
+
+    // Handles are looked up once per Font or Texture, from any thread. An
+    // entry is removed when the last object holding its handle lets go, so
+    // names no longer used do not stay in memory, and its handle is reused.
+    struct HandleTables
+    {
+        std::mutex mutex;
+        std::unordered_map<FontKey, HandleEntry, FontKeyHash> fonts;
+        std::unordered_map<String, HandleEntry> textures;
+        std::vector<unsigned int> freeFontHandles, freeTextureHandles;
+    };
+
+    HandleTables& GetHandleTables()
+    {
+        // Never destroyed, as static Fonts and Textures may outlive it.
+        static HandleTables* tables = new HandleTables;
+        return *tables;
+    }
+
+    template <typename Map, typename Key>
+    unsigned int AddRef(Map& map, std::vector<unsigned int>& freeHandles, const Key& key)
+    {
+        auto it = map.find(key);
+        if (it == map.end())
+        {
+            unsigned int handle = static_cast<unsigned int>(map.size()) + 1;
+            if (!freeHandles.empty())
+            {
+                handle = freeHandles.back();
+                freeHandles.pop_back();
+            }
+            it = map.insert(std::make_pair(key, HandleEntry{ handle, 0 })).first;
+        }
+        ++it->second.refs;
+        return it->second.handle;
+    }
+
+    template <typename Map, typename Key>
+    void Release(Map& map, std::vector<unsigned int>& freeHandles, const Key& key)
+    {
+        auto it = map.find(key);
+        if (it != map.end() && --it->second.refs == 0)
+        {
+            freeHandles.push_back(it->second.handle);
+            map.erase(it);
+        }
+    }
+}
+
+unsigned int Font::Intern() const
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    // Interned by another thread while this one waited?
+    unsigned int handle = m_handle.load(std::memory_order_relaxed);
+    if (handle == 0)
+    {
+        handle = AddRef(tables.fonts, tables.freeFontHandles, FontKey{ m_facename, m_size, m_bold });
+        m_handle.store(handle, std::memory_order_relaxed);
+    }
+    return handle;
+}
+
+void Font::AddHandleRef()
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    m_handle.store(AddRef(tables.fonts, tables.freeFontHandles,
+                          FontKey{ m_facename, m_size, m_bold }),
+                   std::memory_order_relaxed);
+}
+
+void Font::ReleaseHandle()
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    Release(tables.fonts, tables.freeFontHandles, FontKey{ m_facename, m_size, m_bold });
+    m_handle.store(0, std::memory_order_relaxed);
+}
+
+unsigned int Texture::Intern() const
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    // Interned by another thread while this one waited?
+    unsigned int handle = m_handle.load(std::memory_order_relaxed);
+    if (handle == 0)
+    {
+        handle = AddRef(tables.textures, tables.freeTextureHandles, m_name);
+        m_handle.store(handle, std::memory_order_relaxed);
+    }
+    return handle;
+}
+
+void Texture::AddHandleRef()
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    m_handle.store(AddRef(tables.textures, tables.freeTextureHandles, m_name),
+                   std::memory_order_relaxed);
+}
+
+void Texture::ReleaseHandle()
+{
+    HandleTables& tables = GetHandleTables();
+    std::lock_guard<std::mutex> lock(tables.mutex);
+
+    Release(tables.textures, tables.freeTextureHandles, m_name);
+    m_handle.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
 namespace Gwk { namespace Platform {
     extern void DefaultLogListener(Log::Level lvl, const char *message);
 }}
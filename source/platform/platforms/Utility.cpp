@@ -10,9 +10,18 @@
  */
 
 #include <Gwork/Utility.h>
+#include <Gwork/PlatformCommon.h>
 
 #include <cstdio>
 
+#if GWK_SIMD
+#   include <emmintrin.h>   // SSE2
+#   include <immintrin.h>   // AVX2
+#   if defined(_MSC_VER)
+#       include <intrin.h>  // _BitScanForward
+#   endif
+#endif
+
 // codecvt causes problems due to different standard libraries implementing at different times.
 //  - libstdc++ looks like it didn't support codecvt until at least GCC 5.2.
 //  - Apple has good support (but defined __GNUC__ ?!)
@@ -258,6 +267,195 @@ bool Strings::To::Floats(const Gwk::String& str, float* f, size_t iCount)
     return true;
 }
 
+namespace {
+
+constexpr char32_t c_invalidCodepoint = 0xffffffff;
+
+//! Decode the multi-byte sequence at s. Returns the number of bytes consumed.
+//! cp is set to c_invalidCodepoint if the sequence is malformed.
+inline size_t DecodeUtf8Sequence(const unsigned char* s, const unsigned char* end,
+                                 char32_t& cp)
+{
+    const unsigned char lead = s[0];
+    size_t len;
+    char32_t minimum;
+
+    cp = c_invalidCodepoint;
+    if (lead < 0xc0)
+        return 1;           // stray continuation byte
+    else if (lead < 0xe0)
+        len = 2, minimum = 0x80, cp = lead & 0x1f;
+    else if (lead < 0xf0)
+        len = 3, minimum = 0x800, cp = lead & 0x0f;
+    else if (lead < 0xf8)
+        len = 4, minimum = 0x10000, cp = lead & 0x07;
+    else
+        return 1;
+
+    if (static_cast<size_t>(end - s) < len)
+    {
+        cp = c_invalidCodepoint;
+        return 1;
+    }
+
+    for (size_t i = 1; i < len; ++i)
+    {
+        if ((s[i] & 0xc0) != 0x80)
+        {
+            cp = c_invalidCodepoint;
+            return 1;
+        }
+        cp = (cp << 6) | (s[i] & 0x3f);
+    }
+
+    // Reject overlong encodings, surrogates and values outside Unicode.
+    if (cp < minimum || cp > 0x10ffff || (cp >= 0xd800 && cp < 0xe000))
+        cp = c_invalidCodepoint;
+
+    return len;
+}
+
+size_t DecodeUtf8Scalar(const unsigned char* s, const unsigned char* end, char32_t* out)
+{
+    char32_t* o = out;
+    while (s < end)
+    {
+        if (*s < 0x80)
+        {
+            *o++ = *s++;
+            continue;
+        }
+
+        char32_t cp;
+        s += DecodeUtf8Sequence(s, end, cp);
+        if (cp != c_invalidCodepoint)
+            *o++ = cp;
+    }
+    return o - out;
+}
+
+#if GWK_SIMD
+
+inline int CountTrailingZeros(unsigned int mask)
+{
+#   if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#   else
+    return __builtin_ctz(mask);
+#   endif
+}
+
+GWK_TARGET_SSE2
+size_t DecodeUtf8SSE2(const unsigned char* s, const unsigned char* end, char32_t* out)
+{
+    char32_t* o = out;
+    const __m128i zero = _mm_setzero_si128();
+
+    while (end - s >= 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+        const unsigned int nonAscii = _mm_movemask_epi8(bytes);
+
+        if (nonAscii == 0)
+        {
+            // 16 ASCII characters: zero extend bytes to 32 bits.
+            const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+            __m128i* dst = reinterpret_cast<__m128i*>(o);
+            _mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+            s += 16;
+            o += 16;
+            continue;
+        }
+
+        // Copy the ASCII prefix, then decode the sequence that stopped us.
+        for (int i = CountTrailingZeros(nonAscii); i > 0; --i)
+            *o++ = *s++;
+
+        char32_t cp;
+        s += DecodeUtf8Sequence(s, end, cp);
+        if (cp != c_invalidCodepoint)
+            *o++ = cp;
+    }
+
+    return (o - out) + DecodeUtf8Scalar(s, end, o);
+}
+
+GWK_TARGET_AVX2
+size_t DecodeUtf8AVX2(const unsigned char* s, const unsigned char* end, char32_t* out)
+{
+    char32_t* o = out;
+
+    while (end - s >= 32)
+    {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        const unsigned int nonAscii = _mm256_movemask_epi8(bytes);
+
+        if (nonAscii == 0)
+        {
+            // 32 ASCII characters: zero extend each group of 8 bytes to 32 bits.
+            __m256i* dst = reinterpret_cast<__m256i*>(o);
+            for (int i = 0; i < 4; ++i)
+            {
+                const __m128i eight = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + i*8));
+                _mm256_storeu_si256(dst + i, _mm256_cvtepu8_epi32(eight));
+            }
+            s += 32;
+            o += 32;
+            continue;
+        }
+
+        for (int i = CountTrailingZeros(nonAscii); i > 0; --i)
+            *o++ = *s++;
+
+        char32_t cp;
+        s += DecodeUtf8Sequence(s, end, cp);
+        if (cp != c_invalidCodepoint)
+            *o++ = cp;
+    }
+
+    // Avoid the AVX to SSE transition penalty in the SSE2 tail.
+    _mm256_zeroupper();
+    return (o - out) + DecodeUtf8SSE2(s, end, o);
+}
+
+#endif // GWK_SIMD
+
+} // namespace
+
+size_t Strings::DecodeUtf8(const char* in, size_t len, char32_t* out)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(in);
+
+#if GWK_SIMD
+    // Most strings, like labels, are shorter than a vector, so the vector
+    // loops would only pass them on to the scalar one.
+    if (len < 16)
+        return DecodeUtf8Scalar(s, s + len, out);
+
+    const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+    if (cpu.avx2)
+        return DecodeUtf8AVX2(s, s + len, out);
+    if (cpu.sse2)
+        return DecodeUtf8SSE2(s, s + len, out);
+#endif
+
+    return DecodeUtf8Scalar(s, s + len, out);
+}
+
+void Strings::DecodeUtf8(const Gwk::String& str, std::u32string& out)
+{
+    // Only grow the buffer, so reusing it does not clear it every time.
+    if (out.size() < str.size())
+        out.resize(str.size());
+    out.resize(DecodeUtf8(str.data(), str.size(), &out[0]));
+}
+
 bool Strings::Wildcard(const String& strWildcard, const String& strHaystack)
 {
     const String& W = strWildcard;
@@ -120,10 +120,10 @@ Font::Status Allegro::LoadFont(const Font& font)
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.facename);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
 
     ALLEGRO_FONT* afont = al_load_font(filename.c_str(),
-                                       font.size * Scale(),
+                                       font.GetSize() * Scale(),
                                        ALLEGRO_TTF_NO_KERNING);
 
     if (afont)
@@ -174,7 +174,7 @@ Texture::Status Allegro::LoadTexture(const Texture& texture)
 {
     FreeTexture(texture);
     m_lastTexture = nullptr;
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
     ALLEGRO_BITMAP* bmp = al_load_bitmap(filename.c_str());
 
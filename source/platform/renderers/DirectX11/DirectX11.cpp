@@ -6,6 +6,7 @@
  */
 
 #include <Gwork/Renderers/DirectX11.h>
+#include <Gwork/DiskCache.h>
 #include <Gwork/PlatformCommon.h>
 #include <Gwork/Utility.h>
 
@@ -13,8 +14,6 @@
 #include <d3d11.h>
 #include <d3dcompiler.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <Gwork\External\stb_image.h>
 #define STB_TRUETYPE_IMPLEMENTATION
 #define STBTT_STATIC
 #include <Gwork/External/stb_truetype.h>
@@ -34,6 +33,11 @@ using namespace DirectX;    // for XNAMATH vectors etc
 #define D3DCOLOR_COLORVALUE(r,g,b,a) \
     D3DCOLOR_ARGB((DWORD)((a)*255.f), (DWORD)((r)*255.f),(DWORD)((g)*255.f),(DWORD)((b)*255.f))
 
+static inline size_t ImageBytes(const TextureData& texData)
+{
+    return static_cast<size_t>(texData.width) * static_cast<size_t>(texData.height) * 4;
+}
+
 #pragma region Shaders
 static const char pixshader[] =R"(
 sampler samp0 : register(s0);
@@ -136,21 +140,21 @@ Font::Status DirectX11::LoadFont(const Font& font)
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const float realsize = font.size * Scale();
+    const float realsize = font.GetSize() * Scale();
     HDC hDC = CreateCompatibleDC(nullptr);
     DWORD texWidth = 2048, texHeight;
     SetMapMode(hDC, MM_TEXT);
 
     LOGFONTW fd;
     memset(&fd, 0, sizeof(fd));
-    wcscpy_s(fd.lfFaceName, LF_FACESIZE, Utility::Widen(font.facename).c_str());
+    wcscpy_s(fd.lfFaceName, LF_FACESIZE, Utility::Widen(font.GetFacename()).c_str());
     fd.lfWidth = 0;
 
     fd.lfCharSet = DEFAULT_CHARSET;
     fd.lfHeight = realsize * -1.0f;
     fd.lfOutPrecision = OUT_DEFAULT_PRECIS;
     fd.lfItalic = 0;
-    fd.lfWeight = font.bold ? FW_BOLD : FW_NORMAL;
+    fd.lfWeight = font.IsBold() ? FW_BOLD : FW_NORMAL;
 #ifdef CLEARTYPE_QUALITY
     fd.lfQuality = realsize < 14 ? DEFAULT_QUALITY : CLEARTYPE_QUALITY;
 #else
@@ -162,7 +166,7 @@ Font::Status DirectX11::LoadFont(const Font& font)
 
     if (!hFont)
     {
-        Gwk::Log::Write(Log::Level::Error, "Font file not found: %s", font.facename.c_str());
+        Gwk::Log::Write(Log::Level::Error, "Font file not found: %s", font.GetFacename().c_str());
         return Font::Status::ErrorFileNotFound;
     }
 
@@ -236,6 +240,7 @@ Font::Status DirectX11::LoadFont(const Font& font)
     }
 
     fontData.m_Spacing = spacing;
+    fontData.renderScale = Scale();
     fontData.width = texWidth;
     fontData.height = texHeight;
 
@@ -312,6 +317,31 @@ void DirectX11::FreeFont(const Font& font)
         m_lastFont = nullptr;
 
     m_fonts.erase(font); // calls DxFontData destructor
+    m_otherScaleFonts.erase(font);
+}
+
+bool DirectX11::RescaleFont(const Font& font)
+{
+    m_lastFont = nullptr;
+
+    auto it = m_fonts.find(font);
+    DxFontData current(std::move(it->second));
+    m_fonts.erase(it);
+
+    // Switched back to the scale before?
+    auto other = m_otherScaleFonts.find(font);
+    if (other != m_otherScaleFonts.end() && other->second.renderScale == Scale())
+    {
+        m_lastFont = &(*m_fonts.insert(std::make_pair(font, std::move(other->second))).first);
+        m_otherScaleFonts.erase(other);
+        m_otherScaleFonts.insert(std::make_pair(font, std::move(current)));
+        return true;
+    }
+
+    // LoadFont frees the font at any other scale.
+    const bool loaded = LoadFont(font) == Font::Status::Loaded;
+    m_otherScaleFonts.insert(std::make_pair(font, std::move(current)));
+    return loaded;
 }
 
 bool DirectX11::EnsureFont(const Font& font)
@@ -319,7 +349,7 @@ bool DirectX11::EnsureFont(const Font& font)
     if (m_lastFont != nullptr)
     {
         if (m_lastFont->first == font)
-            return true;
+            return m_lastFont->second.renderScale == Scale() || RescaleFont(font);
     }
 
     // Was it loaded before?
@@ -327,7 +357,7 @@ bool DirectX11::EnsureFont(const Font& font)
     if (it != m_fonts.end())
     {
         m_lastFont = &(*it);
-        return true;
+        return it->second.renderScale == Scale() || RescaleFont(font);
     }
 
     // No, try load to it
@@ -341,21 +371,23 @@ Texture::Status DirectX11::LoadTexture(const Texture& texture)
     FreeTexture(texture);
     m_lastTexture = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
-    DxTextureData texData;
-
-    int width, height, n;
-    {
-        unsigned char *image = stbi_load(filename.c_str(), &width, &height, &n, 4);
-        texData.m_ReadData = deleted_unique_ptr<unsigned char>(image, [](unsigned char* mem) { if (mem) stbi_image_free(mem); });
-    }
+    int width, height;
+    deleted_unique_ptr<const unsigned char> pixels =
+        DiskCache::DecodeImage(filename, "rgba8", width, height);
 
-    if (!texData.m_ReadData)
-    {
-        Gwk::Log::Write(Log::Level::Error, "Texture file not found: %s", filename.c_str());
+    if (!pixels)
         return Texture::Status::ErrorFileNotFound;
-    }
+
+    return CreateTexture(texture, width, height, std::move(pixels));
+}
+
+Texture::Status DirectX11::CreateTexture(const Texture& texture, int width, int height,
+                                         deleted_unique_ptr<const unsigned char> pixels)
+{
+    DxTextureData texData;
+    texData.m_ReadData = std::move(pixels);
 
     D3D11_TEXTURE2D_DESC desc;
     ZeroMemory(&desc, sizeof(desc));
@@ -373,7 +405,7 @@ Texture::Status DirectX11::LoadTexture(const Texture& texture)
 
     D3D11_SUBRESOURCE_DATA subres;
     subres.pSysMem = texData.m_ReadData.get();
-    subres.SysMemPitch = width * n;
+    subres.SysMemPitch = width * 4;
     subres.SysMemSlicePitch = 0;
 
 
@@ -399,15 +431,50 @@ Texture::Status DirectX11::LoadTexture(const Texture& texture)
     texData.width = width;
     texData.height = height;
     m_lastTexture = &(*m_textures.insert(std::make_pair(texture, std::move(texData))).first);
+    m_textureBudget.Loaded(texture, m_lastTexture->second.budget,
+                           ImageBytes(m_lastTexture->second) * (texture.readable ? 2 : 1));
     return Texture::Status::Loaded;
 }
 
+Base::TextureDecoder DirectX11::GetTextureDecoder(const Texture& texture)
+{
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
+
+    return [this, texture, filename]() -> TextureFinisher
+    {
+        int width = 0, height = 0;
+        auto pixels = std::make_shared<deleted_unique_ptr<const unsigned char>>(
+            DiskCache::DecodeImage(filename, "rgba8", width, height));
+
+        // The D3D texture is made on the render thread.
+        return [this, texture, pixels, width, height]() -> Texture::Status
+        {
+            FreeTexture(texture);
+            m_lastTexture = nullptr;
+
+            if (!*pixels)
+                return Texture::Status::ErrorFileNotFound;
+
+            return CreateTexture(texture, width, height, std::move(*pixels));
+        };
+    };
+}
+
 void DirectX11::FreeTexture(const Gwk::Texture& texture)
 {
     if (m_lastTexture != nullptr && m_lastTexture->first == texture)
         m_lastTexture = nullptr;
 
-    m_textures.erase(texture); // calls DxTextureData destructor
+    auto it = m_textures.find(texture);
+    if (it == m_textures.end())
+        return;
+
+    // A texture made later may get the same address.
+    if (m_pCurrentTexture == it->second.m_TextureResource)
+        m_pCurrentTexture = nullptr;
+
+    m_textureBudget.Freed(it->second.budget);
+    m_textures.erase(it); // calls DxTextureData destructor
 }
 
 TextureData DirectX11::GetTextureData(const Texture& texture) const
@@ -429,7 +496,10 @@ bool DirectX11::EnsureTexture(const Gwk::Texture& texture)
     if (m_lastTexture != nullptr)
     {
         if (m_lastTexture->first == texture)
+        {
+            m_textureBudget.Used(m_lastTexture->second.budget);
             return true;
+        }
     }
 
     // Was it loaded before?
@@ -437,6 +507,7 @@ bool DirectX11::EnsureTexture(const Gwk::Texture& texture)
     if (it != m_textures.end())
     {
         m_lastTexture = &(*it);
+        m_textureBudget.Used(it->second.budget);
         return true;
     }
 
@@ -452,6 +523,7 @@ DirectX11::DirectX11(ResourcePaths& paths, ID3D11Device* pDevice)
     ,   m_Buffer(256)
     ,   m_lastFont(nullptr)
     ,   m_lastTexture(nullptr)
+    ,   m_readBackCopies(false)
 {
     m_Valid = false;
 
@@ -640,6 +712,26 @@ void DirectX11::End()
     GwkDxSafeRelease(m_LastPSShader);
     GwkDxSafeRelease(m_LastGSShader);
     GwkDxSafeRelease(m_LastVSShader);
+
+    // Copies read back by PixelColor() are only kept for the frame.
+    if (m_readBackCopies)
+    {
+        for (auto& texture : m_textures)
+        {
+            DxTextureData& texData = texture.second;
+            if (!texData.readable && texData.m_ReadData)
+            {
+                texData.m_ReadData.reset();
+                m_textureBudget.Resized(texData.budget,
+                                        texData.budget.bytes - ImageBytes(texData));
+            }
+        }
+        m_readBackCopies = false;
+    }
+
+    m_textureBudget.FreeLeastRecentlyUsed(m_textures,
+                                          [this](const Texture& texture) { FreeTexture(texture); });
+    m_textureBudget.EndFrame();
 }
 
 void DirectX11::Present()
@@ -715,8 +807,8 @@ void DirectX11::RenderText(const Gwk::Font& font, Gwk::Point pos, const Gwk::Str
 
     float fStartX = loc.x;
 
-    char* text_ptr = const_cast<char*>(text.c_str());
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
         const auto c = wide_char - BeginCharacter;
         if (wide_char == NewLineCharacter)
@@ -768,8 +860,8 @@ Gwk::Point DirectX11::MeasureText(const Gwk::Font& font, const Gwk::String& text
     float fWidth = 0.0f;
     float fHeight = fRowHeight;
 
-    char* text_ptr = const_cast<char*>(text.c_str());
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
         const auto c = wide_char - BeginCharacter;
         if (wide_char == NewLineCharacter)
@@ -866,9 +958,9 @@ Gwk::Color DirectX11::PixelColor(const Gwk::Texture& texture, unsigned int x, un
     
     DxTextureData& texData = m_lastTexture->second;
 
-    if (texData.readable)
+    if (texData.m_ReadData)
     {
-        unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * 4;
+        const unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * 4;
         return Gwk::Color(pPixel[0], pPixel[1], pPixel[2], pPixel[3]);
     }
 
@@ -915,12 +1007,13 @@ Gwk::Color DirectX11::PixelColor(const Gwk::Texture& texture, unsigned int x, un
         return col_default;
     }
 
-    texData.m_ReadData = deleted_unique_ptr<unsigned char>(new unsigned char[tdesc.Width * tdesc.Height * 4], [](unsigned char* mem) { if (mem) delete [] (mem); });
-    texData.readable = true;
-
     DWORD* pixels = (DWORD*)msr.pData;
     DWORD color = pixels[msr.RowPitch / 4 * y + x];
-    memcpy(texData.m_ReadData.get(), pixels, tdesc.Width * tdesc.Height * 4);
+    unsigned char* readBack = new unsigned char[tdesc.Width * tdesc.Height * 4];
+    memcpy(readBack, pixels, tdesc.Width * tdesc.Height * 4);
+    texData.m_ReadData = deleted_unique_ptr<const unsigned char>(readBack, [](const unsigned char* mem) { delete[] mem; });
+    m_textureBudget.Resized(texData.budget, texData.budget.bytes + ImageBytes(texData));
+    m_readBackCopies = true;
     m_pContext->Unmap(stagingTexture, 0);
 
     stagingTexture->Release();
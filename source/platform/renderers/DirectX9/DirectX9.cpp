@@ -128,10 +128,10 @@ void DirectX9::LoadFont(Gwk::Font* font)
 {
     m_fontList.push_back(font);
     // Scale the font according to canvas
-    font->realsize = font->size*Scale();
+    font->realsize = font->GetSize()*Scale();
     D3DXFONT_DESC fd;
     memset(&fd, 0, sizeof(fd));
-    const std::wstring wfontname( Utility::Widen(font->facename) );
+    const std::wstring wfontname( Utility::Widen(font->GetFacename()) );
     wcscpy_s(fd.FaceName, LF_FACESIZE, wfontname.c_str());
     fd.Width = 0;
     fd.MipLevels = 1;
@@ -139,7 +139,7 @@ void DirectX9::LoadFont(Gwk::Font* font)
     fd.Height = font->realsize* -1.0f;
     fd.OutputPrecision = OUT_DEFAULT_PRECIS;
     fd.Italic = 0;
-    fd.Weight = font->bold ? FW_BOLD : FW_NORMAL;
+    fd.Weight = font->IsBold() ? FW_BOLD : FW_NORMAL;
 #ifdef CLEARTYPE_QUALITY
     fd.Quality = font->realsize < 14 ? DEFAULT_QUALITY : CLEARTYPE_QUALITY;
 #else
@@ -192,7 +192,7 @@ void DirectX9::RenderText(Gwk::Font* font, Gwk::Point pos,
     Flush();
 
     // If the font doesn't exist, or the font size should be changed
-    if (!font->data || fabs(font->realsize-font->size*Scale()) > 2)
+    if (!font->data || fabs(font->realsize-font->GetSize()*Scale()) > 2)
     {
         FreeFont(font);
         LoadFont(font);
@@ -211,7 +211,7 @@ void DirectX9::RenderText(Gwk::Font* font, Gwk::Point pos,
 Gwk::Point DirectX9::MeasureText(Gwk::Font* font, const Gwk::String& text)
 {
     // If the font doesn't exist, or the font size should be changed
-    if (!font->data || fabs(font->realsize-font->size*Scale()) > 2)
+    if (!font->data || fabs(font->realsize-font->GetSize()*Scale()) > 2)
     {
         FreeFont(font);
         LoadFont(font);
@@ -291,7 +291,7 @@ void DirectX9::LoadTexture(Gwk::Texture* texture)
 {
     IDirect3DTexture9* ptr = nullptr;
     D3DXIMAGE_INFO ImageInfo;
-    const std::wstring wtexName( Utility::Widen(texture->name) );
+    const std::wstring wtexName( Utility::Widen(texture->GetName()) );
     HRESULT hr = D3DXCreateTextureFromFileExW(m_device,
                                               wtexName.c_str(),
                                               0, 0, D3DX_DEFAULT, 0, D3DFMT_UNKNOWN,
@@ -0,0 +1,329 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/DiskCache.h>
+#include <Gwork/Utility.h>
+
+//#define STBI_ASSERT(x)  // comment in for no asserts
+#define STB_IMAGE_IMPLEMENTATION
+#include <Gwork/External/stb_image.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#endif
+
+namespace Gwk
+{
+namespace Renderer
+{
+
+// Start of every cache file. Followed by the variant, then the data, each
+// padded to c_dataAlignment.
+struct FileHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceSize;
+    std::int64_t sourceModified;
+    std::uint64_t sourceHash;
+    std::uint64_t dataSize;
+    std::uint32_t variantSize;
+    std::uint32_t reserved;
+};
+
+// Prefix of image data.
+struct ImageHeader
+{
+    std::uint32_t width, height;
+    std::uint32_t reserved[2];
+};
+
+static const char c_magic[4] = { 'G', 'W', 'K', 'C' };
+static constexpr size_t c_dataAlignment = 16;
+
+static std::mutex g_directoryMutex;
+static String g_directory;
+
+static inline size_t Aligned(size_t size)
+{
+    return (size + c_dataAlignment - 1) & ~(c_dataAlignment - 1);
+}
+
+static std::uint64_t Hash(const unsigned char* data, size_t size)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static String GetDirectory()
+{
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+    return g_directory;
+}
+
+// Path of the file holding an entry.
+static String EntryPath(const String& directory, const String& source, const String& variant)
+{
+    const String key = source + '\n' + variant;
+    const std::uint64_t hash = Hash(reinterpret_cast<const unsigned char*>(key.data()),
+                                    key.size());
+    return directory + Utility::Format("%016llx.gwkc", static_cast<unsigned long long>(hash));
+}
+
+static std::FILE* OpenFile(const String& filename, const char* mode)
+{
+#ifdef _WIN32
+    return ::_wfopen(Utility::Widen(filename).c_str(), Utility::Widen(mode).c_str());
+#else
+    return std::fopen(filename.c_str(), mode);
+#endif
+}
+
+static bool ReplaceFile(const String& from, const String& to)
+{
+#ifdef _WIN32
+    return ::MoveFileExW(Utility::Widen(from).c_str(), Utility::Widen(to).c_str(),
+                         MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// Hash the current contents of a source file.
+static bool HashSource(const String& source, std::uint64_t& hash)
+{
+    std::shared_ptr<const Platform::MappedFile> file = Platform::MapResourceFile(source);
+    if (!file)
+        return false;
+
+    hash = Hash(file->Data(), file->Size());
+    return true;
+}
+
+// Write an entry made of two parts, so image headers need not be copied
+// in front of the pixels.
+static bool Write(const String& source, const String& variant,
+                  const void* prefix, size_t prefixSize, const void* data, size_t size)
+{
+    const String directory = GetDirectory();
+    if (directory.empty())
+        return false;
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, c_magic, sizeof(c_magic));
+    header.version = DiskCache::FormatVersion;
+    header.dataSize = prefixSize + size;
+    header.variantSize = static_cast<std::uint32_t>(variant.size());
+
+    // Stamp first, so a source changed while hashing does not match.
+    Platform::FileStamp stamp;
+    if (!Platform::GetFileStamp(source, stamp) || !HashSource(source, header.sourceHash))
+        return false;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+
+    // Written under another name, so other processes never read half a file.
+    static std::atomic<unsigned int> s_counter(0);
+    const String path = EntryPath(directory, source, variant);
+    const String temporary = path + Utility::Format(".%llx.%u",
+        static_cast<unsigned long long>(
+            std::chrono::steady_clock::now().time_since_epoch().count()),
+        s_counter++);
+
+    std::FILE* file = OpenFile(temporary, "wb");
+    if (!file)
+    {
+        Gwk::Log::Write(Log::Level::Warning, "Cannot write cache file: %s", temporary.c_str());
+        return false;
+    }
+
+    static const char padding[c_dataAlignment] = {};
+    const size_t variantPadding = Aligned(sizeof(header) + variant.size())
+                                  - sizeof(header) - variant.size();
+
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+                   && std::fwrite(variant.data(), 1, variant.size(), file) == variant.size()
+                   && std::fwrite(padding, 1, variantPadding, file) == variantPadding
+                   && (prefixSize == 0 || std::fwrite(prefix, 1, prefixSize, file) == prefixSize)
+                   && std::fwrite(data, 1, size, file) == size;
+    written = std::fclose(file) == 0 && written;
+
+    if (!written || !ReplaceFile(temporary, path))
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+void DiskCache::SetDirectory(const String& directory)
+{
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+
+    g_directory = directory;
+    if (!g_directory.empty() && g_directory.back() != '/' && g_directory.back() != '\\')
+        g_directory += '/';
+}
+
+bool DiskCache::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(g_directoryMutex);
+    return !g_directory.empty();
+}
+
+DiskCache::Entry DiskCache::Find(const String& source, const String& variant)
+{
+    Entry entry;
+
+    const String directory = GetDirectory();
+    if (directory.empty())
+        return entry;
+
+    const String path = EntryPath(directory, source, variant);
+    std::shared_ptr<Platform::MappedFile> file = std::make_shared<Platform::MappedFile>();
+    if (!file->Open(path))
+        return entry;
+
+    FileHeader header;
+    const size_t dataStart = Aligned(sizeof(header) + variant.size());
+    if (file->Size() < sizeof(header))
+        return entry;
+    std::memcpy(&header, file->Data(), sizeof(header));
+
+    if (std::memcmp(header.magic, c_magic, sizeof(c_magic)) != 0
+        || header.version != FormatVersion
+        || header.variantSize != variant.size()
+        || file->Size() < dataStart || file->Size() - dataStart < header.dataSize
+        || std::memcmp(file->Data() + sizeof(header), variant.data(), variant.size()) != 0)
+    {
+        return entry;
+    }
+
+    Platform::FileStamp stamp;
+    if (!Platform::GetFileStamp(source, stamp))
+        return entry;
+
+    if (stamp.size != header.sourceSize || stamp.modified != header.sourceModified)
+    {
+        // Touched, e.g. copied again, but maybe not changed.
+        std::uint64_t hash;
+        if (stamp.size != header.sourceSize || !HashSource(source, hash)
+            || hash != header.sourceHash)
+        {
+            return entry;
+        }
+
+        // Update the stamp so the source is not hashed next time.
+        file->Close();
+        header.sourceModified = stamp.modified;
+        if (std::FILE* update = OpenFile(path, "r+b"))
+        {
+            std::fwrite(&header, sizeof(header), 1, update);
+            std::fclose(update);
+        }
+        if (!file->Open(path) || file->Size() < dataStart
+            || file->Size() - dataStart < header.dataSize)
+        {
+            return entry;
+        }
+    }
+
+    entry.m_data = file->Data() + dataStart;
+    entry.m_size = static_cast<size_t>(header.dataSize);
+    entry.m_file = std::move(file);
+    return entry;
+}
+
+bool DiskCache::Store(const String& source, const String& variant,
+                      const void* data, size_t size)
+{
+    return Write(source, variant, nullptr, 0, data, size);
+}
+
+DiskCache::Entry DiskCache::FindImage(const String& source, const String& variant,
+                                      int& width, int& height)
+{
+    Entry entry = Find(source, variant);
+    if (!entry)
+        return entry;
+
+    ImageHeader header;
+    if (entry.m_size >= sizeof(header))
+    {
+        std::memcpy(&header, entry.m_data, sizeof(header));
+        entry.m_data += sizeof(header);
+        entry.m_size -= sizeof(header);
+
+        if (header.width > 0 && header.height > 0
+            && entry.m_size == static_cast<size_t>(header.width) * header.height * 4)
+        {
+            width = static_cast<int>(header.width);
+            height = static_cast<int>(header.height);
+            return entry;
+        }
+    }
+
+    return Entry();
+}
+
+bool DiskCache::StoreImage(const String& source, const String& variant,
+                           int width, int height, const unsigned char* pixels)
+{
+    ImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+
+    return Write(source, variant, &header, sizeof(header),
+                 pixels, static_cast<size_t>(width) * height * 4);
+}
+
+DiskCache::ImagePixels DiskCache::DecodeImage(const String& filename, const String& variant,
+                                              int& width, int& height,
+                                              const ImagePrepare& prepare)
+{
+    Entry cached = FindImage(filename, variant, width, height);
+    if (cached)
+        return ImagePixels(cached.Data(), [cached](const unsigned char*) {});
+
+    int n;
+    unsigned char* image = stbi_load(filename.c_str(), &width, &height, &n, 4);
+    if (!image)
+    {
+        Gwk::Log::Write(Log::Level::Error, "Texture file not found: %s", filename.c_str());
+        return ImagePixels();
+    }
+
+    if (prepare)
+        prepare(image, width, height);
+
+    StoreImage(filename, variant, width, height, image);
+    return ImagePixels(image, [](const unsigned char* mem) {
+                           stbi_image_free(const_cast<unsigned char*>(mem));
+                       });
+}
+
+} // namespace Renderer
+} // namespace Gwk
@@ -0,0 +1,651 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/GlyphCache.h>
+#include <Gwork/PlatformCommon.h>
+#include <Gwork/Utility.h>
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#include <Gwork/External/stb_truetype.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace Gwk
+{
+namespace Renderer
+{
+
+FontFace::FontFace()
+    :   m_info(new stbtt_fontinfo)
+{
+}
+
+FontFace::~FontFace()
+{
+}
+
+// Faces loaded, by path. Guarded as fonts may be loaded from other threads.
+static std::mutex g_facesMutex;
+static std::unordered_map<String, std::shared_ptr<FontFace>> g_faces;
+
+std::shared_ptr<FontFace> FontFace::Load(const String& filename, Font::Status& status)
+{
+    std::lock_guard<std::mutex> lock(g_facesMutex);
+
+    auto found = g_faces.find(filename);
+    if (found != g_faces.end())
+    {
+        status = Font::Status::Loaded;
+        return found->second;
+    }
+
+    std::shared_ptr<FontFace> face(new FontFace);
+
+    face->m_filename = filename;
+    face->m_file = Platform::MapResourceFile(filename);
+    if (!face->m_file)
+    {
+        Gwk::Log::Write(Log::Level::Error, "Font file not found: %s", filename.c_str());
+        status = Font::Status::ErrorFileNotFound;
+        return nullptr;
+    }
+
+    const unsigned char* data = face->m_file->Data();
+    const int offset = stbtt_GetFontOffsetForIndex(data, 0);
+
+    if (offset < 0 || !stbtt_InitFont(face->m_info.get(), data, offset))
+    {
+        Gwk::Log::Write(Log::Level::Error, "Font file is not valid: %s", filename.c_str());
+        status = Font::Status::ErrorBadData;
+        return nullptr;
+    }
+
+    g_faces[filename] = face;
+    status = Font::Status::Loaded;
+    return face;
+}
+
+void FontFace::ReleaseUnused()
+{
+    std::lock_guard<std::mutex> lock(g_facesMutex);
+
+    for (auto it = g_faces.begin(); it != g_faces.end();)
+    {
+        if (it->second.use_count() == 1)
+            it = g_faces.erase(it);
+        else
+            ++it;
+    }
+}
+
+float FontFace::ScaleForPixelHeight(float pixelHeight) const
+{
+    return stbtt_ScaleForPixelHeight(m_info.get(), pixelHeight);
+}
+
+//-------------------------------------------------------------------------------
+
+// Gap left between glyphs so that filtered texture lookups do not bleed.
+static constexpr int c_glyphPadding = 1;
+
+static inline unsigned long long GlyphKey(GlyphCache::FontId font, char32_t codepoint)
+{
+    return (static_cast<unsigned long long>(font) << 32) | codepoint;
+}
+
+// A glyph saved in the disk cache. Followed by its pixels, padded to 4 bytes.
+struct SavedGlyph
+{
+    std::uint32_t codepoint;
+    std::int16_t width, height;
+    std::int16_t offsetX, offsetY;
+    float advance;
+};
+
+static inline size_t SavedGlyphSize(const SavedGlyph& saved)
+{
+    return sizeof(SavedGlyph) + ((static_cast<size_t>(saved.width) * saved.height + 3) & ~3);
+}
+
+// Append a glyph and its pixels, in rows \p stride bytes apart, to saved glyphs.
+static void AppendSavedGlyph(std::vector<unsigned char>& glyphs, const SavedGlyph& record,
+                             const unsigned char* pixels, int stride)
+{
+    const size_t start = glyphs.size();
+    glyphs.resize(start + SavedGlyphSize(record), 0);
+    std::memcpy(&glyphs[start], &record, sizeof(record));
+    for (int y = 0; y < record.height; ++y)
+    {
+        std::memcpy(&glyphs[start + sizeof(record) + y * record.width],
+                    pixels + y * stride, record.width);
+    }
+}
+
+// Name of the glyphs of a font file in the disk cache.
+static String SavedGlyphsVariant(float pixelHeight, GlyphCache::Format format)
+{
+    if (format == GlyphCache::Format::DistanceField)
+    {
+        return Utility::Format("glyphs sdf %.3f %d %d", pixelHeight,
+                               GlyphCache::SdfPadding, GlyphCache::SdfOnEdge);
+    }
+    return Utility::Format("glyphs %.3f", pixelHeight);
+}
+
+GlyphCache::GlyphCache(Point pageSize, size_t memoryLimit)
+    :   m_pageSize(pageSize)
+    ,   m_memoryLimit(memoryLimit)
+    ,   m_clock(0)
+    ,   m_nextFontId(1)
+{
+}
+
+GlyphCache::~GlyphCache()
+{
+    SaveGlyphs();
+}
+
+GlyphCache::FontId GlyphCache::AddFont(std::shared_ptr<const FontFace> face, float pixelHeight,
+                                       Format format)
+{
+    for (auto& font : m_fonts)
+    {
+        FontEntry& added = font.second;
+        if (added.face == face && added.pixelHeight == pixelHeight && added.format == format)
+        {
+            ++added.adds;
+            return font.first;
+        }
+    }
+
+    FontEntry entry;
+    entry.pixelHeight = pixelHeight;
+    entry.scale = face->ScaleForPixelHeight(pixelHeight);
+    entry.format = format;
+    entry.adds = 1;
+    entry.saveGlyphs = DiskCache::IsEnabled();
+    entry.newGlyphsSaved = 0;
+
+    if (entry.saveGlyphs)
+    {
+        entry.savedGlyphs = DiskCache::Find(face->Filename(),
+                                            SavedGlyphsVariant(pixelHeight, format));
+
+        // Index the saved glyphs, up to any that are cut short.
+        const unsigned char* data = entry.savedGlyphs.Data();
+        const size_t size = entry.savedGlyphs.Size();
+        size_t offset = 0;
+        while (size - offset >= sizeof(SavedGlyph))
+        {
+            SavedGlyph saved;
+            std::memcpy(&saved, data + offset, sizeof(saved));
+            if (saved.width <= 0 || saved.height <= 0 || SavedGlyphSize(saved) > size - offset)
+                break;
+
+            entry.glyphOffsets[saved.codepoint] = offset;
+            offset += SavedGlyphSize(saved);
+        }
+    }
+
+    entry.face = std::move(face);
+
+    const FontId id = m_nextFontId++;
+    m_fonts.insert(std::make_pair(id, std::move(entry)));
+    return id;
+}
+
+void GlyphCache::RemoveFont(FontId font)
+{
+    auto fontIt = m_fonts.find(font);
+    if (fontIt == m_fonts.end() || --fontIt->second.adds > 0)
+        return;
+
+    SaveGlyphs(fontIt->second);
+    m_fonts.erase(fontIt);
+
+    // The atlas space is reclaimed when the page is next evicted. Ids are
+    // never reused so the stale keys left in the page lists are harmless.
+    for (auto it = m_glyphs.begin(); it != m_glyphs.end();)
+    {
+        if ((it->first >> 32) == font)
+            it = m_glyphs.erase(it);
+        else
+            ++it;
+    }
+}
+
+GlyphCache::RasterizedGlyphs GlyphCache::RasterizeGlyphs(std::shared_ptr<const FontFace> face,
+                                                         float pixelHeight, Format format,
+                                                         char32_t first, char32_t last)
+{
+    RasterizedGlyphs rasterized;
+    rasterized.pixelHeight = pixelHeight;
+    rasterized.format = format;
+
+    const stbtt_fontinfo* info = &face->Info();
+    const float scale = face->ScaleForPixelHeight(pixelHeight);
+    std::vector<unsigned char> pixels;
+
+    for (char32_t codepoint = first; codepoint <= last; ++codepoint)
+    {
+        const int index = stbtt_FindGlyphIndex(info, codepoint);
+
+        int advance, leftBearing;
+        stbtt_GetGlyphHMetrics(info, index, &advance, &leftBearing);
+
+        SavedGlyph record;
+        record.codepoint = codepoint;
+        record.advance = scale * advance;
+
+        // Glyphs without pixels, like spaces, are quick to get when asked for.
+        if (format == Format::DistanceField)
+        {
+            int w = 0, h = 0, xoff = 0, yoff = 0;
+            unsigned char* sdf = stbtt_GetGlyphSDF(info, scale, index, SdfPadding, SdfOnEdge,
+                                                   SdfPixelDistScale, &w, &h, &xoff, &yoff);
+            if (!sdf)
+                continue;
+
+            record.width = static_cast<std::int16_t>(w);
+            record.height = static_cast<std::int16_t>(h);
+            record.offsetX = static_cast<std::int16_t>(xoff);
+            record.offsetY = static_cast<std::int16_t>(yoff);
+            if (w > 0 && h > 0)
+                AppendSavedGlyph(rasterized.glyphs, record, sdf, w);
+            stbtt_FreeSDF(sdf, nullptr);
+        }
+        else
+        {
+            int x0, y0, x1, y1;
+            stbtt_GetGlyphBitmapBox(info, index, scale, scale, &x0, &y0, &x1, &y1);
+            if (x1 <= x0 || y1 <= y0)
+                continue;
+
+            record.width = static_cast<std::int16_t>(x1 - x0);
+            record.height = static_cast<std::int16_t>(y1 - y0);
+            record.offsetX = static_cast<std::int16_t>(x0);
+            record.offsetY = static_cast<std::int16_t>(y0);
+            pixels.assign(static_cast<size_t>(record.width) * record.height, 0);
+            stbtt_MakeGlyphBitmap(info, pixels.data(), record.width, record.height, record.width,
+                                  scale, scale, index);
+            AppendSavedGlyph(rasterized.glyphs, record, pixels.data(), record.width);
+        }
+    }
+
+    rasterized.face = std::move(face);
+    return rasterized;
+}
+
+bool GlyphCache::AddRasterizedGlyphs(FontId font, const RasterizedGlyphs& rasterized)
+{
+    auto fontIt = m_fonts.find(font);
+    if (fontIt == m_fonts.end())
+        return false;
+
+    FontEntry& entry = fontIt->second;
+    if (entry.face != rasterized.face || entry.pixelHeight != rasterized.pixelHeight
+        || entry.format != rasterized.format)
+    {
+        return false;
+    }
+
+    // Added after any saved glyphs, as if they had been rasterized since.
+    const unsigned char* data = rasterized.glyphs.data();
+    const size_t size = rasterized.glyphs.size();
+    size_t offset = 0;
+    while (size - offset >= sizeof(SavedGlyph))
+    {
+        SavedGlyph saved;
+        std::memcpy(&saved, data + offset, sizeof(saved));
+        const size_t savedSize = SavedGlyphSize(saved);
+
+        if (entry.glyphOffsets.find(saved.codepoint) == entry.glyphOffsets.end()
+            && m_glyphs.find(GlyphKey(font, saved.codepoint)) == m_glyphs.end())
+        {
+            entry.glyphOffsets[saved.codepoint] = entry.savedGlyphs.Size() + entry.newGlyphs.size();
+            entry.newGlyphs.insert(entry.newGlyphs.end(), data + offset, data + offset + savedSize);
+        }
+        offset += savedSize;
+    }
+
+    return true;
+}
+
+const GlyphCache::Glyph* GlyphCache::GetGlyph(FontId font, char32_t codepoint)
+{
+    ++m_clock;
+
+    const unsigned long long key = GlyphKey(font, codepoint);
+    auto found = m_glyphs.find(key);
+    if (found != m_glyphs.end())
+    {
+        if (found->second.page >= 0)
+            m_packing[found->second.page].lastUsed = m_clock;
+        return &found->second;
+    }
+
+    auto fontIt = m_fonts.find(font);
+    if (fontIt == m_fonts.end())
+        return nullptr;
+
+    FontEntry& entry = fontIt->second;
+    const stbtt_fontinfo* info = &entry.face->Info();
+    const float scale = entry.scale;
+    int index = 0;
+
+    Glyph glyph;
+    glyph.page = -1;
+
+    // Saved by an earlier run, rasterized before the page was reused, or
+    // rasterized ahead of use?
+    const unsigned char* saved = nullptr;
+    if (!entry.glyphOffsets.empty())
+    {
+        auto offset = entry.glyphOffsets.find(codepoint);
+        if (offset != entry.glyphOffsets.end())
+        {
+            const size_t savedSize = entry.savedGlyphs.Size();
+            const unsigned char* record = offset->second < savedSize
+                ? entry.savedGlyphs.Data() + offset->second
+                : entry.newGlyphs.data() + (offset->second - savedSize);
+
+            SavedGlyph savedGlyph;
+            std::memcpy(&savedGlyph, record, sizeof(savedGlyph));
+            glyph.advance = savedGlyph.advance;
+            glyph.rect = Rect(0, 0, savedGlyph.width, savedGlyph.height);
+            glyph.offset = Point(savedGlyph.offsetX, savedGlyph.offsetY);
+            saved = record + sizeof(SavedGlyph);
+        }
+    }
+
+    unsigned char* sdf = nullptr;
+    if (!saved)
+    {
+        index = stbtt_FindGlyphIndex(info, codepoint);
+
+        int advance, leftBearing;
+        stbtt_GetGlyphHMetrics(info, index, &advance, &leftBearing);
+        glyph.advance = scale * advance;
+
+        // Distance fields are rasterized up front as stb_truetype works out their size.
+        if (entry.format == Format::DistanceField)
+        {
+            int w = 0, h = 0, xoff = 0, yoff = 0;
+            sdf = stbtt_GetGlyphSDF(info, scale, index, SdfPadding, SdfOnEdge, SdfPixelDistScale,
+                                    &w, &h, &xoff, &yoff);
+            glyph.rect = Rect(0, 0, sdf ? w : 0, sdf ? h : 0);
+            glyph.offset = Point(xoff, yoff);
+        }
+        else
+        {
+            int x0, y0, x1, y1;
+            stbtt_GetGlyphBitmapBox(info, index, scale, scale, &x0, &y0, &x1, &y1);
+            glyph.rect = Rect(0, 0, x1 - x0, y1 - y0);
+            glyph.offset = Point(x0, y0);
+        }
+    }
+
+    if (glyph.rect.w > 0 && glyph.rect.h > 0)
+    {
+        const Point padded(glyph.rect.w + c_glyphPadding, glyph.rect.h + c_glyphPadding);
+        Point pos;
+        int page = -1;
+
+        if (padded.x <= m_pageSize.x && padded.y <= m_pageSize.y)
+        {
+            for (int i = 0; i < GetPageCount() && page < 0; ++i)
+            {
+                if (Allocate(i, padded, pos))
+                    page = i;
+            }
+
+            if (page < 0)
+            {
+                if (m_pages.size() < MaxPages())
+                {
+                    page = AddPage();
+                }
+                else
+                {
+                    // Reuse the least recently used page.
+                    page = 0;
+                    for (int i = 1; i < GetPageCount(); ++i)
+                    {
+                        if (m_packing[i].lastUsed < m_packing[page].lastUsed)
+                            page = i;
+                    }
+                    EvictPage(page);
+                }
+                Allocate(page, padded, pos);
+            }
+        }
+
+        // Glyphs larger than a page are not drawn.
+        if (page >= 0)
+        {
+            Page& pg = m_pages[page];
+            if (saved || sdf)
+            {
+                const unsigned char* pixels = saved ? saved : sdf;
+                for (int y = 0; y < glyph.rect.h; ++y)
+                {
+                    std::memcpy(&pg.pixels[(pos.y + y) * pg.size.x + pos.x],
+                                pixels + y * glyph.rect.w, glyph.rect.w);
+                }
+            }
+            else
+            {
+                stbtt_MakeGlyphBitmap(info, &pg.pixels[pos.y * pg.size.x + pos.x],
+                                      glyph.rect.w, glyph.rect.h, pg.size.x,
+                                      scale, scale, index);
+            }
+
+            // Keep a copy to save in the disk cache.
+            if (entry.saveGlyphs && !saved)
+            {
+                SavedGlyph record;
+                record.codepoint = codepoint;
+                record.width = static_cast<std::int16_t>(glyph.rect.w);
+                record.height = static_cast<std::int16_t>(glyph.rect.h);
+                record.offsetX = static_cast<std::int16_t>(glyph.offset.x);
+                record.offsetY = static_cast<std::int16_t>(glyph.offset.y);
+                record.advance = glyph.advance;
+
+                entry.glyphOffsets[codepoint] = entry.savedGlyphs.Size() + entry.newGlyphs.size();
+                AppendSavedGlyph(entry.newGlyphs, record, &pg.pixels[pos.y * pg.size.x + pos.x],
+                                 pg.size.x);
+            }
+
+            glyph.page = page;
+            glyph.rect.x = pos.x;
+            glyph.rect.y = pos.y;
+
+            // grow the dirty area to include the new glyph
+            Rect& dirty = pg.dirty;
+            if (dirty.w <= 0 || dirty.h <= 0)
+            {
+                dirty = glyph.rect;
+            }
+            else
+            {
+                const int right = std::max(dirty.Right(), glyph.rect.Right());
+                const int bottom = std::max(dirty.Bottom(), glyph.rect.Bottom());
+                dirty.x = std::min(dirty.x, glyph.rect.x);
+                dirty.y = std::min(dirty.y, glyph.rect.y);
+                dirty.w = right - dirty.x;
+                dirty.h = bottom - dirty.y;
+            }
+
+            m_packing[page].glyphs.push_back(key);
+            m_packing[page].lastUsed = m_clock;
+        }
+    }
+
+    if (sdf)
+        stbtt_FreeSDF(sdf, nullptr);
+
+    return &m_glyphs.insert(std::make_pair(key, glyph)).first->second;
+}
+
+void GlyphCache::SaveGlyphs()
+{
+    for (auto& font : m_fonts)
+        SaveGlyphs(font.second);
+}
+
+void GlyphCache::SaveGlyphs(FontEntry& entry)
+{
+    if (!entry.saveGlyphs || entry.newGlyphs.size() == entry.newGlyphsSaved)
+        return;
+
+    // Copy the saved glyphs in front of the new ones, so the offsets stay the
+    // same, and the file is not mapped when it is replaced.
+    if (entry.savedGlyphs)
+    {
+        entry.newGlyphs.insert(entry.newGlyphs.begin(), entry.savedGlyphs.Data(),
+                               entry.savedGlyphs.Data() + entry.savedGlyphs.Size());
+        entry.savedGlyphs = DiskCache::Entry();
+    }
+
+    DiskCache::Store(entry.face->Filename(), SavedGlyphsVariant(entry.pixelHeight, entry.format),
+                     entry.newGlyphs.data(), entry.newGlyphs.size());
+    entry.newGlyphsSaved = entry.newGlyphs.size();
+}
+
+bool GlyphCache::Allocate(int page, Point size, Point& pos)
+{
+    PagePacking& packing = m_packing[page];
+
+    // Use the shortest shelf that fits, so small glyphs don't waste tall rows.
+    Shelf* best = nullptr;
+    for (Shelf& shelf : packing.shelves)
+    {
+        if (shelf.height >= size.y && shelf.x + size.x <= m_pageSize.x
+            && (!best || shelf.height < best->height))
+        {
+            best = &shelf;
+        }
+    }
+
+    // Open a new shelf if the best one is much taller than we need.
+    if ((!best || best->height > size.y + size.y / 2)
+        && packing.nextShelfY + size.y <= m_pageSize.y)
+    {
+        Shelf shelf = { packing.nextShelfY, size.y, 0 };
+        packing.shelves.push_back(shelf);
+        packing.nextShelfY += size.y;
+        best = &packing.shelves.back();
+    }
+
+    if (!best)
+        return false;
+
+    pos = Point(best->x, best->y);
+    best->x += size.x;
+    return true;
+}
+
+int GlyphCache::AddPage()
+{
+    Page page;
+    page.size = m_pageSize;
+    page.pixels.resize(m_pageSize.x * m_pageSize.y, 0);
+    page.dirty = Rect(Point(), m_pageSize);
+    m_pages.push_back(std::move(page));
+
+    PagePacking packing;
+    packing.nextShelfY = 0;
+    packing.lastUsed = m_clock;
+    m_packing.push_back(packing);
+
+    return GetPageCount() - 1;
+}
+
+void GlyphCache::EvictPage(int page)
+{
+    if (m_evictListener)
+        m_evictListener(page);
+
+    PagePacking& packing = m_packing[page];
+    for (unsigned long long key : packing.glyphs)
+        m_glyphs.erase(key);
+
+    packing.glyphs.clear();
+    packing.shelves.clear();
+    packing.nextShelfY = 0;
+
+    Page& pg = m_pages[page];
+    std::fill(pg.pixels.begin(), pg.pixels.end(), 0);
+    pg.dirty = Rect(Point(), pg.size);
+}
+
+size_t GlyphCache::MaxPages() const
+{
+    const size_t pageBytes = static_cast<size_t>(m_pageSize.x) * m_pageSize.y;
+    return std::max<size_t>(1, m_memoryLimit / pageBytes);
+}
+
+void GlyphCache::SetMemoryLimit(size_t bytes)
+{
+    m_memoryLimit = bytes;
+
+    if (m_pages.size() > MaxPages())
+        Clear();
+}
+
+size_t GlyphCache::GetMemoryUsed() const
+{
+    size_t used = 0;
+    for (const Page& page : m_pages)
+        used += page.pixels.size();
+    return used;
+}
+
+void GlyphCache::Clear()
+{
+    if (m_evictListener)
+    {
+        for (int i = 0; i < GetPageCount(); ++i)
+            m_evictListener(i);
+    }
+
+    m_glyphs.clear();
+    m_pages.clear();
+    m_packing.clear();
+}
+
+void ScaledFont::Rescale(GlyphCache& cache, const std::shared_ptr<const FontFace>& face,
+                         float scale, float pixelHeight)
+{
+    std::swap(id, otherId);
+    std::swap(renderScale, otherScale);
+
+    // Switched back to the scale before?
+    if (id != 0 && renderScale == scale)
+        return;
+
+    // Glyphs are rasterized for the new size as they are drawn.
+    if (id != 0)
+        cache.RemoveFont(id);
+    id = cache.AddFont(face, pixelHeight);
+    renderScale = scale;
+}
+
+void ScaledFont::Remove(GlyphCache& cache)
+{
+    if (id != 0)
+        cache.RemoveFont(id);
+    if (otherId != 0)
+        cache.RemoveFont(otherId);
+    id = otherId = 0;
+}
+
+} // namespace Renderer
+} // namespace Gwk
@@ -34,7 +34,7 @@ namespace Gwk {
             FreeTexture(texture);
             m_lastTexture = nullptr;
 
-            const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+            const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
             irr::video::ITexture* NewTex = Driver->getTexture(filename.c_str());
             if (!NewTex)
@@ -84,7 +84,7 @@ void OpenGL_DebugFont::DestroyDebugFont()
 void OpenGL_DebugFont::RenderText(Gwk::Font* font, Gwk::Point pos,
                                   const Gwk::String& text)
 {
-    float fSize = font->size*Scale();
+    float fSize = font->GetSize()*Scale();
 
     if (!text.length())
         return;
@@ -128,7 +128,7 @@ Gwk::Point OpenGL_DebugFont::MeasureText(Gwk::Font* font,
                                           const Gwk::String& text)
 {
     Gwk::Point p;
-    float fSize = font->size*Scale();
+    float fSize = font->GetSize()*Scale();
     float spacing = 0.0f;
 
     for (unsigned int i = 0; i < text.length(); i++)
@@ -138,7 +138,7 @@ Gwk::Point OpenGL_DebugFont::MeasureText(Gwk::Font* font,
     }
 
     p.x = spacing*m_fLetterSpacing*fSize*m_fFontScale[0];
-    p.y = font->size*Scale();
+    p.y = font->GetSize()*Scale();
     return p;
 }
 
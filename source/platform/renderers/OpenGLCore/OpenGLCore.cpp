@@ -14,6 +14,7 @@
 #endif
 #include <Gwork/PlatformTypes.h>
 #include <Gwork/WindowProvider.h>
+#include <Gwork/DiskCache.h>
 #include <Gwork/PlatformCommon.h>
 #include <Gwork/Utility.h>
 
@@ -33,13 +34,6 @@
 #include <algorithm>
 #include <fstream>
 
-//#define STBI_ASSERT(x)  // comment in for no asserts
-#define STB_IMAGE_IMPLEMENTATION
-#include <Gwork/External/stb_image.h>
-
-#define STB_TRUETYPE_IMPLEMENTATION
-#define STBTT_STATIC
-#include <Gwork/External/stb_truetype.h>
 #include <iostream>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/matrix_decompose.hpp>
@@ -51,12 +45,24 @@ namespace Renderer {
 
 // See "Font Size in Pixels or Points" in "stb_truetype.h"
 static constexpr float c_pointsToPixels = 1.333f;
-// Arbitrary size chosen for texture cache target.
-static constexpr int c_texsz = 800; // Texture size too small for wchar_t characters but stbtt_BakeFontBitmap crashes on larger sizes
+
+static inline size_t ImageBytes(int width, int height)
+{
+    return static_cast<size_t>(width) * height * 4;
+}
+
+static inline size_t ImageBytes(const TextureData& texData)
+{
+    return ImageBytes(static_cast<int>(texData.width), static_cast<int>(texData.height));
+}
 
 
 OpenGLCore::GLTextureData::~GLTextureData()
 {
+    // Moved from, or only in the atlas: leave the bound texture alone.
+    if (texture_id == 0)
+        return;
+
     glBindTexture(GL_TEXTURE_2D, 0);
     glDeleteTextures(1, reinterpret_cast<GLuint*>(&texture_id));
 }
@@ -66,61 +72,125 @@ Font::Status OpenGLCore::LoadFont(const Font& font)
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.facename);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
+
+    Font::Status status;
+    std::shared_ptr<FontFace> face = FontFace::Load(filename, status);
+    if (!face)
+        return status;
 
-    std::ifstream inFile(filename, std::ifstream::in | std::ifstream::binary);
+    GLFontData fontData;
+    fontData.glyphs.id = m_glyphCache.AddFont(face, font.GetSize() * Scale() * c_pointsToPixels);
+    fontData.glyphs.renderScale = Scale();
+    fontData.face = std::move(face);
+
+    m_lastFont = &(*m_fonts.insert(std::make_pair(font, fontData)).first);
+    return Font::Status::Loaded;
+}
+
+void OpenGLCore::FreeFont(const Gwk::Font& font)
+{
+    if (m_lastFont != nullptr && m_lastFont->first == font)
+        m_lastFont = nullptr;
 
-    if (!inFile.good())
+    auto it = m_fonts.find(font);
+    if (it != m_fonts.end())
     {
-        Gwk::Log::Write(Log::Level::Error, "Font file not found: %s", filename.c_str());
-        return Font::Status::ErrorFileNotFound;
+        it->second.glyphs.Remove(m_glyphCache);
+        m_fonts.erase(it);
     }
+}
 
-    std::streampos begin = inFile.tellg();
-    inFile.seekg(0, std::ios::end);
-    const size_t fsz = inFile.tellg() - begin;
-    inFile.seekg(0, std::ios::beg);
-    assert(fsz > 0);
-
-    std::unique_ptr<unsigned char[]> ttfdata = std::unique_ptr<unsigned char[]>(new unsigned char[fsz]);
-    inFile.read(reinterpret_cast<char*>(ttfdata.get()), fsz);
-    inFile.close();
+void OpenGLCore::RescaleFont(const Font& font, GLFontData& fontData)
+{
+    fontData.glyphs.Rescale(m_glyphCache, fontData.face, Scale(),
+                            font.GetSize() * Scale() * c_pointsToPixels);
+}
 
-    std::unique_ptr<unsigned char[]> font_bmp = std::unique_ptr<unsigned char[]>(new unsigned char[c_texsz * c_texsz]);
+void OpenGLCore::BindGlyphPage(int page)
+{
+    if (page >= static_cast<int>(m_glyphTextures.size()))
+        m_glyphTextures.resize(page + 1, 0);
 
-    GLFontData fontData;
-    const float realsize = font.size * Scale();
-    fontData.baked_chars.resize(LastCharacter - BeginCharacter + 1);
-
-    stbtt_BakeFontBitmap(ttfdata.get(), 0,
-                    realsize * c_pointsToPixels, // height
-                    font_bmp.get(),
-                    c_texsz, c_texsz,
-                    BeginCharacter, LastCharacter,             // range to bake
-                    reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()));
-
-    glGenTextures(1, &fontData.texture_id);
-    SetTexture(fontData.texture_id);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED,
-        c_texsz, c_texsz, 0,
-        GL_RED, GL_UNSIGNED_BYTE,
-        font_bmp.get());
+    unsigned int& texture = m_glyphTextures[page];
+    const bool created = texture == 0;
+    if (created)
+        glGenTextures(1, &texture);
 
-    fontData.width = c_texsz;
-    fontData.height = c_texsz;
+    if (m_current_texture != texture)
+    {
+        Flush();
+        SetTexture(texture);
+    }
 
-    m_lastFont = &(*m_fonts.insert(std::make_pair(font, std::move(fontData))).first);
-    return Font::Status::Loaded;
+    const GlyphCache::Page& glyphPage = m_glyphCache.GetPage(page);
+    if (created)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED,
+            glyphPage.size.x, glyphPage.size.y, 0,
+            GL_RED, GL_UNSIGNED_BYTE,
+            glyphPage.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        m_glyphCache.MarkUploaded(page);
+    }
+    else if (glyphPage.dirty.w > 0 && glyphPage.dirty.h > 0)
+    {
+        // Upload only the glyphs added since the last draw.
+        const Rect& dirty = glyphPage.dirty;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, glyphPage.size.x);
+        glTexSubImage2D(GL_TEXTURE_2D, 0,
+            dirty.x, dirty.y, dirty.w, dirty.h,
+            GL_RED, GL_UNSIGNED_BYTE,
+            &glyphPage.pixels[dirty.y * glyphPage.size.x + dirty.x]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        m_glyphCache.MarkUploaded(page);
+    }
 }
 
-void OpenGLCore::FreeFont(const Gwk::Font& font)
+void OpenGLCore::BindAtlasPage(int page)
 {
-    if (m_lastFont != nullptr && m_lastFont->first == font)
-        m_lastFont = nullptr;
+    if (page >= static_cast<int>(m_atlasTextures.size()))
+        m_atlasTextures.resize(page + 1, 0);
+
+    unsigned int& texture = m_atlasTextures[page];
+    const bool created = texture == 0;
+    if (created)
+        glGenTextures(1, &texture);
+
+    if (m_current_texture != texture)
+    {
+        Flush();
+        SetTexture(texture);
+    }
 
-    m_fonts.erase(font); // calls GLFontData destructor
+    const TextureAtlas::Page& atlasPage = m_textureAtlas.GetPage(page);
+    if (created)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                     atlasPage.size.x, atlasPage.size.y, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE,
+                     atlasPage.pixels.data());
+        m_textureAtlas.MarkUploaded(page);
+    }
+    else if (atlasPage.dirty.w > 0 && atlasPage.dirty.h > 0)
+    {
+        // Upload only the images added or moved since the last draw.
+        const Rect& dirty = atlasPage.dirty;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, atlasPage.size.x);
+        glTexSubImage2D(GL_TEXTURE_2D, 0,
+                        dirty.x, dirty.y, dirty.w, dirty.h,
+                        GL_RGBA, GL_UNSIGNED_BYTE,
+                        &atlasPage.pixels[(dirty.y * atlasPage.size.x + dirty.x) * 4]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        m_textureAtlas.MarkUploaded(page);
+    }
 }
 
 bool OpenGLCore::EnsureFont(const Font& font)
@@ -128,7 +198,11 @@ bool OpenGLCore::EnsureFont(const Font& font)
     if (m_lastFont != nullptr)
     {
         if (m_lastFont->first == font)
+        {
+            if (m_lastFont->second.glyphs.renderScale != Scale())
+                RescaleFont(font, m_lastFont->second);
             return true;
+        }
     }
 
     // Was it loaded before?
@@ -136,6 +210,8 @@ bool OpenGLCore::EnsureFont(const Font& font)
     if (it != m_fonts.end())
     {
         m_lastFont = &(*it);
+        if (it->second.glyphs.renderScale != Scale())
+            RescaleFont(font, it->second);
         return true;
     }
 
@@ -150,23 +226,41 @@ Texture::Status OpenGLCore::LoadTexture(const Texture& texture)
     FreeTexture(texture);
     m_lastTexture = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
-    GLTextureData texData;
-
-    int width, height, n;
-    {
-        unsigned char *image = stbi_load(filename.c_str(), &width, &height, &n, 4);
-        texData.m_ReadData = deleted_unique_ptr<unsigned char>(image, [](unsigned char* mem) { if (mem) stbi_image_free(mem); });
-    }
+    int width, height;
+    deleted_unique_ptr<const unsigned char> pixels =
+        DiskCache::DecodeImage(filename, "rgba8", width, height);
 
     // Image failed to load..
-    if (!texData.m_ReadData)
-    {
-        Gwk::Log::Write(Log::Level::Error, "Texture file not found: %s", filename.c_str());
+    if (!pixels)
         return Texture::Status::ErrorFileNotFound;
+
+    return CreateTexture(texture, width, height, std::move(pixels));
+}
+
+Texture::Status OpenGLCore::CreateTexture(const Texture& texture, int width, int height,
+                                          deleted_unique_ptr<const unsigned char> pixels)
+{
+    GLTextureData texData;
+    texData.width = width;
+    texData.height = height;
+    texData.readable = texture.readable;
+
+    // Small images share a texture, so drawing them does not flush the batch.
+    // The atlas keeps their pixels, so they can always be read.
+    const Point size(width, height);
+    if (m_textureAtlas.Fits(size))
+    {
+        texData.atlasImage = m_textureAtlas.Add(size, pixels.get());
+        m_lastTexture = &(*m_textures.insert(std::make_pair(texture, std::move(texData))).first);
+        // Counted twice: the atlas page is kept in memory too.
+        m_textureBudget.Loaded(texture, m_lastTexture->second.budget,
+                               2 * ImageBytes(width, height));
+        return Texture::Status::Loaded;
     }
 
+    texData.m_ReadData = std::move(pixels);
 
     // Create the opengl texture
     glGenTextures(1, &texData.texture_id);
@@ -175,27 +269,108 @@ Texture::Status OpenGLCore::LoadTexture(const Texture& texture)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     GLenum format = GL_RGBA;
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, format,
-        GL_UNSIGNED_BYTE, (const GLvoid*)texData.m_ReadData.get());
+                 GL_UNSIGNED_BYTE, (const GLvoid*)texData.m_ReadData.get());
 
-    texData.readable = texture.readable;
     if (!texture.readable)
     {
         texData.m_ReadData.reset();
     }
 
-    texData.width = width;
-    texData.height = height;
-
     m_lastTexture = &(*m_textures.insert(std::make_pair(texture, std::move(texData))).first);
+    m_textureBudget.Loaded(texture, m_lastTexture->second.budget,
+                           ImageBytes(width, height) * (texture.readable ? 2 : 1));
     return Texture::Status::Loaded;
 }
 
+void OpenGLCore::SeparateFromAtlas(GLTextureData& texData)
+{
+    const TextureAtlas::Placement& placement = m_textureAtlas.GetPlacement(texData.atlasImage);
+    const TextureAtlas::Page& page = m_textureAtlas.GetPage(placement.page);
+
+    Flush();
+    glGenTextures(1, &texData.texture_id);
+    SetTexture(texData.texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, page.size.x);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, placement.rect.w, placement.rect.h, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE,
+                 &page.pixels[(placement.rect.y * page.size.x + placement.rect.x) * 4]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    m_textureBudget.Resized(texData.budget,
+                            texData.budget.bytes + ImageBytes(placement.rect.w, placement.rect.h));
+}
+
+Base::TextureDecoder OpenGLCore::GetTextureDecoder(const Texture& texture)
+{
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
+
+    return [this, texture, filename]() -> TextureFinisher
+    {
+        int width = 0, height = 0;
+        auto pixels = std::make_shared<deleted_unique_ptr<const unsigned char>>(
+            DiskCache::DecodeImage(filename, "rgba8", width, height));
+
+        // The GL texture is made on the render thread.
+        return [this, texture, pixels, width, height]() -> Texture::Status
+        {
+            FreeTexture(texture);
+            m_lastTexture = nullptr;
+
+            if (!*pixels)
+                return Texture::Status::ErrorFileNotFound;
+
+            return CreateTexture(texture, width, height, std::move(*pixels));
+        };
+    };
+}
+
+Base::FontBaker OpenGLCore::GetFontBaker(const Font& font)
+{
+    if (m_fonts.find(font) != m_fonts.end())
+        return nullptr;     // already loaded
+
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
+    const float pixelHeight = font.GetSize() * Scale() * c_pointsToPixels;
+
+    return [this, font, filename, pixelHeight]() -> FontFinisher
+    {
+        std::shared_ptr<GlyphCache::RasterizedGlyphs> glyphs =
+            std::make_shared<GlyphCache::RasterizedGlyphs>();
+
+        Font::Status status;
+        std::shared_ptr<const FontFace> face = FontFace::Load(filename, status);
+        if (face)
+            *glyphs = GlyphCache::RasterizeGlyphs(face, pixelHeight, GlyphCache::Format::Coverage);
+
+        return [this, font, glyphs]()
+        {
+            // The glyphs are dropped if the font is now another size.
+            if (EnsureFont(font) && glyphs->face)
+                m_glyphCache.AddRasterizedGlyphs(m_lastFont->second.glyphs.id, *glyphs);
+        };
+    };
+}
+
 void OpenGLCore::FreeTexture(const Gwk::Texture& texture)
 {
     if (m_lastTexture != nullptr && m_lastTexture->first == texture)
         m_lastTexture = nullptr;
 
-    m_textures.erase(texture); // calls GLTextureData destructor
+    auto it = m_textures.find(texture);
+    if (it != m_textures.end())
+    {
+        if (it->second.atlasImage != 0)
+            m_textureAtlas.Remove(it->second.atlasImage);
+
+        // The destructor unbinds it.
+        if (it->second.texture_id != 0)
+            m_current_texture = 0;
+
+        m_textureBudget.Freed(it->second.budget);
+        m_textures.erase(it); // calls GLTextureData destructor
+    }
 }
 
 TextureData OpenGLCore::GetTextureData(const Texture& texture) const
@@ -217,7 +392,10 @@ bool OpenGLCore::EnsureTexture(const Gwk::Texture& texture)
     if (m_lastTexture != nullptr)
     {
         if (m_lastTexture->first == texture)
+        {
+            m_textureBudget.Used(m_lastTexture->second.budget);
             return true;
+        }
     }
 
     // Was it loaded before?
@@ -225,6 +403,7 @@ bool OpenGLCore::EnsureTexture(const Gwk::Texture& texture)
     if (it != m_textures.end())
     {
         m_lastTexture = &(*it);
+        m_textureBudget.Used(it->second.budget);
         return true;
     }
 
@@ -241,14 +420,25 @@ OpenGLCore::OpenGLCore(ResourcePaths& paths, const Rect& viewRect)
     ,   m_context(nullptr)
     ,   m_viewRect(viewRect)
     ,   m_current_texture(0)
+    ,   m_clipping(false)
     ,   m_vertices(1024)
     ,   m_lastFont(nullptr)
     ,   m_lastTexture(nullptr)
+    ,   m_readBackCopies(false)
 {
+    // Draw anything using a glyph page before it is reused.
+    m_glyphCache.SetEvictListener([this](int) { Flush(); });
+
+    // Likewise before images in an atlas page are moved.
+    m_textureAtlas.SetMoveListener([this](int) { Flush(); });
 }
 
 OpenGLCore::~OpenGLCore()
 {
+    if (!m_glyphTextures.empty())
+        glDeleteTextures(static_cast<GLsizei>(m_glyphTextures.size()), m_glyphTextures.data());
+    if (!m_atlasTextures.empty())
+        glDeleteTextures(static_cast<GLsizei>(m_atlasTextures.size()), m_atlasTextures.data());
 }
 
 void checkErrors(unsigned int shader, std::string type)
@@ -350,6 +540,26 @@ void OpenGLCore::Begin()
 void OpenGLCore::End()
 {
     Flush();
+
+    // Copies read back by PixelColor() are only kept for the frame.
+    if (m_readBackCopies)
+    {
+        for (auto& texture : m_textures)
+        {
+            GLTextureData& texData = texture.second;
+            if (!texData.readable && texData.m_ReadData)
+            {
+                texData.m_ReadData.reset();
+                m_textureBudget.Resized(texData.budget,
+                                        texData.budget.bytes - ImageBytes(texData));
+            }
+        }
+        m_readBackCopies = false;
+    }
+
+    m_textureBudget.FreeLeastRecentlyUsed(m_textures,
+                                          [this](const Texture& texture) { FreeTexture(texture); });
+    m_textureBudget.EndFrame();
 }
 
 void OpenGLCore::Flush()
@@ -448,6 +658,43 @@ void OpenGLCore::AddVert(int x, int y, float u, float v)
     m_vertices.emplace_back(vertex);
 }
 
+void OpenGLCore::AddQuad(Gwk::Rect rect, float u1, float v1, float u2, float v2)
+{
+    if (rect.w <= 0 || rect.h <= 0)
+        return;
+
+    // Clip here, rather than with a scissor, so that each control does not
+    // flush the batch. The UVs are cut in proportion.
+    if (m_clipping)
+    {
+        const int left = std::max(rect.x, m_clipRect.x);
+        const int top = std::max(rect.y, m_clipRect.y);
+        const int right = std::min(rect.Right(), m_clipRect.Right());
+        const int bottom = std::min(rect.Bottom(), m_clipRect.Bottom());
+        if (left >= right || top >= bottom)
+            return;
+
+        const float du = (u2 - u1) / rect.w;
+        const float dv = (v2 - v1) / rect.h;
+        if (right < rect.Right())
+            u2 = u1 + du * (right - rect.x);
+        if (left > rect.x)
+            u1 += du * (left - rect.x);
+        if (bottom < rect.Bottom())
+            v2 = v1 + dv * (bottom - rect.y);
+        if (top > rect.y)
+            v1 += dv * (top - rect.y);
+        rect = Gwk::Rect(left, top, right - left, bottom - top);
+    }
+
+    AddVert(rect.x, rect.y,                 u1, v1);
+    AddVert(rect.x + rect.w, rect.y,        u2, v1);
+    AddVert(rect.x, rect.y + rect.h,        u1, v2);
+    AddVert(rect.x + rect.w, rect.y,        u2, v1);
+    AddVert(rect.x + rect.w, rect.y + rect.h, u2, v2);
+    AddVert(rect.x, rect.y + rect.h,        u1, v2);
+}
+
 void OpenGLCore::SetTexture(unsigned int texture)
 {
     if (texture == 0 && !m_textures_on)
@@ -472,12 +719,7 @@ void OpenGLCore::DrawFilledRect(Gwk::Rect rect)
     m_activeProgram = 0;
 
     Translate(rect);
-    AddVert(rect.x, rect.y);
-    AddVert(rect.x+rect.w, rect.y);
-    AddVert(rect.x, rect.y+rect.h);
-    AddVert(rect.x+rect.w, rect.y);
-    AddVert(rect.x+rect.w, rect.y+rect.h);
-    AddVert(rect.x, rect.y+rect.h);
+    AddQuad(rect);
 }
 
 void OpenGLCore::SetDrawColor(Gwk::Color color)
@@ -488,20 +730,16 @@ void OpenGLCore::SetDrawColor(Gwk::Color color)
 
 void OpenGLCore::StartClip()
 {
-    Flush();
-    Gwk::Rect rect = ClipRegion();
-
-    rect.y = m_viewRect.h - (rect.y + rect.h);
-
-    glScissor(rect.x * Scale(), rect.y * Scale(),
-              rect.w * Scale(), rect.h * Scale());
-    glEnable(GL_SCISSOR_TEST);
+    // Quads are clipped as they are added, so the batch carries on.
+    const Gwk::Rect& clip = ClipRegion();
+    m_clipRect = Gwk::Rect(static_cast<int>(clip.x * Scale()), static_cast<int>(clip.y * Scale()),
+                           static_cast<int>(clip.w * Scale()), static_cast<int>(clip.h * Scale()));
+    m_clipping = true;
 }
 
 void OpenGLCore::EndClip()
 {
-    Flush();
-    glDisable(GL_SCISSOR_TEST);
+    m_clipping = false;
 }
 
 void OpenGLCore::DrawTexturedRect(const Gwk::Texture& texture, Gwk::Rect rect,
@@ -514,19 +752,34 @@ void OpenGLCore::DrawTexturedRect(const Gwk::Texture& texture, Gwk::Rect rect,
 
     Translate(rect);
 
-    if (!m_current_texture || texData.texture_id != m_current_texture)
+    const bool repeats = std::min({u1, v1, u2, v2}) < 0.0f || std::max({u1, v1, u2, v2}) > 1.0f;
+    if (texData.atlasImage != 0 && !repeats)
     {
-        Flush();
-        SetTexture(texData.texture_id);
+        // Draw from the atlas page, with the UVs moved into the image's place.
+        const TextureAtlas::Placement& placement =
+            m_textureAtlas.GetPlacement(texData.atlasImage);
+        BindAtlasPage(placement.page);
+
+        const Point pageSize = m_textureAtlas.GetPage(placement.page).size;
+        u1 = (placement.rect.x + u1 * placement.rect.w) / pageSize.x;
+        u2 = (placement.rect.x + u2 * placement.rect.w) / pageSize.x;
+        v1 = (placement.rect.y + v1 * placement.rect.h) / pageSize.y;
+        v2 = (placement.rect.y + v2 * placement.rect.h) / pageSize.y;
+    }
+    else
+    {
+        if (texData.texture_id == 0)
+            SeparateFromAtlas(texData);
+
+        if (!m_current_texture || texData.texture_id != m_current_texture)
+        {
+            Flush();
+            SetTexture(texData.texture_id);
+        }
     }
 
     m_activeProgram = 1;
-    AddVert(rect.x, rect.y, u1, v1);
-    AddVert(rect.x + rect.w, rect.y, u2, v1);
-    AddVert(rect.x, rect.y + rect.h, u1, v2);
-    AddVert(rect.x + rect.w, rect.y, u2, v1);
-    AddVert(rect.x + rect.w, rect.y + rect.h, u2, v2);
-    AddVert(rect.x, rect.y + rect.h, u1, v2);
+    AddQuad(rect, u1, v1, u2, v2);
 }
 
 Gwk::Color OpenGLCore::PixelColor(const Gwk::Texture& texture, unsigned int x, unsigned int y,
@@ -539,19 +792,31 @@ Gwk::Color OpenGLCore::PixelColor(const Gwk::Texture& texture, unsigned int x, u
 
     static const unsigned int iPixelSize = sizeof(unsigned char) * 4;
 
-    if (texData.readable)
+    if (texData.atlasImage != 0)
     {
-        unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * iPixelSize;
+        const TextureAtlas::Placement& placement =
+            m_textureAtlas.GetPlacement(texData.atlasImage);
+        const TextureAtlas::Page& page = m_textureAtlas.GetPage(placement.page);
+        const unsigned char* pPixel = &page.pixels[((placement.rect.y + y) * page.size.x
+                                                    + placement.rect.x + x) * iPixelSize];
         return Gwk::Color(pPixel[0], pPixel[1], pPixel[2], pPixel[3]);
     }
 
-    SetTexture(texData.texture_id);
-    texData.m_ReadData = deleted_unique_ptr<unsigned char>(new unsigned char[texData.width * texData.height * iPixelSize], [](unsigned char* mem) { if (mem) delete[](mem); });
-    texData.readable = true;
+    if (texData.m_ReadData)
+    {
+        const unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * iPixelSize;
+        return Gwk::Color(pPixel[0], pPixel[1], pPixel[2], pPixel[3]);
+    }
 
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData.m_ReadData.get());
+    Flush();
+    SetTexture(texData.texture_id);
+    unsigned char* readBack = new unsigned char[static_cast<unsigned int>(texData.width * texData.height * iPixelSize)];
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, readBack);
+    texData.m_ReadData = deleted_unique_ptr<const unsigned char>(readBack, [](const unsigned char* mem) { delete[] mem; });
+    m_textureBudget.Resized(texData.budget, texData.budget.bytes + ImageBytes(texData));
+    m_readBackCopies = true;
 
-    unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * iPixelSize;
+    const unsigned char *pPixel = texData.m_ReadData.get() + (x + (y * static_cast<unsigned int>(texData.width))) * iPixelSize;
     return Gwk::Color(pPixel[0], pPixel[1], pPixel[2], pPixel[3]);
 }
 
@@ -561,42 +826,41 @@ void OpenGLCore::RenderText(const Gwk::Font& font, Gwk::Point pos,
     if (!EnsureFont(font))
         return;
     
-    GLFontData& fontData = m_lastFont->second;
+    const GLFontData& fontData = m_lastFont->second;
 
-    if (m_current_texture != fontData.texture_id)
-    {
-        Flush();
-        SetTexture(fontData.texture_id);
-    }
-    m_activeProgram = 2;
-    float x = pos.x, y = pos.y;
-    char* text_ptr = const_cast<char*>(text.c_str());
+    float x = pos.x;
     // Height of font, allowing for descenders, because baseline is bottom of capitals.
-    const float height = font.size * Scale() * c_pointsToPixels * 0.8f;
+    const float height = font.GetSize() * Scale() * c_pointsToPixels * 0.8f;
 
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
-        const auto c = wide_char - BeginCharacter;
+        if (wide_char < BeginCharacter)
+            continue;
 
-        if (wide_char < BeginCharacter || wide_char > LastCharacter)
+        const GlyphCache::Glyph* glyph = m_glyphCache.GetGlyph(fontData.glyphs.id, wide_char);
+        if (glyph == nullptr)
             continue;
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()),
-            fontData.width, fontData.height,
-            c,
-            &x, &y, &q, 1); // 1=opengl & d3d10+,0=d3d9
+        Rect rect(std::floor(x + glyph->offset.x + 0.5f), pos.y + glyph->offset.y + height,
+                  glyph->rect.w, glyph->rect.h);
+        x += glyph->advance;
+
+        if (glyph->page < 0)
+            continue;
 
-        Rect rect(q.x0, q.y0 + height, q.x1 - q.x0, q.y1 - q.y0);
+        BindGlyphPage(glyph->page);
+        m_activeProgram = 2;
+
+        const Point pageSize = m_glyphCache.GetPage(glyph->page).size;
+        const float s0 = float(glyph->rect.x) / pageSize.x;
+        const float t0 = float(glyph->rect.y) / pageSize.y;
+        const float s1 = float(glyph->rect.Right()) / pageSize.x;
+        const float t1 = float(glyph->rect.Bottom()) / pageSize.y;
 
         Translate(rect);
 
-        AddVert(rect.x, rect.y, q.s0, q.t0);
-        AddVert(rect.x + rect.w, rect.y, q.s1, q.t0);
-        AddVert(rect.x, rect.y + rect.h, q.s0, q.t1);
-        AddVert(rect.x + rect.w, rect.y, q.s1, q.t0);
-        AddVert(rect.x + rect.w, rect.y + rect.h, q.s1, q.t1);
-        AddVert(rect.x, rect.y + rect.h, q.s0, q.t1);
+        AddQuad(rect, s0, t0, s1, t1);
     }
 }
 
@@ -605,29 +869,25 @@ Gwk::Point OpenGLCore::MeasureText(const Gwk::Font& font, const Gwk::String& tex
     if (!EnsureFont(font))
         return Gwk::Point(0, 0);
 
-    GLFontData& fontData = m_lastFont->second;
+    const GLFontData& fontData = m_lastFont->second;
 
-    Point sz(0, font.size * Scale() * c_pointsToPixels);
+    Point sz(0, font.GetSize() * Scale() * c_pointsToPixels);
 
-    float x = 0.f, y = 0.f;
-    char* text_ptr = const_cast<char*>(text.c_str());
+    float x = 0.f;
 
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
-        const auto c = wide_char - BeginCharacter;
-
-        if (wide_char < BeginCharacter || wide_char > LastCharacter)
+        if (wide_char < BeginCharacter)
             continue;
 
+        const GlyphCache::Glyph* glyph = m_glyphCache.GetGlyph(fontData.glyphs.id, wide_char);
+        if (glyph == nullptr)
+            continue;
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()),
-            fontData.width, fontData.height,
-            c,
-            &x, &y, &q, 1); // 1=opengl & d3d10+,0=d3d9
-
-        sz.x = q.x1;
-        sz.y = std::max(sz.y, int((q.y1 - q.y0) * c_pointsToPixels));
+        sz.x = std::floor(x + glyph->offset.x + 0.5f) + glyph->rect.w;
+        sz.y = std::max(sz.y, int(glyph->rect.h * c_pointsToPixels));
+        x += glyph->advance;
     }
 
     return sz;
@@ -19,9 +19,9 @@ Font::Status SDL2::LoadFont(const Font& font)
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.facename);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
 
-    TTF_Font *tfont = TTF_OpenFont(filename.c_str(), font.size * Scale());
+    TTF_Font *tfont = TTF_OpenFont(filename.c_str(), font.GetSize() * Scale());
     if (tfont)
     {
         SDL2FontData fontData;
@@ -72,7 +72,7 @@ Texture::Status SDL2::LoadTexture(const Texture& texture)
     FreeTexture(texture);
     m_lastTexture = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
     SDL_Texture *tex = nullptr;
     SDL2TextureData texData;
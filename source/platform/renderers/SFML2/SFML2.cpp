@@ -36,7 +36,7 @@ Font::Status Gwk::Renderer::SFML2::LoadFont(const Gwk::Font& font)
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.facename);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
 
     std::unique_ptr<sf::Font> sfFont{new sf::Font()};
 
@@ -93,7 +93,7 @@ Texture::Status Gwk::Renderer::SFML2::LoadTexture(const Gwk::Texture& texture)
     sf::Texture* tex = new sf::Texture();
     tex->setSmooth(true);
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
 
     if (tex->loadFromFile(filename))
     {
@@ -325,7 +325,7 @@ void Gwk::Renderer::SFML2::RenderText(const Gwk::Font& font, Gwk::Point pos,
     sfStr.setString(text);
     sfStr.setFont(*fontData.font);
     sfStr.move(pos.x, pos.y);
-    sfStr.setCharacterSize(font.size * Scale());
+    sfStr.setCharacterSize(font.GetSize() * Scale());
     sfStr.setColor(m_color);
     m_target.draw(sfStr);
 }
@@ -341,7 +341,7 @@ Gwk::Point Gwk::Renderer::SFML2::MeasureText(const Gwk::Font& font, const Gwk::S
     sfStr.setString(text);
     sfStr.setFont(*fontData.font);
     sfStr.setScale(Scale(), Scale());
-    sfStr.setCharacterSize(font.size * Scale());
+    sfStr.setCharacterSize(font.GetSize() * Scale());
     sf::FloatRect sz = sfStr.getLocalBounds();
     return Gwk::Point(sz.left+sz.width, sz.top+sz.height);
 }
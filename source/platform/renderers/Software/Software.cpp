@@ -5,16 +5,21 @@
  */
 
 #include <Gwork/Renderers/Software.h>
+#include <Gwork/DiskCache.h>
+#include <Gwork/JobSystem.h>
 #include <Gwork/PlatformCommon.h>
 #include <Gwork/Utility.h>
-#define STB_IMAGE_IMPLEMENTATION
-#include <Gwork/External/stb_image.h>
-#define STB_TRUETYPE_IMPLEMENTATION
-#define STBTT_STATIC
-#include <Gwork/External/stb_truetype.h>
 #include <sys/stat.h>
 
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if GWK_SIMD
+#   include <emmintrin.h>   // SSE2
+#   include <immintrin.h>   // AVX2
+#endif
 
 namespace Gwk
 {
@@ -23,132 +28,1350 @@ namespace Renderer
 
 namespace Drawing
 {
+    //! Divide by 255, rounding to nearest. Exact for t <= 255*255.
+    static inline unsigned int Div255(unsigned int t)
+    {
+        t += 128;
+        return (t + (t >> 8)) >> 8;
+    }
+
+    //! How draws blend into the pixel buffer.
+    enum class BlendMode
+    {
+        Straight,       //!< Straight alpha. The alpha written is the source's.
+        Over,           //!< Straight alpha, with the alpha composited over the
+                        //!< destination's. Drawing over transparent black then
+                        //!< leaves premultiplied colors.
+        Premultiplied   //!< Premultiplied alpha.
+    };
+
     //! Blend two colors using: result = S_rgb*S_alpha + D_rgb*(1 - S_alpha)
-    static inline Color BlendAlpha(Color const& src, Color const& dst)
+    //! The alpha is the source's or, if \p over, blended the same way with S
+    //! as opaque.
+    static inline Color BlendAlpha(Color const& src, Color const& dst, bool over = false)
     {
         // use fixed point to blend
         constexpr unsigned sh = 16;
         constexpr uint32_t s = (1u << sh) / (255u);
         const uint32_t a = (src.a * s);
-        const uint32_t b = (1u << sh) - a;;
-        
+        const uint32_t b = (1u << sh) - a;
+
         const Color r(((src.r * a) + (dst.r * b)) >> sh,
                       ((src.g * a) + (dst.g * b)) >> sh,
                       ((src.b * a) + (dst.b * b)) >> sh,
-                      src.a);
+                      over ? ((255u * a) + (dst.a * b)) >> sh : src.a);
         return r;
     }
 
-    //! Draw filled rectangle.
-    template <typename T>
-    void RectFill(T& pb, Rect const& r, Color const& c)
+    //! Blend a premultiplied color over another: result = S + D*(1 - S_alpha)
+    static inline Color BlendPremultiplied(Color const& src, Color const& dst)
     {
-        for (int y = 0; y < r.h; ++y)
+        const unsigned int b = 255u - src.a;
+
+        return Color(src.r + Div255(dst.r * b),
+                     src.g + Div255(dst.g * b),
+                     src.b + Div255(dst.b * b),
+                     src.a + Div255(dst.a * b));
+    }
+
+    //! Multiply the color channels by the alpha.
+    static inline Color Premultiply(Color const& c)
+    {
+        return Color(Div255(c.r * c.a), Div255(c.g * c.a), Div255(c.b * c.a), c.a);
+    }
+
+    //! Divide the color channels by the alpha, undoing Premultiply().
+    static inline Color Unpremultiply(Color const& c)
+    {
+        if (c.a == 0 || c.a == 255)
+            return c;
+
+        const unsigned int half = c.a / 2u;
+        return Color(std::min(255u, (c.r * 255u + half) / c.a),
+                     std::min(255u, (c.g * 255u + half) / c.a),
+                     std::min(255u, (c.b * 255u + half) / c.a),
+                     c.a);
+    }
+
+    //
+    // Span kernels. These blend a row of pixels. The scalar versions call
+    // BlendAlpha() for every pixel and are the reference that the SIMD
+    // versions match bit for bit. Only the SIMD versions have fast paths for
+    // fully opaque and fully transparent sources.
+    //
+
+    static void FillSpanScalar(Color* dst, int n, Color c, bool over)
+    {
+        for (; n > 0; --n, ++dst)
+            *dst = BlendAlpha(c, *dst, over);
+    }
+
+    static void BlendSpanScalar(Color* dst, const Color* src, int n, bool over)
+    {
+        for (; n > 0; --n, ++dst, ++src)
+            *dst = BlendAlpha(*src, *dst, over);
+    }
+
+    static void MaskSpanScalar(Color* dst, const unsigned char* mask, int n, Color c, bool over)
+    {
+        for (; n > 0; --n, ++dst, ++mask)
+        {
+            c.a = *mask;
+            *dst = BlendAlpha(c, *dst, over);
+        }
+    }
+
+    static void FillSpanPremultipliedScalar(Color* dst, int n, Color c)
+    {
+        // S + Div255(D*(255 - S_alpha)) is Div255(S*255 + D*(255 - S_alpha)), as
+        // S <= S_alpha. The S*255 terms are worked out once.
+        const unsigned int r = c.r * 255u, g = c.g * 255u, b = c.b * 255u, a = c.a * 255u;
+        const unsigned int inv = 255u - c.a;
+        for (; n > 0; --n, ++dst)
+        {
+            *dst = Color(Div255(r + dst->r * inv), Div255(g + dst->g * inv),
+                         Div255(b + dst->b * inv), Div255(a + dst->a * inv));
+        }
+    }
+
+    static void BlendSpanPremultipliedScalar(Color* dst, const Color* src, int n)
+    {
+        for (; n > 0; --n, ++dst, ++src)
+        {
+            if (src->a == 255)
+                *dst = *src;
+            else if (src->a != 0)
+                *dst = BlendPremultiplied(*src, *dst);
+        }
+    }
+
+    //
+    // Gradient kernels. These write a row of interpolated colors. Channel
+    // c of pixel i is (start[c] + i * step[c]) >> 16, where start includes
+    // the rounding.
+    //
+
+    // Pack channels in 16.16 fixed point into a pixel.
+    static inline unsigned int PackFixed(int r, int g, int b, int a)
+    {
+        return (static_cast<unsigned int>(r) >> 16)
+               | ((static_cast<unsigned int>(g) >> 8) & 0xff00u)
+               | (static_cast<unsigned int>(b) & 0xff0000u)
+               | ((static_cast<unsigned int>(a) << 8) & 0xff000000u);
+    }
+
+    static void GradientSpanScalar(Color* dst, int n, const int* start, const int* step)
+    {
+        int r = start[0], g = start[1], b = start[2], a = start[3];
+        for (; n > 0; --n, ++dst)
+        {
+            dst->rgba = PackFixed(r, g, b, a);
+            r += step[0];
+            g += step[1];
+            b += step[2];
+            a += step[3];
+        }
+    }
+
+#if GWK_SIMD
+
+    // Blend 2 pixels, in 16 bit channels, as BlendAlpha() does. Every channel
+    // of "a" holds its pixel's alpha times 257. (S*a + D*(65536 - a)) >> 16 is
+    // worked out as D + ((S - D)*a >> 16). The high half of the unsigned
+    // product is a too large where S - D is negative.
+    GWK_TARGET_SSE2
+    static inline __m128i Blend16(__m128i s, __m128i d, __m128i a)
+    {
+        const __m128i diff = _mm_sub_epi16(s, d);
+        const __m128i t = _mm_sub_epi16(_mm_mulhi_epu16(diff, a),
+                                        _mm_and_si128(_mm_srai_epi16(diff, 15), a));
+        return _mm_add_epi16(d, t);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i Blend16(__m256i s, __m256i d, __m256i a)
+    {
+        const __m256i diff = _mm256_sub_epi16(s, d);
+        const __m256i t = _mm256_sub_epi16(_mm256_mulhi_epu16(diff, a),
+                                           _mm256_and_si256(_mm256_srai_epi16(diff, 15), a));
+        return _mm256_add_epi16(d, t);
+    }
+
+    // Blend 2 premultiplied pixels, in 16 bit channels.
+    GWK_TARGET_SSE2
+    static inline __m128i BlendPremultiplied16(__m128i s, __m128i d, __m128i a)
+    {
+        const __m128i c255 = _mm_set1_epi16(255);
+        const __m128i c128 = _mm_set1_epi16(128);
+        const __m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(c255, a)), c128);
+        return _mm_add_epi16(s, _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8));
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i BlendPremultiplied16(__m256i s, __m256i d, __m256i a)
+    {
+        const __m256i c255 = _mm256_set1_epi16(255);
+        const __m256i c128 = _mm256_set1_epi16(128);
+        const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_sub_epi16(c255, a)), c128);
+        return _mm256_add_epi16(s, _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8));
+    }
+
+    // Copy the alpha of each pixel to all of its 16 bit channels.
+    GWK_TARGET_SSE2
+    static inline __m128i SpreadAlpha(__m128i px16)
+    {
+        return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px16, _MM_SHUFFLE(3,3,3,3)),
+                                   _MM_SHUFFLE(3,3,3,3));
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i SpreadAlpha(__m256i px16)
+    {
+        return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px16, _MM_SHUFFLE(3,3,3,3)),
+                                      _MM_SHUFFLE(3,3,3,3));
+    }
+
+    // The alpha of each pixel times 257, in all of its 16 bit channels.
+    GWK_TARGET_SSE2
+    static inline __m128i AlphaFactor(__m128i px16)
+    {
+        const __m128i a = SpreadAlpha(px16);
+        return _mm_or_si128(_mm_slli_epi16(a, 8), a);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i AlphaFactor(__m256i px16)
+    {
+        const __m256i a = SpreadAlpha(px16);
+        return _mm256_or_si256(_mm256_slli_epi16(a, 8), a);
+    }
+
+    // Alpha channels of the source to write as they are: all of them, unless
+    // the alpha is composited over.
+    GWK_TARGET_SSE2
+    static inline __m128i KeepMask4(bool over)
+    {
+        return _mm_set1_epi32(over ? 0 : static_cast<int>(0xff000000));
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i KeepMask8(bool over)
+    {
+        return _mm256_set1_epi32(over ? 0 : static_cast<int>(0xff000000));
+    }
+
+    GWK_TARGET_SSE2
+    static inline __m128i KeepAlpha(__m128i blended, __m128i src, __m128i keep)
+    {
+        return _mm_or_si128(_mm_andnot_si128(keep, blended), _mm_and_si128(keep, src));
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i KeepAlpha(__m256i blended, __m256i src, __m256i keep)
+    {
+        return _mm256_or_si256(_mm256_andnot_si256(keep, blended), _mm256_and_si256(keep, src));
+    }
+
+    // Blend 4 pixels. The source alpha channels are blended as 255.
+    GWK_TARGET_SSE2
+    static inline __m128i Blend4(__m128i src, __m128i dst, __m128i keep)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+        const __m128i s = _mm_or_si128(src, opaque);
+        const __m128i lo = Blend16(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(dst, zero),
+                                   AlphaFactor(_mm_unpacklo_epi8(src, zero)));
+        const __m128i hi = Blend16(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(dst, zero),
+                                   AlphaFactor(_mm_unpackhi_epi8(src, zero)));
+        return KeepAlpha(_mm_packus_epi16(lo, hi), src, keep);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i Blend8(__m256i src, __m256i dst, __m256i keep)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xff000000));
+        const __m256i s = _mm256_or_si256(src, opaque);
+        const __m256i lo = Blend16(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(dst, zero),
+                                   AlphaFactor(_mm256_unpacklo_epi8(src, zero)));
+        const __m256i hi = Blend16(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(dst, zero),
+                                   AlphaFactor(_mm256_unpackhi_epi8(src, zero)));
+        return KeepAlpha(_mm256_packus_epi16(lo, hi), src, keep);
+    }
+
+    // Blend 4 opaque pixels. BlendAlpha() gives S where D >= S, else S - 1,
+    // which is max(S - 1, min(S, D)) in every channel.
+    GWK_TARGET_SSE2
+    static inline __m128i BlendOpaque4(__m128i src, __m128i dst, __m128i keep)
+    {
+        const __m128i low = _mm_subs_epu8(src, _mm_set1_epi8(1));
+        return KeepAlpha(_mm_max_epu8(low, _mm_min_epu8(src, dst)), src, keep);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i BlendOpaque8(__m256i src, __m256i dst, __m256i keep)
+    {
+        const __m256i low = _mm256_subs_epu8(src, _mm256_set1_epi8(1));
+        return KeepAlpha(_mm256_max_epu8(low, _mm256_min_epu8(src, dst)), src, keep);
+    }
+
+    GWK_TARGET_SSE2
+    static inline __m128i BlendPremultiplied4(__m128i src, __m128i dst)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i slo = _mm_unpacklo_epi8(src, zero);
+        const __m128i shi = _mm_unpackhi_epi8(src, zero);
+        const __m128i lo = BlendPremultiplied16(slo, _mm_unpacklo_epi8(dst, zero), SpreadAlpha(slo));
+        const __m128i hi = BlendPremultiplied16(shi, _mm_unpackhi_epi8(dst, zero), SpreadAlpha(shi));
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i BlendPremultiplied8(__m256i src, __m256i dst)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i slo = _mm256_unpacklo_epi8(src, zero);
+        const __m256i shi = _mm256_unpackhi_epi8(src, zero);
+        const __m256i lo = BlendPremultiplied16(slo, _mm256_unpacklo_epi8(dst, zero), SpreadAlpha(slo));
+        const __m256i hi = BlendPremultiplied16(shi, _mm256_unpackhi_epi8(dst, zero), SpreadAlpha(shi));
+        return _mm256_packus_epi16(lo, hi);
+    }
+
+    // The source channels and alpha factor of a fill are worked out once.
+    GWK_TARGET_SSE2
+    static void FillSpanSSE2(Color* dst, int n, Color c, bool over)
+    {
+        if (c.a == 0 && over)
+            return;
+
+        const __m128i src = _mm_set1_epi32(static_cast<int>(c.rgba));
+        const __m128i keep = KeepMask4(over);
+        if (c.a == 255)
+        {
+            for (; n >= 4; n -= 4, dst += 4)
+            {
+                __m128i* p = reinterpret_cast<__m128i*>(dst);
+                _mm_storeu_si128(p, BlendOpaque4(src, _mm_loadu_si128(p), keep));
+            }
+        }
+        else
         {
-            Color *px = &pb.At(r.x, r.y + y);
-            for (int x = r.w; x > 0; --x)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+            const __m128i s = _mm_unpacklo_epi8(_mm_or_si128(src, opaque), zero);
+            const __m128i a = AlphaFactor(_mm_unpacklo_epi8(src, zero));
+            for (; n >= 4; n -= 4, dst += 4)
             {
-                *px = BlendAlpha(c, *px);
-                ++px;
+                __m128i* p = reinterpret_cast<__m128i*>(dst);
+                const __m128i d = _mm_loadu_si128(p);
+                const __m128i lo = Blend16(s, _mm_unpacklo_epi8(d, zero), a);
+                const __m128i hi = Blend16(s, _mm_unpackhi_epi8(d, zero), a);
+                _mm_storeu_si128(p, KeepAlpha(_mm_packus_epi16(lo, hi), src, keep));
             }
         }
+        FillSpanScalar(dst, n, c, over);
     }
 
-    //! Draw rectangle outline.
-    template <typename T>
-    void RectOutline(T& pb, Rect const& r, Color const& c)
+    GWK_TARGET_AVX2
+    static void FillSpanAVX2(Color* dst, int n, Color c, bool over)
     {
-        for (int x = 0; x < r.w; ++x)
+        if (c.a == 0 && over)
+            return;
+
+        const __m256i src = _mm256_set1_epi32(static_cast<int>(c.rgba));
+        const __m256i keep = KeepMask8(over);
+        if (c.a == 255)
         {
-            pb.At(r.x + x, r.y) = BlendAlpha(c, pb.At(r.x + x, r.y));  // top
-            if (r.h > 1)
-                pb.At(r.x + x, r.y + r.h - 1) = BlendAlpha(c, pb.At(r.x + x, r.y + r.h - 1));  // bottom
+            for (; n >= 8; n -= 8, dst += 8)
+            {
+                __m256i* p = reinterpret_cast<__m256i*>(dst);
+                _mm256_storeu_si256(p, BlendOpaque8(src, _mm256_loadu_si256(p), keep));
+            }
         }
-        for (int y = 0; y < r.h; ++y)
+        else
         {
-            pb.At(r.x, r.y + y) = BlendAlpha(c, pb.At(r.x, r.y + y));  // left
-            if (r.w > 1)
-                pb.At(r.x + r.w - 1, r.y + y) = BlendAlpha(c, pb.At(r.x + r.w - 1, r.y + y));  // right
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xff000000));
+            const __m256i s = _mm256_unpacklo_epi8(_mm256_or_si256(src, opaque), zero);
+            const __m256i a = AlphaFactor(_mm256_unpacklo_epi8(src, zero));
+            for (; n >= 8; n -= 8, dst += 8)
+            {
+                __m256i* p = reinterpret_cast<__m256i*>(dst);
+                const __m256i d = _mm256_loadu_si256(p);
+                const __m256i lo = Blend16(s, _mm256_unpacklo_epi8(d, zero), a);
+                const __m256i hi = Blend16(s, _mm256_unpackhi_epi8(d, zero), a);
+                _mm256_storeu_si256(p, KeepAlpha(_mm256_packus_epi16(lo, hi), src, keep));
+            }
+        }
+        // The compiler does not add vzeroupper to these functions. Without it, the
+        // SSE2 code that runs next can be several times slower.
+        _mm256_zeroupper();
+        FillSpanSSE2(dst, n, c, over);
+    }
+
+    // As in the scalar version, S*255 is added before dividing, with the
+    // rounding bias, leaving one multiply per channel.
+    GWK_TARGET_SSE2
+    static void FillSpanPremultipliedSSE2(Color* dst, int n, Color c)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i s = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(c.rgba)), zero);
+        const __m128i bias = _mm_add_epi16(_mm_mullo_epi16(s, _mm_set1_epi16(255)),
+                                           _mm_set1_epi16(128));
+        const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), SpreadAlpha(s));
+        for (; n >= 4; n -= 4, dst += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(dst);
+            const __m128i d = _mm_loadu_si128(p);
+            __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv), bias);
+            __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv), bias);
+            lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+            hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+        FillSpanPremultipliedScalar(dst, n, c);
+    }
+
+    GWK_TARGET_AVX2
+    static void FillSpanPremultipliedAVX2(Color* dst, int n, Color c)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i s = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(c.rgba)), zero);
+        const __m256i bias = _mm256_add_epi16(_mm256_mullo_epi16(s, _mm256_set1_epi16(255)),
+                                              _mm256_set1_epi16(128));
+        const __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), SpreadAlpha(s));
+        for (; n >= 8; n -= 8, dst += 8)
+        {
+            __m256i* p = reinterpret_cast<__m256i*>(dst);
+            const __m256i d = _mm256_loadu_si256(p);
+            __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv), bias);
+            __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv), bias);
+            lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+            hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+            _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+        }
+        _mm256_zeroupper();
+        FillSpanPremultipliedSSE2(dst, n, c);
+    }
+
+    GWK_TARGET_SSE2
+    static void BlendSpanSSE2(Color* dst, const Color* src, int n, bool over)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+        const __m128i keep = KeepMask4(over);
+        for (; n >= 4; n -= 4, dst += 4, src += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128i srcAlpha = _mm_and_si128(s, alpha);
+            __m128i* p = reinterpret_cast<__m128i*>(dst);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(srcAlpha, alpha)) == 0xffff)
+            {
+                _mm_storeu_si128(p, BlendOpaque4(s, _mm_loadu_si128(p), keep));
+                continue;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(srcAlpha, _mm_setzero_si128())) == 0xffff)
+            {
+                // Only the alpha changes, and only if it is the source's.
+                if (!over)
+                    _mm_storeu_si128(p, KeepAlpha(_mm_loadu_si128(p), s, keep));
+                continue;
+            }
+
+            _mm_storeu_si128(p, Blend4(s, _mm_loadu_si128(p), keep));
+        }
+        BlendSpanScalar(dst, src, n, over);
+    }
+
+    GWK_TARGET_AVX2
+    static void BlendSpanAVX2(Color* dst, const Color* src, int n, bool over)
+    {
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000));
+        const __m256i keep = KeepMask8(over);
+        for (; n >= 8; n -= 8, dst += 8, src += 8)
+        {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+            const __m256i srcAlpha = _mm256_and_si256(s, alpha);
+            __m256i* p = reinterpret_cast<__m256i*>(dst);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(srcAlpha, alpha)) == -1)
+            {
+                _mm256_storeu_si256(p, BlendOpaque8(s, _mm256_loadu_si256(p), keep));
+                continue;
+            }
+            if (_mm256_testz_si256(srcAlpha, srcAlpha))
+            {
+                if (!over)
+                    _mm256_storeu_si256(p, KeepAlpha(_mm256_loadu_si256(p), s, keep));
+                continue;
+            }
+
+            _mm256_storeu_si256(p, Blend8(s, _mm256_loadu_si256(p), keep));
         }
+        _mm256_zeroupper();
+        BlendSpanSSE2(dst, src, n, over);
     }
 
-    //! Draw textured rectangle.
+    GWK_TARGET_SSE2
+    static void BlendSpanPremultipliedSSE2(Color* dst, const Color* src, int n)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+        for (; n >= 4; n -= 4, dst += 4, src += 4)
+        {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128i srcAlpha = _mm_and_si128(s, alpha);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(srcAlpha, alpha)) == 0xffff)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), s);
+                continue;
+            }
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(srcAlpha, _mm_setzero_si128())) == 0xffff)
+                continue;
+
+            __m128i* p = reinterpret_cast<__m128i*>(dst);
+            _mm_storeu_si128(p, BlendPremultiplied4(s, _mm_loadu_si128(p)));
+        }
+        BlendSpanPremultipliedScalar(dst, src, n);
+    }
+
+    GWK_TARGET_AVX2
+    static void BlendSpanPremultipliedAVX2(Color* dst, const Color* src, int n)
+    {
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000));
+        for (; n >= 8; n -= 8, dst += 8, src += 8)
+        {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+            const __m256i srcAlpha = _mm256_and_si256(s, alpha);
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(srcAlpha, alpha)) == -1)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), s);
+                continue;
+            }
+            if (_mm256_testz_si256(srcAlpha, srcAlpha))
+                continue;
+
+            __m256i* p = reinterpret_cast<__m256i*>(dst);
+            _mm256_storeu_si256(p, BlendPremultiplied8(s, _mm256_loadu_si256(p)));
+        }
+        _mm256_zeroupper();
+        BlendSpanPremultipliedSSE2(dst, src, n);
+    }
+
+    // Pack 4 pixels, with the channels in 16.16 fixed point.
+    GWK_TARGET_SSE2
+    static inline __m128i PackFixed(__m128i r, __m128i g, __m128i b, __m128i a)
+    {
+        const __m128i px = _mm_or_si128(_mm_srli_epi32(r, 16),
+                                        _mm_and_si128(_mm_srli_epi32(g, 8), _mm_set1_epi32(0xff00)));
+        return _mm_or_si128(px, _mm_or_si128(_mm_and_si128(b, _mm_set1_epi32(0xff0000)),
+                                             _mm_slli_epi32(_mm_srli_epi32(a, 16), 24)));
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i PackFixed(__m256i r, __m256i g, __m256i b, __m256i a)
+    {
+        const __m256i px = _mm256_or_si256(_mm256_srli_epi32(r, 16),
+                                           _mm256_and_si256(_mm256_srli_epi32(g, 8),
+                                                            _mm256_set1_epi32(0xff00)));
+        return _mm256_or_si256(px, _mm256_or_si256(_mm256_and_si256(b, _mm256_set1_epi32(0xff0000)),
+                                                   _mm256_slli_epi32(_mm256_srli_epi32(a, 16), 24)));
+    }
+
+    // Channel c of 4 pixels from i: start + (i + lane) * step.
+    GWK_TARGET_SSE2
+    static inline __m128i Ramp4(int start, int step)
+    {
+        return _mm_setr_epi32(start, start + step, start + 2 * step, start + 3 * step);
+    }
+
+    GWK_TARGET_SSE2
+    static void GradientSpanSSE2(Color* dst, int n, const int* start, const int* step)
+    {
+        __m128i r = Ramp4(start[0], step[0]), g = Ramp4(start[1], step[1]);
+        __m128i b = Ramp4(start[2], step[2]), a = Ramp4(start[3], step[3]);
+        const __m128i dr = _mm_set1_epi32(4 * step[0]), dg = _mm_set1_epi32(4 * step[1]);
+        const __m128i db = _mm_set1_epi32(4 * step[2]), da = _mm_set1_epi32(4 * step[3]);
+
+        int done = 0;
+        for (; n - done >= 4; done += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + done), PackFixed(r, g, b, a));
+            r = _mm_add_epi32(r, dr);
+            g = _mm_add_epi32(g, dg);
+            b = _mm_add_epi32(b, db);
+            a = _mm_add_epi32(a, da);
+        }
+
+        const int rest[4] = { start[0] + done * step[0], start[1] + done * step[1],
+                              start[2] + done * step[2], start[3] + done * step[3] };
+        GradientSpanScalar(dst + done, n - done, rest, step);
+    }
+
+    GWK_TARGET_AVX2
+    static inline __m256i Ramp8(int start, int step)
+    {
+        return _mm256_add_epi32(_mm256_set1_epi32(start),
+                                _mm256_mullo_epi32(_mm256_set1_epi32(step),
+                                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    }
+
+    GWK_TARGET_AVX2
+    static void GradientSpanAVX2(Color* dst, int n, const int* start, const int* step)
+    {
+        __m256i r = Ramp8(start[0], step[0]), g = Ramp8(start[1], step[1]);
+        __m256i b = Ramp8(start[2], step[2]), a = Ramp8(start[3], step[3]);
+        const __m256i dr = _mm256_set1_epi32(8 * step[0]), dg = _mm256_set1_epi32(8 * step[1]);
+        const __m256i db = _mm256_set1_epi32(8 * step[2]), da = _mm256_set1_epi32(8 * step[3]);
+
+        int done = 0;
+        for (; n - done >= 8; done += 8)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + done), PackFixed(r, g, b, a));
+            r = _mm256_add_epi32(r, dr);
+            g = _mm256_add_epi32(g, dg);
+            b = _mm256_add_epi32(b, db);
+            a = _mm256_add_epi32(a, da);
+        }
+        _mm256_zeroupper();
+
+        const int rest[4] = { start[0] + done * step[0], start[1] + done * step[1],
+                              start[2] + done * step[2], start[3] + done * step[3] };
+        GradientSpanSSE2(dst + done, n - done, rest, step);
+    }
+
+    // Blend 4 pixels of the color, with the mask in the alpha channels.
+    GWK_TARGET_SSE2
+    static inline void Mask4(Color* dst, const unsigned char* mask, __m128i rgb, __m128i keep,
+                             bool over)
+    {
+        int m;
+        std::memcpy(&m, mask, sizeof(m));
+        if (m == 0 && over)
+            return;
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i m32 = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(m), zero), zero);
+        const __m128i s = _mm_or_si128(rgb, _mm_slli_epi32(m32, 24));
+
+        __m128i* p = reinterpret_cast<__m128i*>(dst);
+        const __m128i d = _mm_loadu_si128(p);
+        _mm_storeu_si128(p, m == -1 ? BlendOpaque4(s, d, keep) : Blend4(s, d, keep));
+    }
+
+    GWK_TARGET_SSE2
+    static void GlyphMaskSSE2(PixelBuffer& pb, const unsigned char* mask, int pitch,
+                              const unsigned char* maskEnd, const Rect& area, Color c, bool over)
+    {
+        const __m128i rgb = _mm_set1_epi32(static_cast<int>(c.rgba & 0x00ffffff));
+        const __m128i keep = KeepMask4(over);
+        for (int y = area.y; y < area.Bottom(); ++y, mask += pitch)
+        {
+            Color* px = &pb.At(area.x, y);
+            const unsigned char* m = mask;
+            int n = area.w;
+            for (; n >= 4; n -= 4, px += 4, m += 4)
+                Mask4(px, m, rgb, keep, over);
+            MaskSpanScalar(px, m, n, c, over);
+        }
+    }
+
+    // Rows that don't fill a vector end with a masked load and store, as
+    // most glyphs are less than 8 pixels wide.
+    GWK_TARGET_AVX2
+    static void GlyphMaskAVX2(PixelBuffer& pb, const unsigned char* mask, int pitch,
+                              const unsigned char* maskEnd, const Rect& area, Color c, bool over)
+    {
+        const __m256i rgb = _mm256_set1_epi32(static_cast<int>(c.rgba & 0x00ffffff));
+        const __m256i keep = KeepMask8(over);
+        const int tail = area.w & 7;
+        const __m256i lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(tail),
+                                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        const long long tailBytes = tail ? (1ll << (tail * 8)) - 1 : 0;
+        for (int y = area.y; y < area.Bottom(); ++y, mask += pitch)
+        {
+            Color* px = &pb.At(area.x, y);
+            const unsigned char* m = mask;
+            for (int n = area.w - tail; n > 0; n -= 8, px += 8, m += 8)
+            {
+                long long bits;
+                std::memcpy(&bits, m, sizeof(bits));
+                if (bits == 0 && over)
+                    continue;
+
+                const __m256i m32 = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(bits));
+                const __m256i s = _mm256_or_si256(rgb, _mm256_slli_epi32(m32, 24));
+
+                __m256i* p = reinterpret_cast<__m256i*>(px);
+                const __m256i d = _mm256_loadu_si256(p);
+                _mm256_storeu_si256(p, bits == -1 ? BlendOpaque8(s, d, keep) : Blend8(s, d, keep));
+            }
+            if (tail)
+            {
+                // The coverage past the tail is another glyph's, or beyond the page.
+                long long bits = 0;
+                std::memcpy(&bits, m, m + sizeof(bits) <= maskEnd ? sizeof(bits) : tail);
+                bits &= tailBytes;
+                if (bits == 0 && over)
+                    continue;
+
+                const __m256i m32 = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(bits));
+                const __m256i s = _mm256_or_si256(rgb, _mm256_slli_epi32(m32, 24));
+                int* p = reinterpret_cast<int*>(px);
+                _mm256_maskstore_epi32(p, lanes, Blend8(s, _mm256_maskload_epi32(p, lanes), keep));
+            }
+        }
+        _mm256_zeroupper();
+    }
+
+#endif // GWK_SIMD
+
+    //! Blend a color over a row of pixels.
+    //! \param over : Composite the alpha over the destination's.
+    static void FillSpan(Color* dst, int n, Color c, bool over)
+    {
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return FillSpanAVX2(dst, n, c, over);
+        if (cpu.sse2)
+            return FillSpanSSE2(dst, n, c, over);
+#endif
+        FillSpanScalar(dst, n, c, over);
+    }
+
+    //! Blend a row of pixels over another.
+    //! \param over : Composite the alpha over the destination's.
+    static void BlendSpan(Color* dst, const Color* src, int n, bool over)
+    {
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return BlendSpanAVX2(dst, src, n, over);
+        if (cpu.sse2)
+            return BlendSpanSSE2(dst, src, n, over);
+#endif
+        BlendSpanScalar(dst, src, n, over);
+    }
+
+    //! Blend a premultiplied color over a row of pixels.
+    static void FillSpanPremultiplied(Color* dst, int n, Color c)
+    {
+        if (c.a == 0)
+            return;
+
+        if (c.a == 255)
+        {
+            std::fill(dst, dst + n, c);
+            return;
+        }
+
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return FillSpanPremultipliedAVX2(dst, n, c);
+        if (cpu.sse2)
+            return FillSpanPremultipliedSSE2(dst, n, c);
+#endif
+        FillSpanPremultipliedScalar(dst, n, c);
+    }
+
+    //! Blend a row of premultiplied pixels over another.
+    static void BlendSpanPremultiplied(Color* dst, const Color* src, int n)
+    {
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return BlendSpanPremultipliedAVX2(dst, src, n);
+        if (cpu.sse2)
+            return BlendSpanPremultipliedSSE2(dst, src, n);
+#endif
+        BlendSpanPremultipliedScalar(dst, src, n);
+    }
+
+    //! Write a row of interpolated colors.
+    static void GradientSpan(Color* dst, int n, const int* start, const int* step)
+    {
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return GradientSpanAVX2(dst, n, start, step);
+        if (cpu.sse2)
+            return GradientSpanSSE2(dst, n, start, step);
+#endif
+        GradientSpanScalar(dst, n, start, step);
+    }
+
+    //! Blend a color over a row of pixels, in \p mode.
+    static void Fill(Color* dst, int n, Color c, BlendMode mode)
+    {
+        if (mode == BlendMode::Premultiplied)
+            FillSpanPremultiplied(dst, n, c);
+        else
+            FillSpan(dst, n, c, mode == BlendMode::Over);
+    }
+
+    //! Blend a row of pixels over another, in \p mode.
+    static void Blend(Color* dst, const Color* src, int n, BlendMode mode)
+    {
+        if (mode == BlendMode::Premultiplied)
+            BlendSpanPremultiplied(dst, src, n);
+        else
+            BlendSpan(dst, src, n, mode == BlendMode::Over);
+    }
+
+    //! Blend a color over a rectangle, using a coverage mask as the alpha.
+    //! Used for glyphs, which are drawn in one call rather than by the row.
+    //! The coverage is the alpha, so this blends the same into premultiplied
+    //! buffers, with \p over set.
+    //! \param mask : Coverage of the top-left pixel drawn.
+    //! \param pitch : Bytes from one row of the mask to the next.
+    //! \param maskEnd : End of the mask memory, which is not read past.
+    //! \param area : Pixels drawn.
+    //! \param over : Composite the alpha over the destination's.
+    static void GlyphMask(PixelBuffer& pb, const unsigned char* mask, int pitch,
+                          const unsigned char* maskEnd, const Rect& area, Color c, bool over)
+    {
+#if GWK_SIMD
+        const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+        if (cpu.avx2)
+            return GlyphMaskAVX2(pb, mask, pitch, maskEnd, area, c, over);
+        if (cpu.sse2)
+            return GlyphMaskSSE2(pb, mask, pitch, maskEnd, area, c, over);
+#endif
+        for (int y = area.y; y < area.Bottom(); ++y, mask += pitch)
+            MaskSpanScalar(&pb.At(area.x, y), mask, area.w, c, over);
+    }
+
+    //! Draw filled rectangle.
+    template <typename T>
+    void RectFill(T& pb, Rect const& r, Color const& c, BlendMode mode)
+    {
+        for (int y = 0; y < r.h; ++y)
+            Fill(&pb.At(r.x, r.y + y), r.w, c, mode);
+    }
+
+    //! Draw the part of a textured rectangle inside \p clip.
+    //! \param rect : Area the texture coordinates are stretched over.
     template <typename T, typename U>
     void RectTextured(T& pb, const U& pbsrc,
-                      const Gwk::Rect& rect, float u1, float v1, float u2, float v2)
+                      const Gwk::Rect& rect, float u1, float v1, float u2, float v2,
+                      const Gwk::Rect& clip, BlendMode mode)
     {
         const Point srcsz(pbsrc.GetSize());
         const Point uvtl(srcsz.x * u1, srcsz.y * v1);
 
-        const float dv = (v2 - v1) * srcsz.y / rect.h;
-        float v = uvtl.y;
-        for (int y = 0; y < rect.h; ++y)
+        // Step through the texture in 16.16 fixed point. Unlike adding floats,
+        // this gives the same texels wherever the clip rect starts.
+        const int du = static_cast<int>(std::lround((u2 - u1) * srcsz.x / rect.w * 65536.f));
+        const int dv = static_cast<int>(std::lround((v2 - v1) * srcsz.y / rect.h * 65536.f));
+
+        const int left = clip.x - rect.x;
+        const int right = clip.Right() - rect.x;
+
+        // Unscaled rows are blended straight from the texture.
+        if (du == 0x10000)
+        {
+            for (int y = clip.y - rect.y; y < clip.Bottom() - rect.y; ++y)
+            {
+                const int v = uvtl.y + ((dv * y) >> 16);
+                Blend(&pb.At(clip.x, rect.y + y), &pbsrc.At(uvtl.x + left, v), clip.w, mode);
+            }
+            return;
+        }
+
+        // Otherwise texels are sampled into a small buffer, then blended as a
+        // span. The columns sampled are worked out once per chunk, and rows
+        // that sample the same texture row, as when stretching vertically,
+        // reuse the buffer. Chunks of a single column are filled.
+        constexpr int chunk = 64;
+        int columns[chunk];
+        Color texels[chunk];
+
+        for (int x = left; x < right; x += chunk)
         {
-            const float du = (u2 - u1) * srcsz.x / rect.w;
-            float u = uvtl.x;
-            Color *px = &pb.At(rect.x, rect.y + y);
-            for (int x = 0; x < rect.w; ++x)
+            const int n = std::min(chunk, right - x);
+            int u = du * x;
+            for (int i = 0; i < n; ++i, u += du)
+                columns[i] = uvtl.x + (u >> 16);
+
+            const bool single = columns[0] == columns[n - 1];
+            const int samples = single ? 1 : n;
+
+            int lastV = -1;
+            for (int y = clip.y - rect.y; y < clip.Bottom() - rect.y; ++y)
             {
-                *px = BlendAlpha(pbsrc.At(u, v), *px);
-                ++px;
-                u += du;
+                const int v = uvtl.y + ((dv * y) >> 16);
+                if (v != lastV)
+                {
+                    const Color* row = &pbsrc.At(0, v);
+                    for (int i = 0; i < samples; ++i)
+                        texels[i] = row[columns[i]];
+                    lastV = v;
+                }
+
+                Color* px = &pb.At(rect.x + x, rect.y + y);
+                if (single)
+                    Fill(px, n, texels[0], mode);
+                else
+                    Blend(px, texels, n, mode);
             }
-            v += dv;
         }
     }
+
+    //! Halve the size of an image, averaging each 2x2 block of texels. The
+    //! last row or column of an odd size is dropped.
+    //! \param dst : Destination, half the size of \p src, rounded down and
+    //!              at least 1.
+    //! \param premultiplied : The texels are premultiplied. Otherwise colors
+    //!                        are weighted by alpha, so that the colors of
+    //!                        transparent texels don't bleed in.
+    template <typename U>
+    void Downsample(PixelBuffer& dst, const U& src, bool premultiplied)
+    {
+        const Point srcsz(src.GetSize());
+        const Point dstsz(dst.GetSize());
+
+        for (int y = 0; y < dstsz.y; ++y)
+        {
+            const Color* row0 = &src.At(0, 2 * y);
+            const Color* row1 = &src.At(0, std::min(2 * y + 1, srcsz.y - 1));
+            Color* out = dst.Row(y);
+
+            for (int x = 0; x < dstsz.x; ++x)
+            {
+                const int x0 = 2 * x, x1 = std::min(2 * x + 1, srcsz.x - 1);
+                const Color* block[4] = { &row0[x0], &row0[x1], &row1[x0], &row1[x1] };
+
+                int a = 0, r = 0, g = 0, b = 0;
+                for (const Color* c : block)
+                    a += c->a;
+
+                // Opaque blocks, the most common, need no weighting.
+                if (premultiplied || a == 4 * 255)
+                {
+                    for (const Color* c : block)
+                    {
+                        r += c->r; g += c->g; b += c->b;
+                    }
+                    out[x] = Color((r + 2) >> 2, (g + 2) >> 2, (b + 2) >> 2, (a + 2) >> 2);
+                }
+                else
+                {
+                    for (const Color* c : block)
+                    {
+                        r += c->r * c->a; g += c->g * c->a; b += c->b * c->a;
+                    }
+                    if (a == 0)
+                        out[x] = Color(0, 0, 0, 0);
+                    else
+                        out[x] = Color((r + a / 2) / a, (g + a / 2) / a, (b + a / 2) / a,
+                                       (a + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    //! Draw the part of a gradient inside \p clip.
+    //! \param rect : Area the gradient is stretched over.
+    //! \param corners : Colors of the top-left, top-right, bottom-left and
+    //!                  bottom-right pixels of \p rect.
+    template <typename T>
+    void RectGradient(T& pb, const Gwk::Rect& rect, const Color* corners, const Gwk::Rect& clip,
+                      BlendMode mode)
+    {
+        const Color& tl = corners[0];
+        const Color& tr = corners[1];
+        const Color& bl = corners[2];
+        const Color& br = corners[3];
+        const int top[4] = { tl.r, tl.g, tl.b, tl.a }, topRight[4] = { tr.r, tr.g, tr.b, tr.a };
+        const int bottom[4] = { bl.r, bl.g, bl.b, bl.a };
+        const int bottomRight[4] = { br.r, br.g, br.b, br.a };
+
+        // Colors are interpolated in 16.16 fixed point, so every part of the
+        // gradient is drawn the same however it is clipped.
+        auto edge = [&](int from, int to, int y) -> int
+        {
+            return (from << 16) + (rect.h > 1 ? static_cast<int>(
+                (static_cast<long long>(to - from) * 65536 * y) / (rect.h - 1)) : 0);
+        };
+
+        constexpr int chunk = 64;
+        Color colors[chunk];
+
+        for (int y = clip.y - rect.y; y < clip.Bottom() - rect.y; ++y)
+        {
+            int start[4], step[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const int left = edge(top[c], bottom[c], y);
+                const int right = edge(topRight[c], bottomRight[c], y);
+                step[c] = rect.w > 1 ? (right - left) / (rect.w - 1) : 0;
+                start[c] = left + 0x8000 + (clip.x - rect.x) * step[c];
+            }
+
+            Color* px = &pb.At(clip.x, rect.y + y);
+            for (int x = 0; x < clip.w; x += chunk)
+            {
+                const int n = std::min(chunk, clip.w - x);
+                GradientSpan(colors, n, start, step);
+                Blend(px + x, colors, n, mode);
+                for (int c = 0; c < 4; ++c)
+                    start[c] += n * step[c];
+            }
+        }
+    }
+
+    //! Draw the part of a premultiplied buffer inside \p clip, unscaled.
+    //! \param pos : Where the top-left of the buffer is drawn.
+    template <typename T>
+    void RectPremultiplied(T& pb, const PixelBuffer& src, Point pos, const Gwk::Rect& clip)
+    {
+        for (int y = clip.y; y < clip.Bottom(); ++y)
+            BlendSpanPremultiplied(&pb.At(clip.x, y), &src.At(clip.x - pos.x, y - pos.y), clip.w);
+    }
+
+    //! Draw the part of a distance field glyph inside \p clip.
+    //! \param src : Area of the glyph in the page.
+    //! \param gx, gy : Where the top-left of the glyph is drawn.
+    //! \param scale : Size of a glyph pixel, in target pixels.
+    //! \param over : Composite the alpha over the destination's.
+    template <typename T>
+    void GlyphDistanceField(T& pb, const GlyphCache::Page& page, const Rect& src,
+                            float gx, float gy, float scale, const Rect& clip, Color c,
+                            bool over)
+    {
+        const float invScale = 1.f / scale;
+        // Converts a distance field value to a distance in target pixels.
+        const float distToPixels = scale / GlyphCache::SdfPixelDistScale;
+
+        // Value of a field pixel. Beyond the glyph is outside the outline.
+        auto field = [&](int fx, int fy) -> int
+        {
+            if (fx < 0 || fy < 0 || fx >= src.w || fy >= src.h)
+                return 0;
+            return page.pixels[(src.y + fy) * page.size.x + src.x + fx];
+        };
+
+        for (int py = clip.y; py < clip.Bottom(); ++py)
+        {
+            // Bilinear sample at the centre of the target pixel.
+            const float v = (py + 0.5f - gy) * invScale - 0.5f;
+            const int fy = int(std::floor(v));
+            const float ty = v - fy;
+
+            Color* px = &pb.At(clip.x, py);
+            for (int pxx = clip.x; pxx < clip.Right(); ++pxx, ++px)
+            {
+                const float u = (pxx + 0.5f - gx) * invScale - 0.5f;
+                const int fx = int(std::floor(u));
+                const float tx = u - fx;
+
+                const float top = field(fx, fy) + (field(fx + 1, fy) - field(fx, fy)) * tx;
+                const float bot = field(fx, fy + 1) + (field(fx + 1, fy + 1) - field(fx, fy + 1)) * tx;
+                const float value = top + (bot - top) * ty;
+
+                // Coverage from the distance of the pixel centre to the outline.
+                const float d = (value - GlyphCache::SdfOnEdge) * distToPixels + 0.5f;
+                if (d <= 0.f)
+                    continue;
+
+                c.a = d >= 1.f ? 255 : static_cast<unsigned char>(d * 255.f);
+                *px = BlendAlpha(c, *px, over);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------
+
+//
+// Pixel format conversion, a row at a time. Pixels are read as 32 bit words,
+// with R in the low byte.
+//
+
+static void ConvertRowBGRAScalar(const Color* src, unsigned int* dst, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        const unsigned int px = src[i].rgba;
+        dst[i] = (px & 0xff00ff00u) | ((px >> 16) & 0xffu) | ((px & 0xffu) << 16);
+    }
+}
+
+static void ConvertRowRGBXScalar(const Color* src, unsigned int* dst, int n)
+{
+    for (int i = 0; i < n; ++i)
+        dst[i] = src[i].rgba | 0xff000000u;
+}
+
+static void ConvertRowRGB565Scalar(const Color* src, unsigned short* dst, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        const unsigned int px = src[i].rgba;
+        dst[i] = static_cast<unsigned short>(((px & 0xf8u) << 8)
+                                             | ((px & 0xfc00u) >> 5)
+                                             | ((px & 0xf80000u) >> 19));
+    }
+}
+
+#if GWK_SIMD
+
+GWK_TARGET_SSE2
+static void ConvertRowBGRASSE2(const Color* src, unsigned int* dst, int n)
+{
+    const __m128i ga = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+    const __m128i low = _mm_set1_epi32(0xff);
+    for (; n >= 4; n -= 4, src += 4, dst += 4)
+    {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i rb = _mm_andnot_si128(ga, px);
+        const __m128i out = _mm_or_si128(_mm_and_si128(px, ga),
+                                         _mm_or_si128(_mm_srli_epi32(rb, 16),
+                                                      _mm_slli_epi32(_mm_and_si128(rb, low), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), out);
+    }
+    ConvertRowBGRAScalar(src, dst, n);
+}
+
+GWK_TARGET_AVX2
+static void ConvertRowBGRAAVX2(const Color* src, unsigned int* dst, int n)
+{
+    const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; n >= 8; n -= 8, src += 8, dst += 8)
+    {
+        const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(px, swap));
+    }
+    _mm256_zeroupper();
+    ConvertRowBGRASSE2(src, dst, n);
+}
+
+GWK_TARGET_SSE2
+static void ConvertRowRGBXSSE2(const Color* src, unsigned int* dst, int n)
+{
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    for (; n >= 4; n -= 4, src += 4, dst += 4)
+    {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(px, alpha));
+    }
+    ConvertRowRGBXScalar(src, dst, n);
+}
+
+GWK_TARGET_AVX2
+static void ConvertRowRGBXAVX2(const Color* src, unsigned int* dst, int n)
+{
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    for (; n >= 8; n -= 8, src += 8, dst += 8)
+    {
+        const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_or_si256(px, alpha));
+    }
+    _mm256_zeroupper();
+    ConvertRowRGBXSSE2(src, dst, n);
+}
+
+// Pack 4 pixels to 565, in the low 16 bits of each 32 bit lane.
+GWK_TARGET_SSE2
+static inline __m128i Pack565(__m128i px)
+{
+    const __m128i r = _mm_slli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xf8)), 8);
+    const __m128i g = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xfc00)), 5);
+    const __m128i b = _mm_srli_epi32(_mm_and_si128(px, _mm_set1_epi32(0xf80000)), 19);
+    return _mm_or_si128(r, _mm_or_si128(g, b));
+}
+
+GWK_TARGET_AVX2
+static inline __m256i Pack565(__m256i px)
+{
+    const __m256i r = _mm256_slli_epi32(_mm256_and_si256(px, _mm256_set1_epi32(0xf8)), 8);
+    const __m256i g = _mm256_srli_epi32(_mm256_and_si256(px, _mm256_set1_epi32(0xfc00)), 5);
+    const __m256i b = _mm256_srli_epi32(_mm256_and_si256(px, _mm256_set1_epi32(0xf80000)), 19);
+    return _mm256_or_si256(r, _mm256_or_si256(g, b));
+}
+
+GWK_TARGET_SSE2
+static void ConvertRowRGB565SSE2(const Color* src, unsigned short* dst, int n)
+{
+    // SSE2 can only pack with signed saturation, so bias the values into range.
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (; n >= 8; n -= 8, src += 8, dst += 8)
+    {
+        const __m128i a = Pack565(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+        const __m128i b = Pack565(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4)));
+        const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_xor_si128(packed, bias16));
+    }
+    ConvertRowRGB565Scalar(src, dst, n);
+}
+
+GWK_TARGET_AVX2
+static void ConvertRowRGB565AVX2(const Color* src, unsigned short* dst, int n)
+{
+    for (; n >= 16; n -= 16, src += 16, dst += 16)
+    {
+        const __m256i a = Pack565(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+        const __m256i b = Pack565(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 8)));
+        // packus works within 128 bit lanes, so put the quarters back in order.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b),
+                                                        _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+    }
+    _mm256_zeroupper();
+    ConvertRowRGB565SSE2(src, dst, n);
+}
+
+#endif // GWK_SIMD
+
+PixelBuffer::PixelBuffer()
+    :   m_buffer(nullptr)
+    ,   m_stride(0)
+{
+}
+
+PixelBuffer::~PixelBuffer()
+{
+}
+
+void PixelBuffer::Init(Point const& sz)
+{
+    m_size = sz;
+    m_stride = (sz.x * static_cast<int>(sizeof(Color)) + RowAlignment - 1)
+               / RowAlignment * RowAlignment;
+
+    // Over-allocate so the first row can be aligned.
+    const size_t bytes = static_cast<size_t>(m_stride) * sz.y + RowAlignment;
+    m_memory.reset(new unsigned char[bytes]);
+    const size_t misalign = reinterpret_cast<size_t>(m_memory.get()) % RowAlignment;
+    m_buffer = reinterpret_cast<Color*>(m_memory.get()
+                                        + (misalign ? RowAlignment - misalign : 0));
+
+    for (int y = 0; y < sz.y; ++y)
+        std::fill(Row(y), Row(y) + sz.x, Color());
+}
+
+void PixelBuffer::Init(Point const& sz, void* memory, int stride)
+{
+    m_memory.reset();
+    m_size = sz;
+    m_stride = stride;
+    m_buffer = static_cast<Color*>(memory);
+}
+
+void PixelBuffer::ConvertTo(Format format, void* dst, int dstStride) const
+{
+    void (*convert32)(const Color*, unsigned int*, int) = nullptr;
+    void (*convert16)(const Color*, unsigned short*, int) = nullptr;
+
+    switch (format)
+    {
+    case Format::RGBA:
+        break;
+    case Format::BGRA:
+        convert32 = ConvertRowBGRAScalar;
+        break;
+    case Format::RGBX:
+        convert32 = ConvertRowRGBXScalar;
+        break;
+    case Format::RGB565:
+        convert16 = ConvertRowRGB565Scalar;
+        break;
+    }
+
+#if GWK_SIMD
+    const Platform::CpuFeatures& cpu = Platform::GetCpuFeatures();
+    if (cpu.avx2 || cpu.sse2)
+    {
+        switch (format)
+        {
+        case Format::RGBA:
+            break;
+        case Format::BGRA:
+            convert32 = cpu.avx2 ? ConvertRowBGRAAVX2 : ConvertRowBGRASSE2;
+            break;
+        case Format::RGBX:
+            convert32 = cpu.avx2 ? ConvertRowRGBXAVX2 : ConvertRowRGBXSSE2;
+            break;
+        case Format::RGB565:
+            convert16 = cpu.avx2 ? ConvertRowRGB565AVX2 : ConvertRowRGB565SSE2;
+            break;
+        }
+    }
+#endif
+
+    unsigned char* out = static_cast<unsigned char*>(dst);
+    for (int y = 0; y < m_size.y; ++y, out += dstStride)
+    {
+        if (convert32)
+            convert32(Row(y), reinterpret_cast<unsigned int*>(out), m_size.x);
+        else if (convert16)
+            convert16(Row(y), reinterpret_cast<unsigned short*>(out), m_size.x);
+        else
+            std::memcpy(out, Row(y), m_size.x * sizeof(Color));
+    }
 }
 
 //-------------------------------------------------------------------------------
 
+static inline Rect Intersect(const Rect& a, const Rect& b)
+{
+    const int x = std::max(a.x, b.x);
+    const int y = std::max(a.y, b.y);
+    return Rect(x, y,
+                std::min(a.Right(), b.Right()) - x,
+                std::min(a.Bottom(), b.Bottom()) - y);
+}
+
+//-------------------------------------------------------------------------------
+
+static inline size_t BufferBytes(Point size)
+{
+    return static_cast<size_t>(size.x) * size.y * sizeof(Color);
+}
+
 // See "Font Size in Pixels or Points" in "stb_truetype.h"
 static constexpr float c_pointsToPixels = 1.333f;
-// arbitrary font cache texture size
-// Texture size too small for wchar_t characters but stbtt_BakeFontBitmap crashes on larger sizes
-static constexpr int c_texsz = 800;
+// Pixel height that distance field glyphs are rasterized at.
+static constexpr float c_distanceFieldSize = 32.f;
 
 Font::Status Software::LoadFont(const Font& font)
 {
     FreeFont(font);
     m_lastFont = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.facename);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
+
+    Font::Status status;
+    std::shared_ptr<FontFace> face = FontFace::Load(filename, status);
+    if (!face)
+        return status;
 
-    std::ifstream inFile(filename, std::ifstream::in | std::ifstream::binary);
+    const float pixelHeight = font.GetSize() * Scale() * c_pointsToPixels;
 
-    if (!inFile.good())
+    SWFontData fontData;
+    if (m_distanceFieldText)
     {
-        Gwk::Log::Write(Log::Level::Error, "Font file not found: %s", filename.c_str());
-        return Font::Status::ErrorFileNotFound;
+        // All sizes share one distance field font per file.
+        auto found = m_distanceFields.find(filename);
+        if (found == m_distanceFields.end())
+        {
+            const GlyphCache::FontId id = m_glyphCache.AddFont(face, c_distanceFieldSize,
+                                            GlyphCache::Format::DistanceField);
+            found = m_distanceFields.insert(std::make_pair(filename, id)).first;
+        }
+        fontData.glyphs.id = found->second;
+        fontData.scale = pixelHeight / c_distanceFieldSize;
     }
+    else
+    {
+        fontData.glyphs.id = m_glyphCache.AddFont(face, pixelHeight);
+        fontData.scale = 1.f;
+    }
+    fontData.glyphs.renderScale = Scale();
+    fontData.face = std::move(face);
 
-    std::streampos begin = inFile.tellg();
-    inFile.seekg(0, std::ios::end);
-    const size_t fsz = inFile.tellg() - begin;
-    inFile.seekg(0, std::ios::beg);
-    assert(fsz > 0);
-
-    auto ttfdata = std::unique_ptr<unsigned char[]>(new unsigned char[fsz]);
-    inFile.read(reinterpret_cast<char*>(ttfdata.get()), fsz);
-    inFile.close();
-
-    SWFontData fontData;
-    fontData.m_ReadData =
-        deleted_unique_ptr<unsigned char>(new unsigned char[c_texsz * c_texsz],
-                                          [](unsigned char* mem) { delete [] mem; });
-    fontData.width = c_texsz;
-    fontData.height = c_texsz;
-
-    const float realsize = font.size * Scale();
-    fontData.baked_chars.resize(LastCharacter - BeginCharacter + 1);
-
-    stbtt_BakeFontBitmap(ttfdata.get(), 0,
-        realsize * c_pointsToPixels, // height
-        fontData.m_ReadData.get(),
-        c_texsz, c_texsz,
-        BeginCharacter, LastCharacter,             // range to bake
-        reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()));
-
-    m_lastFont = &(*m_fonts.insert(std::make_pair(font, std::move(fontData))).first);
+    m_lastFont = &(*m_fonts.insert(std::make_pair(font, fontData)).first);
     return Font::Status::Loaded;
 }
 
@@ -157,7 +1380,48 @@ void Software::FreeFont(const Gwk::Font& font)
     if (m_lastFont != nullptr && m_lastFont->first == font)
         m_lastFont = nullptr;
 
-    m_fonts.erase(font); // calls SWFontData destructor
+    auto it = m_fonts.find(font);
+    if (it != m_fonts.end())
+    {
+        // Distance fields are kept for other sizes.
+        if (!m_distanceFieldText)
+            it->second.glyphs.Remove(m_glyphCache);
+        m_fonts.erase(it);
+    }
+}
+
+void Software::RescaleFont(const Font& font, SWFontData& fontData)
+{
+    const float pixelHeight = font.GetSize() * Scale() * c_pointsToPixels;
+
+    // Distance fields are only drawn at another scale.
+    if (m_distanceFieldText)
+    {
+        fontData.scale = pixelHeight / c_distanceFieldSize;
+        fontData.glyphs.renderScale = Scale();
+        return;
+    }
+
+    fontData.glyphs.Rescale(m_glyphCache, fontData.face, Scale(), pixelHeight);
+}
+
+void Software::SetDistanceFieldText(bool enable)
+{
+    if (enable == m_distanceFieldText)
+        return;
+
+    if (!m_distanceFieldText)
+    {
+        for (auto& font : m_fonts)
+            font.second.glyphs.Remove(m_glyphCache);
+    }
+    for (auto& field : m_distanceFields)
+        m_glyphCache.RemoveFont(field.second);
+
+    m_fonts.clear();
+    m_distanceFields.clear();
+    m_lastFont = nullptr;
+    m_distanceFieldText = enable;
 }
 
 bool Software::EnsureFont(const Font& font)
@@ -165,7 +1429,11 @@ bool Software::EnsureFont(const Font& font)
     if (m_lastFont != nullptr)
     {
         if (m_lastFont->first == font)
+        {
+            if (m_lastFont->second.glyphs.renderScale != Scale())
+                RescaleFont(font, m_lastFont->second);
             return true;
+        }
     }
 
     // Was it loaded before?
@@ -173,6 +1441,8 @@ bool Software::EnsureFont(const Font& font)
     if (it != m_fonts.end())
     {
         m_lastFont = &(*it);
+        if (it->second.glyphs.renderScale != Scale())
+            RescaleFont(font, it->second);
         return true;
     }
 
@@ -182,47 +1452,159 @@ bool Software::EnsureFont(const Font& font)
     return LoadFont(font) == Font::Status::Loaded;
 }
 
+Texture::Status Software::DecodeTexture(const String& filename, bool premultiplied,
+                                        SWTextureData& texData)
+{
+    // Cached pixels are only read, so can stay mapped.
+    int width, height;
+    DiskCache::ImagePrepare premultiply;
+    if (premultiplied)
+    {
+        premultiply = [](unsigned char* pixels, int w, int h) {
+            Color* px = reinterpret_cast<Color*>(pixels);
+            for (Color* end = px + w * h; px != end; ++px)
+                *px = Drawing::Premultiply(*px);
+        };
+    }
+    texData.m_ReadData =
+        DiskCache::DecodeImage(filename, premultiplied ? "rgba8 premultiplied" : "rgba8",
+                               width, height, premultiply);
+
+    // Image failed to load..
+    if (!texData.m_ReadData)
+        return Texture::Status::ErrorFileNotFound;
+
+    texData.readable = true;
+
+    texData.width = width;
+    texData.height = height;
+    return Texture::Status::Loaded;
+}
+
 Texture::Status Software::LoadTexture(const Texture& texture)
 {
     FreeTexture(texture);
     m_lastTexture = nullptr;
 
-    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.name);
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
+
+    SWTextureData texData;
+    const Texture::Status status = DecodeTexture(filename, m_premultipliedAlpha, texData);
+    if (status != Texture::Status::Loaded)
+        return status;
+
+    m_lastTexture = &(*m_textures.insert(std::make_pair(texture, std::move(texData))).first);
+    m_textureBudget.Loaded(texture, m_lastTexture->second.budget,
+                           BufferBytes(m_lastTexture->second.GetSize()));
+    return Texture::Status::Loaded;
+}
+
+Base::TextureDecoder Software::GetTextureDecoder(const Texture& texture)
+{
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Texture, texture.GetName());
+    const bool premultiplied = m_premultipliedAlpha;
+
+    return [this, texture, filename, premultiplied]() -> TextureFinisher
+    {
+        std::shared_ptr<SWTextureData> texData = std::make_shared<SWTextureData>();
+        const Texture::Status status = DecodeTexture(filename, premultiplied, *texData);
+
+        return [this, texture, texData, status, premultiplied]() -> Texture::Status
+        {
+            // Decoded for the other blend mode.
+            if (premultiplied != m_premultipliedAlpha)
+                return LoadTexture(texture);
+
+            FreeTexture(texture);
+            m_lastTexture = nullptr;
+
+            if (status != Texture::Status::Loaded)
+                return status;
+
+            m_lastTexture = &(*m_textures.insert(std::make_pair(texture,
+                                                                std::move(*texData))).first);
+            m_textureBudget.Loaded(texture, m_lastTexture->second.budget,
+                                   BufferBytes(m_lastTexture->second.GetSize()));
+            return Texture::Status::Loaded;
+        };
+    };
+}
+
+Base::FontBaker Software::GetFontBaker(const Font& font)
+{
+    if (m_fonts.find(font) != m_fonts.end())
+        return nullptr;     // already loaded
+
+    const String filename = GetResourcePaths().GetPath(ResourcePaths::Type::Font, font.GetFacename());
+    const GlyphCache::Format format = m_distanceFieldText ? GlyphCache::Format::DistanceField
+                                                          : GlyphCache::Format::Coverage;
+    const float pixelHeight = m_distanceFieldText ? c_distanceFieldSize
+                                                  : font.GetSize() * Scale() * c_pointsToPixels;
+
+    return [this, font, filename, format, pixelHeight]() -> FontFinisher
+    {
+        std::shared_ptr<GlyphCache::RasterizedGlyphs> glyphs =
+            std::make_shared<GlyphCache::RasterizedGlyphs>();
+
+        Font::Status status;
+        std::shared_ptr<const FontFace> face = FontFace::Load(filename, status);
+        if (face)
+            *glyphs = GlyphCache::RasterizeGlyphs(face, pixelHeight, format);
 
-    SWTextureData texData;
+        return [this, font, glyphs]()
+        {
+            // The glyphs are dropped if the font is now another size.
+            if (EnsureFont(font) && glyphs->face)
+                m_glyphCache.AddRasterizedGlyphs(m_lastFont->second.glyphs.id, *glyphs);
+        };
+    };
+}
 
-    int width, height, n;
-    {
-        unsigned char *image = stbi_load(filename.c_str(), &width, &height, &n, 4);
-        texData.m_ReadData =
-            deleted_unique_ptr<unsigned char>(image,
-                                              [](unsigned char* mem) {
-                                                  if (mem) stbi_image_free(mem);
-                                              });
-    }
+void Software::GenerateMipmaps(const Gwk::Texture& texture)
+{
+    if (EnsureTexture(texture))
+        GetMipLevel(m_lastTexture->second, std::numeric_limits<int>::max());
+}
 
-    // Image failed to load..
-    if (!texData.m_ReadData)
+const PixelBuffer* Software::GetMipLevel(SWTextureData& texData, int level)
+{
+    while (static_cast<int>(texData.m_mips.size()) < level)
     {
-        Gwk::Log::Write(Log::Level::Error, "Texture file not found: %s", filename.c_str());
-        return Texture::Status::ErrorFileNotFound;
+        const Point size = texData.m_mips.empty() ? texData.GetSize()
+                                                  : texData.m_mips.back()->GetSize();
+        if (size.x == 1 && size.y == 1)
+            break;
+
+        std::unique_ptr<PixelBuffer> mip(new PixelBuffer);
+        mip->Init(Point(std::max(1, size.x / 2), std::max(1, size.y / 2)));
+        if (texData.m_mips.empty())
+            Drawing::Downsample(*mip, texData, m_premultipliedAlpha);
+        else
+            Drawing::Downsample(*mip, *texData.m_mips.back(), m_premultipliedAlpha);
+        m_textureBudget.Resized(texData.budget, texData.budget.bytes + BufferBytes(mip->GetSize()));
+        texData.m_mips.push_back(std::move(mip));
     }
 
-    texData.readable = true;
-
-    texData.width = width;
-    texData.height = height;
+    if (level <= 0 || texData.m_mips.empty())
+        return nullptr;
 
-    m_lastTexture = &(*m_textures.insert(std::make_pair(texture, std::move(texData))).first);
-    return Texture::Status::Loaded;
+    return texData.m_mips[std::min<size_t>(level, texData.m_mips.size()) - 1].get();
 }
 
 void Software::FreeTexture(const Gwk::Texture& texture)
 {
+    auto it = m_textures.find(texture);
+    if (it == m_textures.end())
+        return;
+
+    // Binned draws may use the texture.
+    Flush();
+
     if (m_lastTexture != nullptr && m_lastTexture->first == texture)
         m_lastTexture = nullptr;
 
-    m_textures.erase(texture); // calls SWTextureData destructor
+    m_textureBudget.Freed(it->second.budget);
+    m_textures.erase(it); // calls SWTextureData destructor
 }
 
 TextureData Software::GetTextureData(const Texture& texture) const
@@ -244,7 +1626,10 @@ bool Software::EnsureTexture(const Gwk::Texture& texture)
     if (m_lastTexture != nullptr)
     {
         if (m_lastTexture->first == texture)
+        {
+            m_textureBudget.Used(m_lastTexture->second.budget);
             return true;
+        }
     }
 
     // Was it loaded before?
@@ -252,6 +1637,7 @@ bool Software::EnsureTexture(const Gwk::Texture& texture)
     if (it != m_textures.end())
     {
         m_lastTexture = &(*it);
+        m_textureBudget.Used(it->second.budget);
         return true;
     }
 
@@ -262,22 +1648,266 @@ bool Software::EnsureTexture(const Gwk::Texture& texture)
 }
 //-------------------------------------------------------------------------------
 
+//
+// Software texture cache. Cached controls are rendered into their own pixel
+// buffers, over transparent black, with the alpha composited over. This
+// leaves them premultiplied.
+//
+class SoftwareCTT : public ICacheToTexture
+{
+public:
+
+    static const size_t DefaultMemoryLimit = 32 * 1024 * 1024;
+
+    explicit SoftwareCTT(Software& renderer)
+        :   m_renderer(renderer)
+        ,   m_memoryLimit(DefaultMemoryLimit)
+        ,   m_memoryUsed(0)
+        ,   m_clock(0)
+    {}
+
+    void Initialize() override {}
+    void ShutDown() override;
+    void SetRenderer(Gwk::Renderer::Base* renderer) override {}
+
+    void SetupCacheTexture(CacheHandle control) override;
+    void FinishCacheTexture(CacheHandle control) override;
+
+    void DrawCachedControlTexture(CacheHandle control) override;
+    void CreateControlCacheTexture(CacheHandle control, const Point& size) override;
+    void UpdateControlCacheTexture(CacheHandle control) override {}
+    bool IsCacheTextureValid(CacheHandle control) override;
+
+    void SetMemoryLimit(size_t bytes);
+    size_t GetMemoryUsed() const { return m_memoryUsed; }
+
+private:
+
+    struct CacheEntry
+    {
+        CacheEntry() : lastUsed(0) {}
+
+        Point size;                             // Size of the control, unscaled.
+        std::unique_ptr<PixelBuffer> buffer;    // Null if not rendered, or freed.
+        unsigned long long lastUsed;
+    };
+
+    Point BufferSize(const CacheEntry& entry) const;
+    void Free(CacheEntry& entry);
+    void FreeLeastRecentlyUsed(size_t needed);
+
+    Software& m_renderer;
+    // Entries are not removed as controls don't say when they are deleted.
+    // Their buffers are freed first, as they are never drawn again.
+    std::unordered_map<CacheHandle, CacheEntry> m_cache;
+    std::vector<PixelBuffer*> m_targets;    // Drawn to before each cache was set up.
+    size_t m_memoryLimit;
+    size_t m_memoryUsed;
+    unsigned long long m_clock;
+};
+
+Point SoftwareCTT::BufferSize(const CacheEntry& entry) const
+{
+    const float scale = m_renderer.Scale();
+    return Point(static_cast<int>(std::ceil(entry.size.x * scale)),
+                 static_cast<int>(std::ceil(entry.size.y * scale)));
+}
+
+void SoftwareCTT::Free(CacheEntry& entry)
+{
+    if (!entry.buffer)
+        return;
+
+    // Binned draws may still read the buffer.
+    m_renderer.Flush();
+    m_memoryUsed -= BufferBytes(entry.buffer->GetSize());
+    entry.buffer.reset();
+}
+
+void SoftwareCTT::FreeLeastRecentlyUsed(size_t needed)
+{
+    while (m_memoryUsed + needed > m_memoryLimit)
+    {
+        CacheEntry* oldest = nullptr;
+        for (auto& it : m_cache)
+        {
+            CacheEntry& entry = it.second;
+            if (!entry.buffer
+                || std::find(m_targets.begin(), m_targets.end(), entry.buffer.get())
+                   != m_targets.end())
+            {
+                continue;
+            }
+
+            if (!oldest || entry.lastUsed < oldest->lastUsed)
+                oldest = &entry;
+        }
+
+        if (!oldest)
+            break;
+
+        Free(*oldest);
+    }
+}
+
+void SoftwareCTT::ShutDown()
+{
+    for (auto& it : m_cache)
+        Free(it.second);
+    m_cache.clear();
+}
+
+void SoftwareCTT::CreateControlCacheTexture(CacheHandle control, const Point& size)
+{
+    CacheEntry& entry = m_cache[control];
+    if (entry.size.x != size.x || entry.size.y != size.y)
+    {
+        Free(entry);
+        entry.size = size;
+    }
+}
+
+bool SoftwareCTT::IsCacheTextureValid(CacheHandle control)
+{
+    auto it = m_cache.find(control);
+    if (it == m_cache.end() || !it->second.buffer)
+        return false;
+
+    const Point size = BufferSize(it->second);
+    return it->second.buffer->GetSize().x == size.x && it->second.buffer->GetSize().y == size.y;
+}
+
+void SoftwareCTT::SetupCacheTexture(CacheHandle control)
+{
+    CacheEntry& entry = m_cache[control];
+    entry.lastUsed = ++m_clock;
+
+    if (!IsCacheTextureValid(control))
+    {
+        Free(entry);
+
+        const Point size = BufferSize(entry);
+        FreeLeastRecentlyUsed(BufferBytes(size));
+        entry.buffer.reset(new PixelBuffer);
+        entry.buffer->Init(size);
+        m_memoryUsed += BufferBytes(size);
+    }
+
+    // Draws made so far are to the old target.
+    m_renderer.Flush();
+    m_targets.push_back(m_renderer.m_pixbuf);
+    m_renderer.m_pixbuf = entry.buffer.get();
+    m_renderer.m_drawingToCache = true;
+
+    PixelBuffer& pb = *entry.buffer;
+    for (int y = 0; y < pb.GetSize().y; ++y)
+        std::fill(&pb.At(0, y), &pb.At(0, y) + pb.GetSize().x, Color(0, 0, 0, 0));
+}
+
+void SoftwareCTT::FinishCacheTexture(CacheHandle control)
+{
+    if (m_targets.empty())
+        return;
+
+    m_renderer.Flush();
+    m_renderer.m_pixbuf = m_targets.back();
+    m_targets.pop_back();
+    m_renderer.m_drawingToCache = !m_targets.empty();
+}
+
+void SoftwareCTT::DrawCachedControlTexture(CacheHandle control)
+{
+    auto it = m_cache.find(control);
+    if (it == m_cache.end() || !it->second.buffer)
+        return;
+
+    CacheEntry& entry = it->second;
+    entry.lastUsed = ++m_clock;
+
+    // The buffer is already scaled, so only its position is translated.
+    int x = 0, y = 0;
+    m_renderer.Translate(x, y);
+    const Point size = entry.buffer->GetSize();
+
+    Rect visible(x, y, size.x, size.y);
+    if (!m_renderer.Clip(visible))
+        return;
+
+    Software::DrawCommand cmd;
+    cmd.type = Software::DrawCommand::Type::Cached;
+    cmd.bounds = visible;
+    cmd.area = Rect(x, y, size.x, size.y);
+    cmd.cached = entry.buffer.get();
+    m_renderer.Submit(cmd);
+}
+
+void SoftwareCTT::SetMemoryLimit(size_t bytes)
+{
+    m_memoryLimit = bytes;
+    FreeLeastRecentlyUsed(0);
+}
+
+//-------------------------------------------------------------------------------
+
 Software::Software(ResourcePaths& paths, PixelBuffer& pbuff)
     :   Base(paths)
     ,   m_lastFont(nullptr)
     ,   m_lastTexture(nullptr)
+    ,   m_distanceFieldText(false)
     ,   m_isClipping(false)
+    ,   m_premultipliedAlpha(false)
+    ,   m_drawingToCache(false)
     ,   m_pixbuf(&pbuff)
+    ,   m_ctt(new SoftwareCTT(*this))
+    ,   m_rasterThreads(0)
+    ,   m_tilesX(0)
+    ,   m_tilesY(0)
+    ,   m_nextTile(0)
 {
+    // Draw any binned glyphs before their page is reused.
+    m_glyphCache.SetEvictListener([this](int) { Flush(); });
 }
 
 Software::~Software()
 {
+    delete m_ctt;
+}
+
+ICacheToTexture* Software::GetCTT()
+{
+    return m_ctt;
+}
+
+void Software::SetCacheMemoryLimit(size_t bytes)
+{
+    m_ctt->SetMemoryLimit(bytes);
+}
+
+size_t Software::GetCacheMemoryUsed() const
+{
+    return m_ctt->GetMemoryUsed();
 }
 
 void Software::SetDrawColor(Gwk::Color color)
 {
     m_color = color;
+    m_fillColor = m_premultipliedAlpha ? Drawing::Premultiply(color) : color;
+}
+
+void Software::SetPremultipliedAlpha(bool enable)
+{
+    if (enable == m_premultipliedAlpha)
+        return;
+
+    // Binned draws use the textures, and the mode they were loaded with.
+    Flush();
+    for (auto& texture : m_textures)
+        m_textureBudget.Freed(texture.second.budget);
+    m_textures.clear();
+    m_lastTexture = nullptr;
+
+    m_premultipliedAlpha = enable;
+    SetDrawColor(m_color);
 }
 
 Gwk::Point Software::MeasureText(const Gwk::Font& font, const Gwk::String& text)
@@ -285,28 +1915,30 @@ Gwk::Point Software::MeasureText(const Gwk::Font& font, const Gwk::String& text)
     if (!EnsureFont(font))
         return Gwk::Point(0, 0);
 
-    SWFontData& fontData = m_lastFont->second;
+    const SWFontData& fontData = m_lastFont->second;
 
-    Point sz(0, font.size * Scale() * c_pointsToPixels);
+    Point sz(0, font.GetSize() * Scale() * c_pointsToPixels);
 
-    float x = 0.f, y = 0.f;
-    char* text_ptr = const_cast<char*>(text.c_str());
+    float x = 0.f;
+    const float scale = fontData.scale;
+    // Distance field glyphs include a border around the outline.
+    const int pad = m_distanceFieldText ? GlyphCache::SdfPadding : 0;
 
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
-        const auto c = wide_char - BeginCharacter;
-
-        if (wide_char < BeginCharacter || wide_char > LastCharacter)
+        if (wide_char < BeginCharacter)
             continue;
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()),
-                           c_texsz, c_texsz,
-                           c,
-                           &x, &y, &q, 1); // 1=opengl & d3d10+,0=d3d9
+        const GlyphCache::Glyph* glyph = m_glyphCache.GetGlyph(fontData.glyphs.id, wide_char);
+        if (glyph == nullptr)
+            continue;
 
-        sz.x = q.x1;
-        sz.y = std::max(sz.y, int((q.y1 - q.y0) * c_pointsToPixels));
+        const int w = std::max(glyph->rect.w - 2 * pad, 0);
+        const int h = std::max(glyph->rect.h - 2 * pad, 0);
+        sz.x = std::floor(x + (glyph->offset.x + pad) * scale + 0.5f) + int(std::ceil(w * scale));
+        sz.y = std::max(sz.y, int(h * scale * c_pointsToPixels));
+        x += glyph->advance * scale;
     }
 
     return sz;
@@ -318,59 +1950,96 @@ void Software::RenderText(const Gwk::Font& font, Gwk::Point pos,
     if (!EnsureFont(font))
         return;
     
-    SWFontData& fontData = m_lastFont->second;
-
-    float x = pos.x, y = pos.y;
-    char* text_ptr = const_cast<char*>(text.c_str());
-    const auto clipRect = ClipRegion();
-    const Point srcSize(fontData.width, fontData.height);
-    const unsigned char * const fontBmp = fontData.m_ReadData.get();
+    const SWFontData& fontData = m_lastFont->second;
 
     // Height of font, allowing for descenders, because baseline is bottom of capitals.
-    const float offset = font.size * Scale() * c_pointsToPixels * 0.8f;
+    const float offset = font.GetSize() * Scale() * c_pointsToPixels * 0.8f;
+
+    if (m_distanceFieldText)
+        return RenderDistanceFieldText(fontData, pos, offset, text);
+
+    float x = pos.x;
 
-    Color col(m_color);
-    while (const auto wide_char = Utility::Strings::utf8_to_wchart(text_ptr))
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Glyph;
+    cmd.color = m_color;
+
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
     {
-        const auto c = wide_char - BeginCharacter;
+        if (wide_char < BeginCharacter)
+            continue;
 
-        if (wide_char < BeginCharacter || wide_char > LastCharacter)
+        const GlyphCache::Glyph* glyph = m_glyphCache.GetGlyph(fontData.glyphs.id, wide_char);
+        if (glyph == nullptr)
             continue;
 
-        stbtt_aligned_quad q;
-        stbtt_GetBakedQuad(reinterpret_cast<stbtt_bakedchar*>(fontData.baked_chars.data()),
-            c_texsz, c_texsz,
-            c,
-            &x, &y, &q, 1); // 1=opengl & d3d10+,0=d3d9
+        Point dst(std::floor(x + glyph->offset.x + 0.5f), pos.y + glyph->offset.y);
+        x += glyph->advance;
 
-        Rect srcCharRect(q.x0, q.y0, q.x1 - q.x0, q.y1 - q.y0);
-        Translate(srcCharRect);
-        Point fpos(0, srcCharRect.y + offset);
-        for (int fy = 0; fy < srcCharRect.h; ++fy, ++fpos.y)
-        {
-            if (fpos.y < clipRect.Top())
-                continue;
+        if (glyph->page < 0)
+            continue;
 
-            if (fpos.y > clipRect.Bottom())
-                return;
+        Translate(dst.x, dst.y);
+        dst.y += offset;
 
-            fpos.x = srcCharRect.x;
-            for (int fx = 0; fx < srcCharRect.w; ++fx, ++fpos.x)
-            {
-                if (fpos.x < clipRect.Left())
-                    continue;
+        // clip the glyph
+        cmd.bounds = Intersect(Rect(dst.x, dst.y, glyph->rect.w, glyph->rect.h), ClipRegion());
+        if (cmd.bounds.w <= 0 || cmd.bounds.h <= 0)
+            continue;
 
-                if (fpos.x > clipRect.Right())
-                    return;
+        cmd.page = glyph->page;
+        cmd.area = glyph->rect;
+        cmd.x = dst.x;
+        cmd.y = dst.y;
+        Submit(cmd);
+    }
+}
 
-                const Point srcPix(q.s0*srcSize.x + fx, q.t0*srcSize.y + fy);
-                const unsigned char fi = fontBmp[srcPix.y * srcSize.x + srcPix.x];
-                col.a = fi;
+void Software::RenderDistanceFieldText(const SWFontData& fontData, Point pos, float baseline,
+                                       const String& text)
+{
+    Translate(pos.x, pos.y);
+    float x = pos.x;
+    const float y = pos.y + baseline;
 
-                Color& dst = m_pixbuf->At(fpos);
-                dst = Drawing::BlendAlpha(col, dst);
-            }
-        }
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::DistanceGlyph;
+    cmd.color = m_color;
+    cmd.scale = fontData.scale;
+
+    Utility::Strings::DecodeUtf8(text, m_textCodepoints);
+    for (const char32_t wide_char : m_textCodepoints)
+    {
+        if (wide_char < BeginCharacter)
+            continue;
+
+        const GlyphCache::Glyph* glyph = m_glyphCache.GetGlyph(fontData.glyphs.id, wide_char);
+        if (glyph == nullptr)
+            continue;
+
+        const float gx = x + glyph->offset.x * cmd.scale;
+        const float gy = y + glyph->offset.y * cmd.scale;
+        x += glyph->advance * cmd.scale;
+
+        if (glyph->page < 0)
+            continue;
+
+        // clip the scaled glyph
+        const int left = int(std::floor(gx));
+        const int top = int(std::floor(gy));
+        const Rect scaled(left, top,
+                          int(std::ceil(gx + glyph->rect.w * cmd.scale)) - left,
+                          int(std::ceil(gy + glyph->rect.h * cmd.scale)) - top);
+        cmd.bounds = Intersect(scaled, ClipRegion());
+        if (cmd.bounds.w <= 0 || cmd.bounds.h <= 0)
+            continue;
+
+        cmd.page = glyph->page;
+        cmd.area = glyph->rect;
+        cmd.x = gx;
+        cmd.y = gy;
+        Submit(cmd);
     }
 }
 
@@ -432,23 +2101,113 @@ void Software::DrawPixel(int x, int y)
 {
     Translate(x, y);
 
-    Rect r(x,y,1,1);
-    if (Clip(r))
-        m_pixbuf->At(x, y) = m_color;
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Pixel;
+    cmd.bounds = Rect(x,y,1,1);
+    cmd.color = m_fillColor;
+    if (Clip(cmd.bounds))
+        Submit(cmd);
 }
 
 void Software::DrawFilledRect(Gwk::Rect rect)
 {
     Translate(rect);
-    if (Clip(rect))
-        Drawing::RectFill(*m_pixbuf, rect, m_color);
+
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Fill;
+    cmd.bounds = rect;
+    cmd.color = m_fillColor;
+    if (Clip(cmd.bounds))
+        Submit(cmd);
 }
 
 void Software::DrawLinedRect(Gwk::Rect rect)
 {
     Translate(rect);
-    if (Clip(rect))
-        Drawing::RectOutline(*m_pixbuf, rect, m_color);
+    if (!Clip(rect))
+        return;
+
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Fill;
+    cmd.color = m_fillColor;
+
+    cmd.bounds = Rect(rect.x, rect.y, rect.w, 1);   // top
+    Submit(cmd);
+    if (rect.h > 1)
+    {
+        cmd.bounds = Rect(rect.x, rect.Bottom() - 1, rect.w, 1);    // bottom
+        Submit(cmd);
+    }
+    cmd.bounds = Rect(rect.x, rect.y, 1, rect.h);   // left
+    Submit(cmd);
+    if (rect.w > 1)
+    {
+        cmd.bounds = Rect(rect.Right() - 1, rect.y, 1, rect.h);     // right
+        Submit(cmd);
+    }
+}
+
+void Software::DrawShavedCornerRect(Gwk::Rect rect, bool bSlight)
+{
+    // The same parts as the default, without a virtual call for each.
+    rect.w -= 1;
+    rect.h -= 1;
+
+    if (bSlight)
+    {
+        Software::DrawFilledRect(Gwk::Rect(rect.x+1, rect.y, rect.w-1, 1));
+        Software::DrawFilledRect(Gwk::Rect(rect.x+1, rect.y+rect.h, rect.w-1, 1));
+        Software::DrawFilledRect(Gwk::Rect(rect.x, rect.y+1, 1, rect.h-1));
+        Software::DrawFilledRect(Gwk::Rect(rect.x+rect.w, rect.y+1, 1, rect.h-1));
+    }
+    else
+    {
+        Software::DrawPixel(rect.x+1, rect.y+1);
+        Software::DrawPixel(rect.x+rect.w-1, rect.y+1);
+        Software::DrawPixel(rect.x+1, rect.y+rect.h-1);
+        Software::DrawPixel(rect.x+rect.w-1, rect.y+rect.h-1);
+        Software::DrawFilledRect(Gwk::Rect(rect.x+2, rect.y, rect.w-3, 1));
+        Software::DrawFilledRect(Gwk::Rect(rect.x+2, rect.y+rect.h, rect.w-3, 1));
+        Software::DrawFilledRect(Gwk::Rect(rect.x, rect.y+2, 1, rect.h-3));
+        Software::DrawFilledRect(Gwk::Rect(rect.x+rect.w, rect.y+2, 1, rect.h-3));
+    }
+}
+
+void Software::DrawLinearGradientRect(Gwk::Rect rect, Gwk::Color start, Gwk::Color end,
+                                      bool vertical)
+{
+    if (vertical)
+        DrawBilinearGradientRect(rect, start, start, end, end);
+    else
+        DrawBilinearGradientRect(rect, start, end, start, end);
+}
+
+void Software::DrawBilinearGradientRect(Gwk::Rect rect,
+                                        Gwk::Color topLeft, Gwk::Color topRight,
+                                        Gwk::Color bottomLeft, Gwk::Color bottomRight)
+{
+    Translate(rect);
+    Rect visible(rect);
+    if (!Clip(visible))
+        return;
+
+    GradientColors colors = { { topLeft, topRight, bottomLeft, bottomRight } };
+    if (m_premultipliedAlpha)
+    {
+        for (Color& c : colors.corners)
+            c = Drawing::Premultiply(c);
+    }
+
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Gradient;
+    cmd.bounds = visible;
+    cmd.area = rect;
+    cmd.page = static_cast<int>(m_gradients.size());
+    m_gradients.push_back(colors);
+    Submit(cmd);
+
+    if (m_rasterThreads == 0)
+        m_gradients.clear();
 }
 
 void Software::DrawTexturedRect(const Gwk::Texture& texture, Gwk::Rect rect,
@@ -457,13 +2216,266 @@ void Software::DrawTexturedRect(const Gwk::Texture& texture, Gwk::Rect rect,
     if (!EnsureTexture(texture))
         return DrawMissingImage(rect);
 
-    const SWTextureData& texData = m_lastTexture->second;
+    // Clip() passes empty rects when clipping is off.
+    if (rect.w <= 0 || rect.h <= 0)
+        return;
 
     Translate(rect);
-    if (!Clip(rect))
+    Rect visible(rect);
+    if (!Clip(visible))
+        return;
+
+    SWTextureData& texData = m_lastTexture->second;
+
+    // Levels halve in size down to 1x1.
+    int levels = 0;
+    for (int size = std::max(texData.GetSize().x, texData.GetSize().y); size > 1; size /= 2)
+        ++levels;
+
+    // Sample from the smallest mip level that is still at least the size drawn.
+    const float texelsX = std::abs(u2 - u1) * texData.width / rect.w;
+    const float texelsY = std::abs(v2 - v1) * texData.height / rect.h;
+    int level = 0;
+    for (float texels = std::min(texelsX, texelsY); texels >= 2.f && level < levels;
+         texels *= 0.5f)
+    {
+        ++level;
+    }
+
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::Textured;
+    cmd.bounds = visible;
+    cmd.area = rect;
+    cmd.texture = &texData;
+    cmd.mip = GetMipLevel(texData, level);
+    cmd.u1 = u1;
+    cmd.v1 = v1;
+    cmd.u2 = u2;
+    cmd.v2 = v2;
+    Submit(cmd);
+}
+
+void Software::DrawNinePatch(const Gwk::Texture& texture, Gwk::Rect rect,
+                             const NinePatch& grid, Gwk::Color color, unsigned int draw)
+{
+    SetDrawColor(color);
+
+    if (!EnsureTexture(texture))
+        return DrawMissingImage(rect);
+
+    // Place the areas as separate DrawTexturedRect() calls would.
+    const int x[4] = { rect.x, rect.x + grid.left, rect.Right() - grid.right, rect.Right() };
+    const int y[4] = { rect.y, rect.y + grid.top, rect.Bottom() - grid.bottom, rect.Bottom() };
+
+    NinePatchAreas patch;
+    std::copy(grid.u, grid.u + 4, patch.u);
+    std::copy(grid.v, grid.v + 4, patch.v);
+
+    Rect bounds;
+    for (int i = 0; i < 9; ++i)
+    {
+        Rect& area = patch.areas[i];
+        if (!(draw & (1 << i)))
+            continue;
+
+        const int col = i % 3, row = i / 3;
+        area = Rect(x[col], y[row], x[col + 1] - x[col], y[row + 1] - y[row]);
+        Translate(area);
+
+        Rect visible(area);
+        if (!Clip(visible))
+        {
+            area = Rect();
+            continue;
+        }
+
+        if (bounds.w <= 0 || bounds.h <= 0)
+        {
+            bounds = visible;
+        }
+        else
+        {
+            const int right = std::max(bounds.Right(), visible.Right());
+            const int bottom = std::max(bounds.Bottom(), visible.Bottom());
+            bounds.x = std::min(bounds.x, visible.x);
+            bounds.y = std::min(bounds.y, visible.y);
+            bounds.w = right - bounds.x;
+            bounds.h = bottom - bounds.y;
+        }
+    }
+
+    if (bounds.w <= 0 || bounds.h <= 0)
+        return;
+
+    DrawCommand cmd;
+    cmd.type = DrawCommand::Type::NinePatch;
+    cmd.bounds = bounds;
+    cmd.texture = &m_lastTexture->second;
+    cmd.page = static_cast<int>(m_ninePatches.size());
+    m_ninePatches.push_back(patch);
+    Submit(cmd);
+
+    if (m_rasterThreads == 0)
+        m_ninePatches.clear();
+}
+
+//-------------------------------------------------------------------------------
+
+void Software::Submit(const DrawCommand& cmd)
+{
+    const Point size = m_pixbuf->GetSize();
+    const Rect bounds = Intersect(cmd.bounds, Rect(0, 0, size.x, size.y));
+    if (bounds.w <= 0 || bounds.h <= 0)
+        return;
+
+    if (m_rasterThreads == 0)
+        return Execute(cmd, bounds);
+
+    // Binned: draw when the frame ends, in each tile the command touches.
+
+    if (m_tilesX != (size.x + TileSize - 1) / TileSize
+        || m_tilesY != (size.y + TileSize - 1) / TileSize)
+    {
+        Flush();
+        m_tilesX = (size.x + TileSize - 1) / TileSize;
+        m_tilesY = (size.y + TileSize - 1) / TileSize;
+        m_bins.clear();
+        m_bins.resize(m_tilesX * m_tilesY);
+    }
+
+    const unsigned int index = static_cast<unsigned int>(m_commands.size());
+    m_commands.push_back(cmd);
+    m_commands.back().bounds = bounds;
+
+    for (int ty = bounds.y / TileSize; ty <= (bounds.Bottom() - 1) / TileSize; ++ty)
+    {
+        for (int tx = bounds.x / TileSize; tx <= (bounds.Right() - 1) / TileSize; ++tx)
+        {
+            std::vector<unsigned int>& bin = m_bins[ty * m_tilesX + tx];
+            if (bin.empty())
+                m_activeTiles.push_back(ty * m_tilesX + tx);
+            bin.push_back(index);
+        }
+    }
+}
+
+void Software::Execute(const DrawCommand& cmd, const Rect& clip)
+{
+    PixelBuffer& pb = *m_pixbuf;
+    const Drawing::BlendMode mode = m_premultipliedAlpha ? Drawing::BlendMode::Premultiplied
+                                  : m_drawingToCache ? Drawing::BlendMode::Over
+                                  : Drawing::BlendMode::Straight;
+
+    switch (cmd.type)
+    {
+    case DrawCommand::Type::Pixel:
+        pb.At(clip.x, clip.y) = cmd.color;
+        break;
+    case DrawCommand::Type::Fill:
+        Drawing::RectFill(pb, clip, cmd.color, mode);
+        break;
+    case DrawCommand::Type::Gradient:
+        Drawing::RectGradient(pb, cmd.area, m_gradients[cmd.page].corners, clip, mode);
+        break;
+    case DrawCommand::Type::Textured:
+        if (cmd.mip)
+            Drawing::RectTextured(pb, *cmd.mip, cmd.area, cmd.u1, cmd.v1, cmd.u2, cmd.v2, clip,
+                                  mode);
+        else
+            Drawing::RectTextured(pb, *cmd.texture, cmd.area, cmd.u1, cmd.v1, cmd.u2, cmd.v2,
+                                  clip, mode);
+        break;
+    case DrawCommand::Type::NinePatch:
+    {
+        const NinePatchAreas& patch = m_ninePatches[cmd.page];
+        for (int i = 0; i < 9; ++i)
+        {
+            const Rect visible = Intersect(patch.areas[i], clip);
+            if (visible.w <= 0 || visible.h <= 0)
+                continue;
+
+            const int col = i % 3, row = i / 3;
+            Drawing::RectTextured(pb, *cmd.texture, patch.areas[i],
+                                  patch.u[col], patch.v[row], patch.u[col + 1], patch.v[row + 1],
+                                  visible, mode);
+        }
+        break;
+    }
+    case DrawCommand::Type::Cached:
+        Drawing::RectPremultiplied(pb, *cmd.cached, Point(cmd.area.x, cmd.area.y), clip);
+        break;
+    case DrawCommand::Type::Glyph:
+    {
+        const GlyphCache::Page& page = m_glyphCache.GetPage(cmd.page);
+        const int sx = cmd.area.x + clip.x - int(cmd.x), sy = cmd.area.y + clip.y - int(cmd.y);
+        Drawing::GlyphMask(pb, &page.pixels[sy * page.size.x + sx], page.size.x,
+                           page.pixels.data() + page.pixels.size(), clip, cmd.color,
+                           mode != Drawing::BlendMode::Straight);
+        break;
+    }
+    case DrawCommand::Type::DistanceGlyph:
+        Drawing::GlyphDistanceField(pb, m_glyphCache.GetPage(cmd.page), cmd.area,
+                                    cmd.x, cmd.y, cmd.scale, clip, cmd.color,
+                                    mode != Drawing::BlendMode::Straight);
+        break;
+    }
+}
+
+void Software::RasterizeTiles()
+{
+    const int count = static_cast<int>(m_activeTiles.size());
+    for (int i = m_nextTile++; i < count; i = m_nextTile++)
+    {
+        const int tile = m_activeTiles[i];
+        const Rect tileRect((tile % m_tilesX) * TileSize, (tile / m_tilesX) * TileSize,
+                            TileSize, TileSize);
+
+        for (unsigned int index : m_bins[tile])
+        {
+            const DrawCommand& cmd = m_commands[index];
+            const Rect clip = Intersect(cmd.bounds, tileRect);
+            if (clip.w > 0 && clip.h > 0)
+                Execute(cmd, clip);
+        }
+    }
+}
+
+void Software::Flush()
+{
+    if (m_commands.empty())
         return;
 
-    Drawing::RectTextured<PixelBuffer, SWTextureData>(*m_pixbuf, texData, rect, u1,v1, u2,v2);
+    // This thread rasterizes too, and runs the jobs no worker has started.
+    Platform::JobSystem& jobs = Platform::JobSystem::Get();
+    Platform::JobSystem::Group group;
+    m_nextTile = 0;
+    for (int i = 1; i < m_rasterThreads; ++i)
+        jobs.Run(group, [this]() { RasterizeTiles(); });
+
+    RasterizeTiles();
+    jobs.Wait(group);
+
+    for (int tile : m_activeTiles)
+        m_bins[tile].clear();
+    m_activeTiles.clear();
+    m_commands.clear();
+    m_ninePatches.clear();
+    m_gradients.clear();
+}
+
+void Software::SetRasterThreads(int threads)
+{
+    Flush();
+    m_rasterThreads = std::max(threads, 0);
+}
+
+void Software::End()
+{
+    Flush();
+
+    m_textureBudget.FreeLeastRecentlyUsed(m_textures,
+                                          [this](const Texture& texture) { FreeTexture(texture); });
+    m_textureBudget.EndFrame();
 }
 
 Gwk::Color Software::PixelColor(const Gwk::Texture& texture, unsigned int x, unsigned int y,
@@ -474,6 +2486,9 @@ Gwk::Color Software::PixelColor(const Gwk::Texture& texture, unsigned int x, uns
 
     const SWTextureData& texData = m_lastTexture->second;
 
+    if (m_premultipliedAlpha)
+        return Drawing::Unpremultiply(texData.At(x, y));
+
     return texData.At(x, y);
 }
 
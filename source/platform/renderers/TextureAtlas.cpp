@@ -0,0 +1,405 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/TextureAtlas.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Gwk
+{
+namespace Renderer
+{
+
+static const int c_border = 1;
+
+static void GrowRect(Rect& rect, const Rect& add)
+{
+    if (rect.w <= 0 || rect.h <= 0)
+    {
+        rect = add;
+        return;
+    }
+
+    const int right = std::max(rect.Right(), add.Right());
+    const int bottom = std::max(rect.Bottom(), add.Bottom());
+    rect.x = std::min(rect.x, add.x);
+    rect.y = std::min(rect.y, add.y);
+    rect.w = right - rect.x;
+    rect.h = bottom - rect.y;
+}
+
+TextureAtlas::TextureAtlas(Point pageSize, int maxImageSize)
+    :   m_pageSize(pageSize)
+    ,   m_maxImageSize(std::min(maxImageSize,
+                                std::min(pageSize.x, pageSize.y) - c_border * 2))
+    ,   m_nextImageId(1)
+{
+}
+
+bool TextureAtlas::Fits(Point size) const
+{
+    return size.x > 0 && size.y > 0 && size.x <= m_maxImageSize && size.y <= m_maxImageSize;
+}
+
+TextureAtlas::ImageId TextureAtlas::Add(Point size, const unsigned char* rgba)
+{
+    if (!Fits(size))
+        return 0;
+
+    const ImageId id = m_nextImageId++;
+    const Point padded(size.x + c_border * 2, size.y + c_border * 2);
+
+    // Fill the pages in use before starting an unused one.
+    int page = -1;
+    Point pos;
+    for (int i = 0; i < GetPageCount() && page < 0; ++i)
+    {
+        if (!m_pages[i].pixels.empty() && Allocate(i, id, padded, pos))
+            page = i;
+    }
+    if (page < 0)
+    {
+        // Repacking the emptiest page may make room, without another page.
+        int emptiest = -1;
+        for (int i = 0; i < GetPageCount(); ++i)
+        {
+            const int used = m_packing[i].usedArea;
+            if (!m_pages[i].pixels.empty() && used * 2 <= m_pageSize.x * m_pageSize.y
+                && (emptiest < 0 || used < m_packing[emptiest].usedArea))
+            {
+                emptiest = i;
+            }
+        }
+        if (emptiest >= 0)
+        {
+            Repack(emptiest, false);
+            if (Allocate(emptiest, id, padded, pos))
+                page = emptiest;
+        }
+    }
+    for (int i = 0; i < GetPageCount() && page < 0; ++i)
+    {
+        if (m_pages[i].pixels.empty())
+        {
+            Page& pg = m_pages[i];
+            pg.pixels.resize(static_cast<size_t>(pg.size.x) * pg.size.y * 4, 0);
+            pg.dirty = Rect(Point(), pg.size);
+            page = i;
+            Allocate(page, id, padded, pos);
+        }
+    }
+    if (page < 0)
+    {
+        page = AddPage();
+        Allocate(page, id, padded, pos);
+    }
+
+    CopyIn(page, pos, size, rgba, true);
+
+    Image& image = m_images[id];
+    image.placement.page = page;
+    image.placement.rect = Rect(pos.x + c_border, pos.y + c_border, size.x, size.y);
+    image.size = padded;
+    return id;
+}
+
+void TextureAtlas::Remove(ImageId id)
+{
+    auto it = m_images.find(id);
+    if (it == m_images.end())
+        return;
+
+    const int page = it->second.placement.page;
+    const Rect& rect = it->second.placement.rect;
+    Free(page, Point(rect.x - c_border, rect.y - c_border));
+    m_images.erase(it);
+
+    PagePacking& packing = m_packing[page];
+    Page& pg = m_pages[page];
+    const int pageArea = pg.size.x * pg.size.y;
+
+    if (packing.usedArea == 0)
+    {
+        // Nothing drawn from it now, so let the memory go until needed.
+        packing.shelves.clear();
+        packing.nextShelfY = 0;
+        std::vector<unsigned char>().swap(pg.pixels);
+        pg.dirty = Rect();
+    }
+    else if (packing.usedArea * 4 < pageArea && GetPageCount() > 1)
+    {
+        // Mostly empty: try to move what is left to other pages.
+        Repack(page, true);
+    }
+}
+
+const TextureAtlas::Placement& TextureAtlas::GetPlacement(ImageId id) const
+{
+    static const Placement none = { -1, Rect() };
+
+    auto it = m_images.find(id);
+    return it != m_images.end() ? it->second.placement : none;
+}
+
+size_t TextureAtlas::GetMemoryUsed() const
+{
+    size_t bytes = 0;
+    for (const Page& pg : m_pages)
+        bytes += pg.pixels.capacity();
+    return bytes;
+}
+
+bool TextureAtlas::Allocate(int page, ImageId image, Point size, Point& pos)
+{
+    PagePacking& packing = m_packing[page];
+
+    // Where the image would go in a shelf: a free slot, the end (the slot
+    // count), or -1 if there is no room.
+    auto findSlot = [&](const Shelf& shelf) -> int
+    {
+        for (size_t i = 0; i < shelf.slots.size(); ++i)
+        {
+            if (shelf.slots[i].image == 0 && shelf.slots[i].width >= size.x)
+                return static_cast<int>(i);
+        }
+        const int end = shelf.slots.empty() ? 0
+                        : shelf.slots.back().x + shelf.slots.back().width;
+        return end + size.x <= m_pageSize.x ? static_cast<int>(shelf.slots.size()) : -1;
+    };
+
+    // Use the shortest shelf that fits, so small images don't waste tall rows.
+    Shelf* best = nullptr;
+    int bestSlot = -1;
+    for (Shelf& shelf : packing.shelves)
+    {
+        if (shelf.height >= size.y && (!best || shelf.height < best->height))
+        {
+            const int slot = findSlot(shelf);
+            if (slot >= 0)
+            {
+                best = &shelf;
+                bestSlot = slot;
+            }
+        }
+    }
+
+    // Open a new shelf if the best one is much taller than we need.
+    if ((!best || best->height > size.y + size.y / 2)
+        && packing.nextShelfY + size.y <= m_pageSize.y)
+    {
+        Shelf shelf;
+        shelf.y = packing.nextShelfY;
+        shelf.height = size.y;
+        packing.shelves.push_back(shelf);
+        packing.nextShelfY += size.y;
+        best = &packing.shelves.back();
+        bestSlot = 0;
+    }
+
+    if (!best)
+        return false;
+
+    std::vector<Slot>& slots = best->slots;
+    if (bestSlot == static_cast<int>(slots.size()))
+    {
+        const int end = slots.empty() ? 0 : slots.back().x + slots.back().width;
+        Slot slot = { end, size.x, image };
+        slots.push_back(slot);
+    }
+    else
+    {
+        // Split the free slot, keeping what is left over free.
+        Slot& slot = slots[bestSlot];
+        if (slot.width > size.x)
+        {
+            Slot rest = { slot.x + size.x, slot.width - size.x, 0 };
+            slot.width = size.x;
+            slots.insert(slots.begin() + bestSlot + 1, rest);
+        }
+        slots[bestSlot].image = image;
+    }
+
+    pos = Point(slots[bestSlot].x, best->y);
+    packing.usedArea += size.x * best->height;
+    return true;
+}
+
+void TextureAtlas::Free(int page, Point pos)
+{
+    PagePacking& packing = m_packing[page];
+
+    auto shelf = std::find_if(packing.shelves.begin(), packing.shelves.end(),
+                              [&](const Shelf& s) { return s.y == pos.y; });
+    if (shelf == packing.shelves.end())
+        return;
+
+    std::vector<Slot>& slots = shelf->slots;
+    auto slot = std::find_if(slots.begin(), slots.end(),
+                             [&](const Slot& s) { return s.x == pos.x; });
+    if (slot == slots.end() || slot->image == 0)
+        return;
+
+    packing.usedArea -= slot->width * shelf->height;
+    slot->image = 0;
+
+    // Merge with free neighbours, so larger images can use the space.
+    if (slot + 1 != slots.end() && (slot + 1)->image == 0)
+    {
+        slot->width += (slot + 1)->width;
+        slots.erase(slot + 1);
+    }
+    if (slot != slots.begin() && (slot - 1)->image == 0)
+    {
+        (slot - 1)->width += slot->width;
+        slot = slots.erase(slot) - 1;
+    }
+    if (slot + 1 == slots.end())
+        slots.erase(slot);
+
+    // Give empty shelves at the bottom back to the page.
+    while (!packing.shelves.empty() && packing.shelves.back().slots.empty())
+    {
+        packing.nextShelfY = packing.shelves.back().y;
+        packing.shelves.pop_back();
+    }
+}
+
+int TextureAtlas::AddPage()
+{
+    Page page;
+    page.size = m_pageSize;
+    page.pixels.resize(static_cast<size_t>(m_pageSize.x) * m_pageSize.y * 4, 0);
+    page.dirty = Rect(Point(), m_pageSize);
+    m_pages.push_back(std::move(page));
+
+    PagePacking packing;
+    packing.nextShelfY = 0;
+    packing.usedArea = 0;
+    m_packing.push_back(packing);
+
+    return GetPageCount() - 1;
+}
+
+void TextureAtlas::CopyIn(int page, Point pos, Point size, const unsigned char* rgba,
+                          bool border)
+{
+    Page& pg = m_pages[page];
+    const size_t pitch = static_cast<size_t>(pg.size.x) * 4;
+    const size_t rowBytes = static_cast<size_t>(size.x) * 4;
+
+    if (!border)
+    {
+        for (int y = 0; y < size.y; ++y)
+        {
+            std::memcpy(&pg.pixels[(pos.y + y) * pitch + pos.x * 4],
+                        rgba + y * rowBytes, rowBytes);
+        }
+        GrowRect(pg.dirty, Rect(pos.x, pos.y, size.x, size.y));
+        return;
+    }
+
+    // Copy the edges of the image out into the border.
+    for (int y = -c_border; y < size.y + c_border; ++y)
+    {
+        const unsigned char* src = rgba + std::min(std::max(y, 0), size.y - 1) * rowBytes;
+        unsigned char* dst = &pg.pixels[(pos.y + c_border + y) * pitch + pos.x * 4];
+
+        for (int b = 0; b < c_border; ++b)
+        {
+            std::memcpy(dst + b * 4, src, 4);
+            std::memcpy(dst + (c_border + size.x + b) * 4, src + rowBytes - 4, 4);
+        }
+        std::memcpy(dst + c_border * 4, src, rowBytes);
+    }
+    GrowRect(pg.dirty, Rect(pos.x, pos.y, size.x + c_border * 2, size.y + c_border * 2));
+}
+
+void TextureAtlas::Repack(int page, bool toOtherPages)
+{
+    if (m_moveListener)
+        m_moveListener(page);
+
+    Page& pg = m_pages[page];
+    const size_t pitch = static_cast<size_t>(pg.size.x) * 4;
+
+    // Take the images out, with their borders.
+    struct Moving
+    {
+        ImageId id;
+        Point size;
+        std::vector<unsigned char> pixels;
+    };
+    std::vector<Moving> moving;
+    for (auto& it : m_images)
+    {
+        const Image& image = it.second;
+        if (image.placement.page != page)
+            continue;
+
+        Moving m;
+        m.id = it.first;
+        m.size = image.size;
+        m.pixels.resize(static_cast<size_t>(m.size.x) * m.size.y * 4);
+        const Point pos(image.placement.rect.x - c_border, image.placement.rect.y - c_border);
+        for (int y = 0; y < m.size.y; ++y)
+        {
+            std::memcpy(&m.pixels[y * m.size.x * 4], &pg.pixels[(pos.y + y) * pitch + pos.x * 4],
+                        m.size.x * 4);
+        }
+        moving.push_back(std::move(m));
+    }
+
+    PagePacking& packing = m_packing[page];
+    packing.shelves.clear();
+    packing.nextShelfY = 0;
+    packing.usedArea = 0;
+    std::fill(pg.pixels.begin(), pg.pixels.end(), 0);
+    pg.dirty = Rect(Point(), pg.size);
+
+    // Tallest first packs shelves tightly.
+    std::sort(moving.begin(), moving.end(), [](const Moving& a, const Moving& b)
+              {
+                  return a.size.y != b.size.y ? a.size.y > b.size.y : a.size.x > b.size.x;
+              });
+
+    for (const Moving& m : moving)
+    {
+        int to = -1;
+        Point pos;
+        if (toOtherPages)
+        {
+            for (int i = 0; i < GetPageCount() && to < 0; ++i)
+            {
+                if (i != page && !m_pages[i].pixels.empty() && Allocate(i, m.id, m.size, pos))
+                    to = i;
+            }
+        }
+        if (to < 0 && Allocate(page, m.id, m.size, pos))
+            to = page;
+        if (to < 0)
+        {
+            to = AddPage();
+            Allocate(to, m.id, m.size, pos);
+        }
+
+        CopyIn(to, pos, m.size, m.pixels.data(), false);
+
+        Image& image = m_images[m.id];
+        image.placement.page = to;
+        image.placement.rect = Rect(pos.x + c_border, pos.y + c_border,
+                                    m.size.x - c_border * 2, m.size.y - c_border * 2);
+    }
+
+    if (m_packing[page].usedArea == 0)
+    {
+        std::vector<unsigned char>().swap(m_pages[page].pixels);
+        m_pages[page].dirty = Rect();
+    }
+}
+
+} // namespace Renderer
+} // namespace Gwk
@@ -0,0 +1,56 @@
+/*
+ *  Gwork
+ *  Copyright (c) 2013-2018 Billy Quith
+ *  See license in Gwork.h
+ */
+
+#include <Gwork/TextureBudget.h>
+
+namespace Gwk
+{
+namespace Renderer
+{
+
+void TextureBudget::Loaded(const Texture& texture, Entry& entry, size_t bytes)
+{
+    if (m_evicted.erase(texture) != 0)
+        ++m_stats.reloads;
+
+    entry.bytes = bytes;
+    entry.lastUsed = m_frame;
+    m_stats.residentBytes += bytes;
+    ++m_stats.residentTextures;
+}
+
+void TextureBudget::Evicted(const Texture& texture, const Entry& entry)
+{
+    const unsigned long long eviction = ++m_stats.evictions;
+    m_stats.evictedBytes += entry.bytes;
+
+    m_evicted[texture] = eviction;
+    m_evictedOrder.emplace_back(texture, eviction);
+    if (m_evictedOrder.size() > MaxEvictionsTracked)
+    {
+        const auto& oldest = m_evictedOrder.front();
+        auto it = m_evicted.find(oldest.first);
+        if (it != m_evicted.end() && it->second == oldest.second)
+            m_evicted.erase(it);
+        m_evictedOrder.pop_front();
+    }
+}
+
+void TextureBudget::Resized(Entry& entry, size_t bytes)
+{
+    m_stats.residentBytes = m_stats.residentBytes - entry.bytes + bytes;
+    entry.bytes = bytes;
+}
+
+void TextureBudget::Freed(Entry& entry)
+{
+    m_stats.residentBytes -= entry.bytes;
+    --m_stats.residentTextures;
+    entry.bytes = 0;
+}
+
+} // namespace Renderer
+} // namespace Gwk
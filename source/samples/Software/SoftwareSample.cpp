@@ -90,7 +90,7 @@ int main(int argc, char** argv)
             renderer->EndContext(nullptr);
             
             // show the software rendered GUI on the screen
-            SDL_UpdateTexture(texture, NULL, &pixbuff.At(0,0), screenSize.x*4);
+            SDL_UpdateTexture(texture, NULL, &pixbuff.At(0,0), pixbuff.GetStride());
             SDL_RenderClear(sdlRenderer);
             SDL_RenderCopy(sdlRenderer, texture, NULL, NULL);
             SDL_RenderPresent(sdlRenderer);
@@ -106,7 +106,7 @@ int main(int argc, char** argv)
         renderer->EndContext(nullptr);
         
         // write screen shot
-        stbi_write_png("sw.png", screenSize.x, screenSize.y, 4, &pixbuff.At(0,0), 4*screenSize.x);
+        stbi_write_png("sw.png", screenSize.x, screenSize.y, 4, &pixbuff.At(0,0), pixbuff.GetStride());
 #endif
     }
 
@@ -81,8 +81,8 @@ public:
             // around
             // for the lifetime of the label. Rethink, or is that ideal?
             //
-            m_font.facename = "OpenSans";// TODO: "Comic Sans MS";
-            m_font.size = 25;
+            m_font.SetFacename("OpenSans");// TODO: "Comic Sans MS";
+            m_font.SetSize(25);
             Gwk::Controls::Label* label = new Gwk::Controls::Label(this);
             label->SetText("Custom Font (Comic Sans 25)");
             label->SetFont(m_font);
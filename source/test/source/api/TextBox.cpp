@@ -61,8 +61,8 @@ public:
             label->SetMaxTextLength(10);
         }
         {
-            m_font.facename = "Impact";
-            m_font.size = 50;
+            m_font.SetFacename("Impact");
+            m_font.SetSize(50);
             Gwk::Controls::TextBox* label = new Gwk::Controls::TextBox(this);
             label->SetText("Different Font");
             label->SetPos(10, 10+25*7);
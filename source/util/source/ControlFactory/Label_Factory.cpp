@@ -37,7 +37,7 @@ namespace Gwk
 //
 //                String GetValueAsString(Controls::Base* ctrl) override
 //                {
-//                    return gwk_cast<Controls::Label>(ctrl)->GetFont()->facename;
+//                    return gwk_cast<Controls::Label>(ctrl)->GetFont()->GetFacename();
 //                }
 //
 //                void SetValueFromString(Controls::Base* ctrl, const String& str) override
@@ -46,7 +46,7 @@ namespace Gwk
 //                        return;
 //
 //                    Gwk::Font* font = gwk_cast<Controls::Label>(ctrl)->GetFont();
-//                    gwk_cast<Controls::Label>(ctrl)->SetFont(str, font->size, font->bold);
+//                    gwk_cast<Controls::Label>(ctrl)->SetFont(str, font->GetSize(), font->IsBold());
 //                }
 //
 //            };
@@ -59,7 +59,7 @@ namespace Gwk
 //                String GetValueAsString(Controls::Base* ctrl) override
 //                {
 //                    return Gwk::Utility::Format("%i", gwk_cast<Controls::Label>(
-//                                                     ctrl)->GetFont()->size);
+//                                                     ctrl)->GetFont()->GetSize());
 //                }
 //
 //                void SetValueFromString(Controls::Base* ctrl, const String& str) override
@@ -71,10 +71,10 @@ namespace Gwk
 //
 //                    Gwk::Font* font = gwk_cast<Controls::Label>(ctrl)->GetFont();
 //
-//                    if (size == font->size)
+//                    if (size == font->GetSize())
 //                        return;
 //
-//                    gwk_cast<Controls::Label>(ctrl)->SetFont(font->facename, size, font->bold);
+//                    gwk_cast<Controls::Label>(ctrl)->SetFont(font->GetFacename(), size, font->IsBold());
 //                }
 //
 //            };
@@ -86,7 +86,7 @@ namespace Gwk
 //
 //                String GetValueAsString(Controls::Base* ctrl) override
 //                {
-//                    if (gwk_cast<Controls::Label>(ctrl)->GetFont()->bold)
+//                    if (gwk_cast<Controls::Label>(ctrl)->GetFont()->IsBold())
 //                        return True;
 //
 //                    return False;
@@ -97,10 +97,10 @@ namespace Gwk
 //                    bool bTrue = (str == True);
 //                    Gwk::Font* font = gwk_cast<Controls::Label>(ctrl)->GetFont();
 //
-//                    if (bTrue == font->bold)
+//                    if (bTrue == font->IsBold())
 //                        return;
 //
-//                    gwk_cast<Controls::Label>(ctrl)->SetFont(font->facename, font->size,
+//                    gwk_cast<Controls::Label>(ctrl)->SetFont(font->GetFacename(), font->GetSize(),
 //                                                              bTrue ? true : false);
 //                }
 //
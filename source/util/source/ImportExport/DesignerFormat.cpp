@@ -1,5 +1,6 @@
 
 #include <Gwork/Util/ImportExport.h>
+#include <Gwork/PlatformCommon.h>
 #include "GworkUtil.h"
 
 #ifndef _MSC_VER
@@ -50,13 +51,14 @@ DesignerFormat::DesignerFormat()
 
 void DesignerFormat::Import(Gwk::Controls::Base* root, const Gwk::String& strFilename)
 {
-    GwkUtil::BString strContents;
+    // Parsed straight from the mapping. Not kept mapped, so it can be saved over.
+    Gwk::Platform::MappedFile file;
 
-    if (!GwkUtil::File::Read(strFilename, strContents))
+    if (!file.Open(strFilename))
         return;
 
     GwkUtil::Data::Tree tree;
-    GwkUtil::Data::Json::Import(tree, strContents);
+    GwkUtil::Data::Json::Import(tree, reinterpret_cast<const char*>(file.Data()), file.Size());
 
     if (!tree.HasChild("Controls"))
         return;
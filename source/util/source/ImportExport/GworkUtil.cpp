@@ -368,11 +368,39 @@ namespace Json
 
     }
 
+    // Read-only stream over text of known length. Reads '\0' at the end, as
+    // rapidjson expects of strings.
+    struct MemoryStream
+    {
+        typedef char Ch;
+
+        MemoryStream(const Ch* src, size_t size) : src_(src), head_(src), end_(src + size) {}
+
+        Ch Peek() const { return src_ != end_ ? *src_ : '\0'; }
+        Ch Take() { return src_ != end_ ? *src_++ : '\0'; }
+        size_t Tell() const { return src_ - head_; }
+
+        Ch* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+        void Put(Ch) { RAPIDJSON_ASSERT(false); }
+        void Flush() { RAPIDJSON_ASSERT(false); }
+        size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+        const Ch* src_;
+        const Ch* head_;
+        const Ch* end_;
+    };
+
     bool Import(GwkUtil::Data::Tree& tree, const GwkUtil::BString& input)
+    {
+        return Import(tree, input.data(), input.size());
+    }
+
+    bool Import(GwkUtil::Data::Tree& tree, const char* input, size_t size)
     {
         rapidjson::Document doc;
+        MemoryStream stream(input, size);
 
-        if (doc.Parse<0>(input.c_str()).HasParseError())
+        if (doc.ParseStream<0, rapidjson::UTF8<> >(stream).HasParseError())
             return false;
 
         if (doc.IsObject() || doc.IsArray())
@@ -10,6 +10,7 @@
  *        able to be used by the client app, and Gwork "dropped in".
  */
 
+#include <cstddef>
 #include <string>
 #include <list>
 
@@ -367,6 +368,10 @@ namespace GwkUtil
             bool Export(const GwkUtil::Data::Tree& tree, GwkUtil::BString& output,
                         bool bPretty = false);
             bool Import(GwkUtil::Data::Tree& tree, const GwkUtil::BString& input);
+
+            //! Import from text that need not be null terminated, such as a
+            //! memory-mapped file.
+            bool Import(GwkUtil::Data::Tree& tree, const char* input, size_t size);
         }
 
     } // namespace Data